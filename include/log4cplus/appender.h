@@ -96,9 +96,15 @@ namespace log4cplus {
         /**
          * This method performs threshold checks and invokes filters before
          * delegating actual logging to the subclasses specific {@link
-         * #append} method.
+         * #append} method, all of it under <code>access_mutex</code>.
+         *
+         * Subclasses may override it. An override either calls it, as
+         * FileAppender does before it waits for a group commit, or
+         * replaces it and then has to check the threshold and the
+         * filters itself, as AsyncAppender does to queue events
+         * without taking <code>access_mutex</code>.
          */
-        void doAppend(const log4cplus::spi::InternalLoggingEvent& event);
+        virtual void doAppend(const log4cplus::spi::InternalLoggingEvent& event);
 
         /**
          * Get the name of this appender. The name uniquely identifies the
@@ -181,6 +187,13 @@ namespace log4cplus {
          */
         virtual void append(const log4cplus::spi::InternalLoggingEvent& event) = 0;
 
+        /**
+         * Formats the event with the layout into a buffer owned by this
+         * appender and returns the buffer. It is meant to be called from
+         * append(), which runs with the appender's mutex held.
+         */
+        const log4cplus::tstring& formatEvent(const log4cplus::spi::InternalLoggingEvent& event);
+
       // Data
         /** The layout variable does not need to be set if the appender
          *  implementation has its own layout. */
@@ -201,6 +214,10 @@ namespace log4cplus {
 
         /** Is this appender closed? */
         bool closed;
+
+    private:
+        /** Buffer formatEvent() formats into. */
+        log4cplus::tstring formatted;
     };
 
     /** This is a pointer to an Appender. */
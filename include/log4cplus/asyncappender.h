@@ -0,0 +1,133 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_ASYNCAPPENDER_H
+#define LOG4CPLUS_ASYNCAPPENDER_H
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/appenderattachableimpl.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/queue.h>
+#include <log4cplus/helpers/threads.h>
+
+
+namespace log4cplus {
+
+    /**
+     * AsyncAppender decouples logging threads from slow appenders.
+     * Events passed to it are copied into a bounded queue and a
+     * dedicated thread delivers them to the attached appenders.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>appenders.1</tt>, <tt>appenders.2</tt>, ...</dt>
+     * <dd>Factory names of the attached appenders. Properties of each
+     * appender are given with the same prefix, e.g.
+     * <tt>appenders.1.File</tt>.</dd>
+     *
+     * <dt><tt>QueueLimit</tt></dt>
+     * <dd>Maximal number of queued events. The default is 100.</dd>
+     *
+     * <dt><tt>OverflowPolicy</tt></dt>
+     * <dd>What to do with an event when the queue is full. The possible
+     * values are <tt>BLOCK</tt> (wait for the writer thread, the
+     * default), <tt>DROP_NEWEST</tt>, <tt>DROP_OLDEST</tt> and
+     * <tt>DROP_BELOW_THRESHOLD</tt>.</dd>
+     *
+     * <dt><tt>OverflowThreshold</tt></dt>
+     * <dd>With <tt>DROP_BELOW_THRESHOLD</tt> policy events with log
+     * level below this one are dropped, the others wait. The default is
+     * <tt>WARN</tt>.</dd>
+     *
+     * <dt><tt>DropReportInterval</tt></dt>
+     * <dd>How often, in milliseconds, the number of dropped events is
+     * reported through LogLog. The default is 10000. Zero disables
+     * the periodic reports; the total is still reported on close.</dd>
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT AsyncAppender
+        : public Appender
+        , public helpers::AppenderAttachableImpl
+    {
+    public:
+      // Ctors
+        AsyncAppender(SharedAppenderPtr const & app, unsigned queueLimit,
+            thread::Queue::OverflowPolicy policy = thread::Queue::BLOCK,
+            LogLevel overflowThreshold = WARN_LOG_LEVEL);
+        AsyncAppender(helpers::Properties const & properties);
+
+      // Dtor
+        virtual ~AsyncAppender();
+
+      // Methods
+        /**
+         * Delivers all queued events, stops the writer thread and
+         * detaches the attached appenders.
+         */
+        virtual void close();
+
+        /**
+         * Checks the threshold and the filters and queues a copy of the
+         * event. Unlike Appender::doAppend() it does not take
+         * <code>access_mutex</code>, so producers waiting for room in a
+         * full queue or copying their events do not serialize on it.
+         */
+        virtual void doAppend(spi::InternalLoggingEvent const & event);
+
+    protected:
+        virtual void append(spi::InternalLoggingEvent const & event);
+
+        void init(unsigned queueLimit, thread::Queue::OverflowPolicy policy,
+            LogLevel overflowThreshold);
+
+      // Data
+        /** Writer thread. */
+        thread::AbstractThreadPtr queue_thread;
+
+        /** Events waiting for the writer thread. It is set by the
+         * constructor and kept until destruction. */
+        thread::QueuePtr queue;
+
+        /** Interval of dropped events reports in milliseconds. */
+        unsigned long dropReportInterval;
+
+    private:
+      // Disallow copying of instances of this class
+        AsyncAppender(AsyncAppender const &);
+        AsyncAppender & operator = (AsyncAppender const &);
+    };
+
+
+    typedef helpers::SharedObjectPtr<AsyncAppender> AsyncAppenderPtr;
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_ASYNCAPPENDER_H
@@ -44,6 +44,11 @@
 #  endif // defined (INSIDE_LOG4CPLUS)
 #endif // !_WIN32
 
+#if defined (__GNUC__) || (defined (_MSC_VER) && _MSC_VER >= 1400) \
+    || (defined (__cplusplus) && __cplusplus >= 201103L)
+#  define LOG4CPLUS_HAVE_C99_VARIADIC_MACROS
+#endif
+
 #include <log4cplus/helpers/thread-config.h>
 
 
@@ -169,6 +169,14 @@ namespace log4cplus
          * "log4cplus.disableOverride" to <code>true</code> or any value other
          * than false. As in <pre>log4cplus.disableOverride=true </pre>
          *
+         * <h3>Clock source</h3>
+         *
+         * The key "log4cplus.clockSource" selects the clock used for
+         * time stamps of logging events, see helpers::setClockSource().
+         * The possible values are <code>REALTIME</code> (the default),
+         * <code>COARSE</code>, <code>MONOTONIC</code> and
+         * <code>TSC</code>. As in <pre>log4cplus.clockSource=COARSE</pre>
+         *
          * <h3>Example</h3>
          *
          * An example configuration is given below.
@@ -255,6 +263,7 @@ namespace log4cplus
         void init();  // called by the ctor
         void reconfigure();
         void replaceEnvironVariables();
+        void configureClockSource();
         void configureLoggers();
         void configureLogger(log4cplus::Logger logger, const log4cplus::tstring& config);
         void configureAppenders();
@@ -26,8 +26,17 @@
 #include <log4cplus/config.hxx>
 #include <log4cplus/appender.h>
 #include <log4cplus/fstreams.h>
+#include <log4cplus/helpers/backupindex.h>
+#include <log4cplus/helpers/fileoutput.h>
+#include <log4cplus/helpers/gzip.h>
+#include <log4cplus/helpers/lockfile.h>
 #include <log4cplus/helpers/property.h>
 #include <log4cplus/helpers/timehelper.h>
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <log4cplus/helpers/syncprims.h>
+#include <log4cplus/helpers/threads.h>
+#endif
+#include <memory>
 
 #if defined(__DECCXX)
 #   define LOG4CPLUS_OPEN_MODE_TYPE LOG4CPLUS_FSTREAM_NAMESPACE::ios::open_mode
@@ -37,6 +46,13 @@
 
 namespace log4cplus {
 
+    namespace helpers {
+
+        class BackupCompressor;
+        class BackupRetention;
+
+    } // end namespace helpers
+
     /**
      * Appends log events to a file.
      * 
@@ -62,7 +78,161 @@ namespace log4cplus {
      *
      * <dt><tt>BufferSize</tt></dt>
      * <dd>Non-zero value of this property sets up buffering of output
-     * stream using a buffer of given size.
+     * stream using a buffer of given size. With the <tt>fd</tt>
+     * backend the buffer is written out whenever it fills up; its
+     * default size is 8192 bytes.
+     * </dd>
+     *
+     * <dt><tt>Backend</tt></dt>
+     * <dd>Selects how the file is written. <tt>stream</tt>, the
+     * default, writes through <code>std::ofstream</code>. <tt>fd</tt>
+     * writes through a raw file descriptor opened with
+     * <code>O_APPEND</code> and its own buffer, see
+     * helpers::FileOutput. <tt>mmap</tt> copies the output into a
+     * shared memory mapping of the file, see helpers::MappedFileOutput
+     * and MappedFileAppender. Flushing the <tt>mmap</tt> backend
+     * means <code>msync()</code>, it should be used with
+     * <tt>ImmediateFlush=false</tt>. <tt>uring</tt> submits the
+     * buffers as asynchronous writes through Linux io_uring, see
+     * helpers::UringFileOutput; logging threads do not wait for the
+     * writes unless all buffers are in flight. It falls back to
+     * <tt>fd</tt> when the kernel does not support io_uring and it is
+     * not available in single threaded builds. Its buffers are 64
+     * kilobytes unless <tt>BufferSize</tt> is set, every flush submits
+     * one, so it works best with <tt>ImmediateFlush=false</tt> and
+     * <tt>FlushInterval</tt>. The <tt>fd</tt> and <tt>mmap</tt>
+     * backends are available only on POSIX systems.
+     * </dd>
+     *
+     * <dt><tt>UringQueueDepth</tt></dt>
+     * <dd>Number of buffers of the <tt>uring</tt> backend, i.e. the
+     * maximal number of writes in flight. The default is 8.
+     * </dd>
+     *
+     * <dt><tt>MapSize</tt></dt>
+     * <dd>Size of the mapped window of the <tt>mmap</tt> backend, the
+     * file is also extended in steps of this size. The default is 16
+     * megabytes; <tt>MB</tt> and <tt>KB</tt> suffixes can be used.
+     * </dd>
+     *
+     * <dt><tt>Preallocate</tt></dt>
+     * <dd>Keeps this much disk space allocated ahead of the written
+     * data, which limits fragmentation of growing files; e.g.
+     * <tt>Preallocate=64MB</tt>. The space beyond the data is released
+     * when the file is closed, rolled over or reopened. With the
+     * <tt>fd</tt> backend it is available only on Linux and the file
+     * size does not change; the <tt>mmap</tt> backend extends the file
+     * in steps of this size instead of <tt>MapSize</tt>, when it is
+     * bigger. It is ignored with <tt>UseLockFile</tt>.
+     * </dd>
+     *
+     * <dt><tt>DropCacheBehind</tt></dt>
+     * <dd>When it is set true, written data are pushed to the disk in
+     * the background and then dropped from the page cache with
+     * <code>sync_file_range()</code> and
+     * <code>posix_fadvise(POSIX_FADV_DONTNEED)</code>, so that logs do
+     * not evict data of the application from the cache. It works in
+     * steps of a megabyte and only on Linux; the <tt>fd</tt> and
+     * <tt>mmap</tt> backends are needed. Logging threads only start
+     * the writeback. The thread of <tt>FlushInterval</tt> or
+     * <tt>Durability=interval</tt> waits for it and drops the pages;
+     * without such a thread only the pages written back by the next
+     * step are dropped.
+     * </dd>
+     *
+     * <dt><tt>FlushInterval</tt></dt>
+     * <dd>When it is non-zero, buffered output is flushed at most this
+     * many milliseconds after it has been appended. A background
+     * thread does the flushing, in single threaded builds it is done
+     * by the next appended event. It is useful together with
+     * <tt>ImmediateFlush=false</tt>.
+     * </dd>
+     *
+     * <dt><tt>FlushLevel</tt></dt>
+     * <dd>Events with this or higher log level flush the output
+     * immediately even when <tt>ImmediateFlush</tt> is false,
+     * e.g. <tt>FlushLevel=ERROR</tt>.
+     * </dd>
+     *
+     * <dt><tt>Durability</tt></dt>
+     * <dd>Says when the written events are made durable with
+     * <code>fdatasync()</code>. With <tt>none</tt>, the default, the
+     * appender never syncs and the data reach the disk whenever the
+     * system writes them back. With <tt>interval</tt> a background
+     * thread syncs the file every <tt>SyncInterval</tt> milliseconds,
+     * so at most that much of the log is lost when the system
+     * crashes. With <tt>group</tt> a thread that has logged an event
+     * with log level of at least <tt>SyncLevel</tt> does not return
+     * until the event is on the disk. One of the waiting threads
+     * syncs the file for all of them while the others keep on
+     * appending, so the cost of a sync is shared by all events
+     * appended meanwhile. A failed sync is reported through LogLog
+     * and the threads waiting for it are released anyway. In both
+     * modes the file is also synced before it is closed or rolled
+     * over. It implies <tt>Backend=fd</tt> unless the <tt>mmap</tt>
+     * or <tt>uring</tt> backend is used; in single threaded builds the
+     * appending thread syncs by itself. With <tt>uring</tt> only the
+     * sync before closing or rolling over is submitted through the
+     * ring; the syncs of both modes wait for the writes in flight and
+     * call <code>fdatasync()</code> on a duplicate of the file
+     * descriptor.
+     * </dd>
+     *
+     * <dt><tt>SyncInterval</tt></dt>
+     * <dd>Interval of syncs of <tt>Durability=interval</tt> in
+     * milliseconds. The default is 1000.
+     * </dd>
+     *
+     * <dt><tt>SyncLevel</tt></dt>
+     * <dd>Log level of events that wait for the sync with
+     * <tt>Durability=group</tt>, e.g. <tt>SyncLevel=WARN</tt>. Events
+     * with lower log level do not wait, they are made durable by the
+     * next sync. The default is <tt>ALL</tt>, all events wait.
+     * </dd>
+     *
+     * <dt><tt>CompressOutput</tt></dt>
+     * <dd>With <tt>gzip</tt> the file is written as a gzip stream
+     * instead of plain text. Every flush, as set up by
+     * <tt>ImmediateFlush</tt>, <tt>FlushLevel</tt> and
+     * <tt>FlushInterval</tt>, ends with a sync flush point, so that
+     * <tt>zcat</tt> or <tt>zgrep</tt> can read everything up to the
+     * last flush while the file is still being written. Closing the
+     * file, e.g. at rollover, completes the gzip member; appending to
+     * an existing file starts a new one. Sizes, e.g.
+     * <tt>MaxFileSize</tt>, count compressed bytes, which trail the
+     * written text by up to one block of compressed data. Flushing
+     * after each event makes the compression much less effective, it
+     * is best used with <tt>ImmediateFlush=false</tt> and
+     * <tt>FlushInterval</tt>. The default is <tt>none</tt>. In
+     * <code>UNICODE</code> builds it needs the <tt>fd</tt> backend.
+     * </dd>
+     *
+     * <dt><tt>CompressLevel</tt></dt>
+     * <dd>Compression level from 1, the fastest, to 9, the best, like
+     * the levels of <tt>gzip</tt>. It applies to
+     * <tt>CompressOutput</tt>, where the default is 1, and to
+     * <tt>CompressBackups</tt> of the rolling appenders, where the
+     * default is 6.
+     * </dd>
+     *
+     * <dt><tt>UseLockFile</tt></dt>
+     * <dd>When it is set true, several processes can log into the same
+     * file. Each event is written with a single <code>O_APPEND</code>
+     * <code>write()</code>, so whole lines of different processes are
+     * never interleaved; it implies <tt>Backend=fd</tt>. Writes do not
+     * take any lock. Rollovers of the rolling appenders take the lock
+     * file and the first process renames the file, the others find
+     * out that the file name refers to a new file and just reopen it.
+     * Events written by other processes are counted in the file size
+     * when this process writes next, so a few of them can still go to
+     * the file that has just been rolled over. It is available only
+     * on POSIX systems and it cannot be used with
+     * <tt>CompressOutput</tt> or <tt>CompressBackups</tt>.
+     * </dd>
+     *
+     * <dt><tt>LockFile</tt></dt>
+     * <dd>Name of the lock file of <tt>UseLockFile</tt>. The default
+     * is the file name with <tt>.lock</tt> appended.
      * </dd>
      * </dl>
      */
@@ -81,12 +251,81 @@ namespace log4cplus {
       // Methods
         virtual void close();
 
+        /**
+         * Appends the event and, with <tt>Durability=group</tt>, waits
+         * until it is on the disk.
+         */
+        virtual void doAppend(const spi::InternalLoggingEvent& event);
+
+        /** Durability levels, see the <tt>Durability</tt> property. */
+        enum Durability
+        {
+            NOT_DURABLE,
+            SYNC_INTERVAL,
+            GROUP_COMMIT
+        };
+
     protected:
         virtual void append(const spi::InternalLoggingEvent& event);
 
         void open(LOG4CPLUS_OPEN_MODE_TYPE mode);
         bool reopen();
 
+        /** Closes the file of either backend. */
+        void closeFile();
+        /** Returns true when the file is open and writable. */
+        bool isFileGood() const;
+        /** Flushes buffered output of either backend. */
+        void flushFile();
+        /** Returns current size of the file, including buffered data. */
+        helpers::file_size_type getFileSize();
+        /** Writes formatted text, compressed when it is enabled. */
+        void writeText(const log4cplus::tstring& text);
+        /** Writes bytes to the file of either backend. */
+        void writeBytes(const char * data, std::size_t len);
+        /**
+         * Completes the gzip member of compressed output so that the
+         * next write starts a new one.
+         */
+        void finishCompressedOutput();
+        /**
+         * With <tt>UseLockFile</tt>, reopens the file when another
+         * process has rolled it over already. It must be called with
+         * the lock file locked.
+         * @returns true when the file has been reopened.
+         */
+        bool reopenIfReplaced();
+        /**
+         * Flushes the output and waits until it is on the disk. Unlike
+         * the other methods it locks the appender by itself and it
+         * does not hold the lock during the sync.
+         */
+        void syncFile();
+        /**
+         * With <tt>DropCacheBehind</tt>, waits for the writeback
+         * started by the writes and drops the written pages from the
+         * page cache. Like syncFile() it locks the appender by itself
+         * and it does not hold the lock while waiting.
+         */
+        void dropFileCache();
+        /**
+         * Waits until the events appended so far are on the disk,
+         * syncing the file itself when no other thread is doing it.
+         */
+        void groupCommit();
+        /** Starts the background flushing thread if it is needed. */
+        void startFlushThread();
+        /** Stops the background flushing thread, if there is one. */
+        void stopFlushThread();
+        /**
+         * Sets up compression of backups of the rolling appenders from
+         * the <tt>CompressBackups</tt> property and compresses the
+         * backups left uncompressed by previous runs.
+         * @param naming Naming scheme of the backups.
+         */
+        void initBackupCompression(const log4cplus::helpers::Properties& properties,
+                                   helpers::BackupIndex::Naming naming);
+
       // Data
         /**
          * Immediate flush means that the underlying writer or output stream
@@ -119,6 +358,100 @@ namespace log4cplus {
 
         log4cplus::helpers::Time reopen_time;
 
+        /**
+         * Output of the <tt>fd</tt>, <tt>mmap</tt> and <tt>uring</tt>
+         * backends. It is null when the stream backend,
+         * <code>out</code>, is used.
+         */
+        std::auto_ptr<helpers::FileOutput> fileOutput;
+
+        /**
+         * Size of the file written through <code>out</code>: its size
+         * when it was opened plus the length of all text written since.
+         * In <code>UNICODE</code> builds characters are counted, not
+         * bytes.
+         */
+        helpers::file_size_type streamSize;
+
+        /**
+         * Events with this or higher log level flush the output. It is
+         * <code>NOT_SET_LOG_LEVEL</code> when the policy is disabled.
+         */
+        LogLevel flushLevel;
+
+        /**
+         * Maximal time in milliseconds buffered output waits for
+         * a flush. Zero disables the policy.
+         */
+        unsigned long flushInterval;
+
+        /** Durability level of the output. */
+        Durability durability;
+
+        /**
+         * Interval of syncs of <code>SYNC_INTERVAL</code> durability
+         * in milliseconds, zero otherwise.
+         */
+        unsigned long syncInterval;
+
+        /** Events with this or higher log level wait for group commit. */
+        LogLevel syncLevel;
+
+        /**
+         * Compresses the output for <tt>CompressOutput</tt>. It is null
+         * when the output is written as it is.
+         */
+        std::auto_ptr<helpers::GzipCompressor> outputCompressor;
+
+        /** Compressed output waiting to be written to the file. */
+        std::string compressedOutput;
+
+        /**
+         * Compresses backups of the rolling appenders. It is null when
+         * backups are not compressed.
+         */
+        helpers::SharedObjectPtr<helpers::BackupCompressor> compressor;
+
+        /**
+         * Lock file serializing rollovers of processes sharing the
+         * file for <tt>UseLockFile</tt>, or null.
+         */
+        std::auto_ptr<helpers::LockFile> lockFile;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        class FlushThread;
+        friend class FlushThread;
+
+        /**
+         * Thread flushing output every <code>flushInterval</code> and
+         * syncing it every <code>syncInterval</code>.
+         */
+        helpers::SharedObjectPtr<FlushThread> flushThread;
+
+        /** Protects the group commit state below. */
+        thread::Mutex commitMutex;
+
+        /** Signalled when a sync of group commit completes. */
+        thread::ManualResetEvent commitEvent;
+
+        /** Number of events appended with group commit. */
+        unsigned long appendCount;
+
+        /** Number of the appended events that are on the disk. */
+        unsigned long syncedCount;
+
+        /** True while a thread is syncing for group commit. */
+        bool committing;
+
+#else
+        /** Time of the next flush by appended event. */
+        log4cplus::helpers::Time nextFlushTime;
+
+        /** Time of the next sync by appended event. */
+        log4cplus::helpers::Time nextSyncTime;
+
+#endif
+
     private:
         void init(const log4cplus::tstring& filename,
                   LOG4CPLUS_OPEN_MODE_TYPE mode);
@@ -148,7 +481,41 @@ namespace log4cplus {
      * <dd>This property limits the number of backup output
      * files; e.g. how many <tt>log.1</tt>, <tt>log.2</tt> etc. files
      * will be kept.</dd>
+     *
+     * <dt><tt>BackupNaming</tt></dt>
+     * <dd>With <tt>index</tt>, the default, the newest backup is
+     * <tt>log.1</tt> and every rollover renames all backups to make
+     * room for it. With <tt>sequence</tt> each backup gets the next
+     * number, <tt>log.1</tt> is the oldest one, and with
+     * <tt>timestamp</tt> it gets the time of the rollover, e.g.
+     * <tt>log.20101107-134501.250</tt>. Backups are never renamed
+     * again; when there are more than <tt>MaxBackupIndex</tt> of them
+     * the oldest one is deleted. Existing backups are found by a
+     * single directory scan at the first rollover.</dd>
+     *
+     * <dt><tt>CompressBackups</tt></dt>
+     * <dd>With <tt>gzip</tt> each backup is compressed into
+     * <tt>log.1.gz</tt> etc. after the rollover and the original is
+     * removed. The default is <tt>none</tt>. Compression goes to
+     * a temporary <tt>.gz.tmp</tt> file first; backups that have been
+     * left uncompressed, e.g. by a crash, are compressed when the
+     * appender is created. In single threaded builds the backup is
+     * compressed by the thread that rolls the file over.</dd>
+     *
+     * <dt><tt>CompressThreads</tt></dt>
+     * <dd>Maximal number of backups compressed at the same time. Each
+     * runs on its own thread with the lowest scheduling and I/O
+     * priority where the system supports it. The default is 1.</dd>
      * </dl>
+     *
+     * <p>With <tt>Backend=fd</tt> in multi-threaded builds the rollover
+     * does not stall logging threads on renames. A background thread
+     * keeps the next file, <tt>log.next</tt>, open in advance. When the
+     * current file reaches its maximal size the appender only switches
+     * its output to the new file descriptor; the thread then closes
+     * the old file, renames the backups and renames <tt>log.next</tt>
+     * to <tt>log</tt>. If the next file is not ready yet, the appender
+     * keeps writing into the current one until it is.
      */
     class LOG4CPLUS_EXPORT RollingFileAppender : public FileAppender {
     public:
@@ -162,6 +529,9 @@ namespace log4cplus {
       // Dtor
         virtual ~RollingFileAppender();
 
+      // Methods
+        virtual void close();
+
     protected:
         virtual void append(const spi::InternalLoggingEvent& event);
         void rollover();
@@ -170,12 +540,57 @@ namespace log4cplus {
         long maxFileSize;
         int maxBackupIndex;
 
+        /** Backups for <tt>BackupNaming</tt> other than <tt>index</tt>. */
+        std::auto_ptr<helpers::BackupIndex> backupIndex;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        class RolloverThread;
+        friend class RolloverThread;
+
+        /** Thread renaming files and preparing the next file. */
+        helpers::SharedObjectPtr<RolloverThread> rolloverThread;
+#endif
+
     private:
         void init(long maxFileSize, int maxBackupIndex);
     };
 
 
 
+    /**
+     * MappedFileAppender is a RollingFileAppender for high volume logs
+     * that writes through a shared memory mapping of the file,
+     * <tt>Backend=mmap</tt>. The file is preallocated in steps of
+     * <tt>MapSize</tt> and a window of that size is mapped at its end,
+     * so appending an event is a copy into the mapping; there is no
+     * system call per event. The file is truncated to the length of
+     * the written data when it is closed or rolled over.
+     *
+     * <h3>Properties</h3>
+     * <p>The same as {@link RollingFileAppender}'s properties, only
+     * <tt>Backend</tt> is always <tt>mmap</tt> and
+     * <tt>ImmediateFlush</tt> is <tt>false</tt> by default.
+     * Flushing writes the dirty pages to the disk with
+     * <code>msync()</code>, so <tt>FlushInterval</tt> and
+     * <tt>FlushLevel</tt> set how often that is done. Without
+     * flushing the written events survive a crash of the process, not
+     * of the system.
+     */
+    class LOG4CPLUS_EXPORT MappedFileAppender : public RollingFileAppender {
+    public:
+      // Ctors
+        MappedFileAppender(const log4cplus::tstring& filename,
+                           long maxFileSize = 10*1024*1024, // 10 MB
+                           int maxBackupIndex = 1,
+                           unsigned long mapSize = 16*1024*1024); // 16 MB
+        MappedFileAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~MappedFileAppender();
+    };
+
+
+
     enum DailyRollingFileSchedule { MONTHLY, WEEKLY, DAILY,
                                     TWICE_DAILY, HOURLY, MINUTELY};
 
@@ -198,6 +613,20 @@ namespace log4cplus {
      * single logging period; e.g. how many <tt>log.2009-11-07.1</tt>,
      * <tt>log.2009-11-07.2</tt> etc. files are kept.</dd>
      *
+     * <dt><tt>BackupNaming</tt></dt>
+     * <dd>With <tt>sequence</tt> or <tt>timestamp</tt> backups are
+     * never renamed: the file becomes <tt>log.2009-11-07</tt>, or
+     * <tt>log.2009-11-07.1</tt>, <tt>log.2009-11-07.2</tt> etc. when
+     * the period has been rolled over before. <tt>MaxBackupIndex</tt>
+     * then limits the total number of backups and the oldest one is
+     * deleted. The default, <tt>index</tt>, renames backups of the
+     * period as described above.</dd>
+     *
+     * <dt><tt>CompressBackups</tt>, <tt>CompressThreads</tt></dt>
+     * <dd>Backups are compressed the same way as by
+     * {@link RollingFileAppender}, e.g. into
+     * <tt>log.2009-11-07.gz</tt>.</dd>
+     *
      * </dl>
      */
     class LOG4CPLUS_EXPORT DailyRollingFileAppender : public FileAppender {
@@ -217,7 +646,7 @@ namespace log4cplus {
 
     protected:
         virtual void append(const spi::InternalLoggingEvent& event);
-        void rollover();
+        virtual void rollover();
         log4cplus::helpers::Time calculateNextRolloverTime(const log4cplus::helpers::Time& t) const;
         log4cplus::tstring getFilename(const log4cplus::helpers::Time& t) const;
 
@@ -227,10 +656,104 @@ namespace log4cplus {
         log4cplus::helpers::Time nextRolloverTime;
         int maxBackupIndex;
 
+        /** Backups for <tt>BackupNaming</tt> other than <tt>index</tt>. */
+        std::auto_ptr<helpers::BackupIndex> backupIndex;
+
     private:
         void init(DailyRollingFileSchedule schedule);
     };
 
+
+
+    /**
+     * TimeBasedRollingFileAppender rolls the file over at the end of
+     * each period of its schedule, like {@link
+     * DailyRollingFileAppender}, and also when it reaches its maximal
+     * size, whichever comes first. Backups are named after the period,
+     * e.g. <tt>log.2009-11-07</tt>, then <tt>log.2009-11-07.1</tt>,
+     * <tt>log.2009-11-07.2</tt> etc. for further rollovers within the
+     * same period; they are never renamed again.
+     *
+     * Instead of a number of backups the appender limits their total
+     * size and their age. The backups are listed by a single directory
+     * scan and then kept in memory, so a rollover only renames the
+     * file. A background thread deletes the oldest backups when they
+     * are over the limits; in single threaded builds the thread that
+     * rolls the file over does it.
+     *
+     * <h3>Properties</h3>
+     * <p>Properties additional to {@link FileAppender}'s properties:
+     *
+     * <dl>
+     * <dt><tt>Schedule</tt></dt>
+     * <dd>Rollover schedule, the same as of {@link
+     * DailyRollingFileAppender}. The default is <tt>DAILY</tt>.</dd>
+     *
+     * <dt><tt>MaxFileSize</tt></dt>
+     * <dd>Maximal size of the file; <tt>MB</tt> and <tt>KB</tt>
+     * suffixes can be used. The default is 10 megabytes, zero disables
+     * rollovers by size.</dd>
+     *
+     * <dt><tt>TotalSizeCap</tt></dt>
+     * <dd>Maximal total size of the backups; <tt>GB</tt>, <tt>MB</tt>
+     * and <tt>KB</tt> suffixes can be used. The current file is not
+     * counted, so the log takes at most this plus
+     * <tt>MaxFileSize</tt>. Backups are counted with the size they
+     * had when they were rolled over, or when the directory was
+     * scanned. The default is zero, no limit.</dd>
+     *
+     * <dt><tt>MaxBackupAge</tt></dt>
+     * <dd>Backups older than this are deleted. The value is in
+     * seconds, <tt>m</tt>, <tt>h</tt> and <tt>d</tt> suffixes give it
+     * in minutes, hours or days, e.g. <tt>MaxBackupAge=30d</tt>. The
+     * age counts from the last modification of the backup. The
+     * default is zero, no limit.</dd>
+     *
+     * <dt><tt>CompressBackups</tt>, <tt>CompressThreads</tt></dt>
+     * <dd>Backups are compressed the same way as by
+     * {@link RollingFileAppender}, e.g. into
+     * <tt>log.2009-11-07.gz</tt>.</dd>
+     * </dl>
+     *
+     * <p><tt>MaxBackupIndex</tt> and <tt>BackupNaming</tt> are not
+     * used. With <tt>UseLockFile</tt> the backups are listed again at
+     * each rollover, other processes add and delete them as well.
+     */
+    class LOG4CPLUS_EXPORT TimeBasedRollingFileAppender
+        : public DailyRollingFileAppender {
+    public:
+      // Ctors
+        TimeBasedRollingFileAppender(const log4cplus::tstring& filename,
+                                     DailyRollingFileSchedule schedule = DAILY,
+                                     long maxFileSize = 10*1024*1024, // 10 MB
+                                     helpers::file_size_type totalSizeCap = 0,
+                                     unsigned long maxBackupAge = 0,
+                                     bool immediateFlush = true);
+        TimeBasedRollingFileAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~TimeBasedRollingFileAppender();
+
+      // Methods
+        virtual void close();
+
+    protected:
+        virtual void append(const spi::InternalLoggingEvent& event);
+        virtual void rollover();
+
+      // Data
+        /** Maximal size of the file or zero. */
+        helpers::file_size_type maxFileSize;
+
+        /** Index of the backups and the thread deleting them. */
+        helpers::SharedObjectPtr<helpers::BackupRetention> retention;
+
+    private:
+        void init(helpers::file_size_type maxFileSize,
+                  helpers::file_size_type totalSizeCap,
+                  unsigned long maxBackupAge);
+    };
+
 } // end namespace log4cplus
 
 #endif // _LOG4CPLUS_FILE_APPENDER_HEADER_
@@ -100,9 +100,51 @@ namespace log4cplus {
           // Types
             typedef std::vector<SharedAppenderPtr> ListType;
 
+            /**
+             * Immutable, reference counted copy of the list of appenders.
+             * Writers never modify a published snapshot, they replace it
+             * with a new one.
+             */
+            struct ListSnapshot;
+
+          // Methods
+            /**
+             * Returns the current snapshot with its reference count
+             * incremented. When atomic operations are available this does
+             * not lock <code>appender_list_mutex</code>.
+             */
+            ListSnapshot * acquireSnapshot() const;
+
+            /**
+             * Decrements the reference count of the snapshot and deletes it
+             * when it drops to zero.
+             */
+            void releaseSnapshot(ListSnapshot * snapshot) const;
+
+            /**
+             * Publishes <code>list</code> as the new snapshot and releases the
+             * previous one once no reader can be about to acquire it.
+             * <code>appender_list_mutex</code> must be held by the caller.
+             */
+            void replaceSnapshot(ListType const & list);
+
           // Data
-            /** Array of appenders. */
-            ListType appenderList;
+            /** Current snapshot of the array of appenders. */
+            ListSnapshot * volatile appenderList;
+
+            /**
+             * Number of readers acquiring the snapshot, indexed by the
+             * lowest bit of <code>readerEpoch</code>.
+             */
+            mutable int volatile readers[2];
+
+            /** Incremented by every replaceSnapshot() call. */
+            unsigned volatile readerEpoch;
+
+        private:
+          // Disallow copying of instances of this class
+            AppenderAttachableImpl(const AppenderAttachableImpl&);
+            AppenderAttachableImpl& operator=(const AppenderAttachableImpl&);
         };  // end class AppenderAttachableImpl
 
     } // end namespace helpers
@@ -0,0 +1,186 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_BACKUPINDEX_H
+#define LOG4CPLUS_HELPERS_BACKUPINDEX_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/fileoutput.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <deque>
+#include <vector>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * In-memory list of backup files of a rolling appender, oldest first.
+ * The directory is scanned for existing backups only once, by the
+ * first call that needs the list. After that the list is kept up to
+ * date as backups are added and removed, so that a rollover does not
+ * have to list the directory or rename older backups.
+ *
+ * Backup names are the log file name, a dot and a suffix whose form
+ * depends on the naming scheme. Files of other forms are ignored.
+ * A backup can also be compressed, the file name then has additional
+ * <tt>.gz</tt> suffix, or it can be being compressed into a file with
+ * <tt>.gz.tmp</tt> suffix. The list holds names without these
+ * suffixes.
+ *
+ * The class is not thread safe.
+ */
+class LOG4CPLUS_EXPORT BackupIndex
+{
+public:
+    //! Form of backup name suffixes.
+    enum Naming
+    {
+        //! Increasing sequence number, e.g. <tt>log.17</tt>.
+        SEQUENCE,
+        //! Local time of the rollover with milliseconds,
+        //! e.g. <tt>log.20101107-134501.250</tt>.
+        TIMESTAMP,
+        //! Period of DailyRollingFileAppender, e.g.
+        //! <tt>log.2010-11-07</tt>, followed by <tt>.1</tt>,
+        //! <tt>.2</tt>, etc. when the period is rolled over repeatedly.
+        PERIOD
+    };
+
+    //! @param filename Name of the log file.
+    //! @param naming Naming scheme of backups.
+    BackupIndex (tstring const & filename, Naming naming);
+    ~BackupIndex ();
+
+    //! @returns Name for a new SEQUENCE or TIMESTAMP backup. Every
+    //! call returns a name that sorts after the previous ones.
+    tstring nextName (Time const & now);
+
+    //! @returns Name for a new PERIOD backup: <code>name</code> itself
+    //! when the period has no backup yet, otherwise <code>name</code>
+    //! with <tt>.1</tt>, <tt>.2</tt>, etc. appended, one more than
+    //! the highest number of the period's backups.
+    tstring uniqueName (tstring const & name);
+
+    //! Records a new backup as the newest one.
+    //! @param time Time of the backup, used by getOldestTime().
+    //! @param bytes Size of the backup, counted by getTotalSize().
+    void add (tstring const & name, Time const & time = Time (),
+        file_size_type bytes = 0);
+
+    //! Removes the oldest backup from the list. The caller deletes
+    //! the file.
+    //! @returns false when the list is empty.
+    bool popOldest (tstring & name);
+
+    //! @returns Number of backups.
+    std::size_t size ();
+
+    //! @returns Total size of the backups: sizes of PERIOD backups
+    //! found by the scan plus the sizes passed to add(). Both the
+    //! plain and the compressed file of a backup are counted when the
+    //! scan finds both.
+    file_size_type getTotalSize ();
+
+    //! @returns Modification time of the oldest PERIOD backup found by
+    //! the scan or the time passed to add() for it, zero when there
+    //! are no backups.
+    Time getOldestTime ();
+
+    //! Forgets all backups; the next call scans the directory again.
+    void invalidate ();
+
+    //! Finds work left behind by compressions interrupted by a crash.
+    //! @param uncompressed Receives backups that have not been
+    //! compressed.
+    //! @param stale Receives partially written compressed files and
+    //! uncompressed backups whose compressed file is complete.
+    void findUncompressed (std::vector<tstring> & uncompressed,
+        std::vector<tstring> & stale);
+
+protected:
+    //! Forms of a backup found in the directory.
+    enum Form
+    {
+        PLAIN = 1,
+        COMPRESSED = 2,
+        PARTIAL = 4
+    };
+
+    struct Entry
+    {
+        //! Sort key parsed from the suffix, or modification time in
+        //! seconds for PERIOD names.
+        file_size_type key;
+        //! Size of the backup files, see getTotalSize().
+        file_size_type bytes;
+        //! Full name of the backup, without compression suffix.
+        tstring name;
+        //! Form flags.
+        unsigned forms;
+
+        bool operator < (Entry const & other) const;
+
+        //! Orders entries by name.
+        static bool nameLess (Entry const & a, Entry const & b);
+    };
+
+    //! Fills <code>entries</code> from the directory listing.
+    void scan ();
+
+    //! Checks that the suffix has the form of the naming scheme.
+    //! @param key Set to the sort key of the suffix.
+    bool parseSuffix (tstring const & suffix, file_size_type & key) const;
+
+    //! Strips compression suffix.
+    //! @returns Form of the backup.
+    static Form stripForm (tstring & suffix);
+
+    tstring const filename;
+    Naming const naming;
+    //! True when <code>entries</code> reflects the directory.
+    bool scanned;
+    //! Known backups, oldest first.
+    std::deque<Entry> entries;
+    //! Partially compressed files of backups that no longer exist.
+    std::vector<tstring> orphans;
+    //! Last SEQUENCE number handed out or found.
+    file_size_type lastSequence;
+    //! Time of the last TIMESTAMP name handed out.
+    Time lastTime;
+    //! Sum of sizes of the entries.
+    file_size_type totalSize;
+
+private:
+    BackupIndex (BackupIndex const &);
+    BackupIndex & operator = (BackupIndex const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_BACKUPINDEX_H
@@ -0,0 +1,278 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_FILEOUTPUT_H
+#define LOG4CPLUS_HELPERS_FILEOUTPUT_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/logloguser.h>
+#include <cstddef>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * Signed 64 bit integer type used for file sizes and offsets.
+ */
+#if defined (_MSC_VER)
+typedef __int64 file_size_type;
+#elif defined (__GNUC__)
+__extension__ typedef long long file_size_type;
+#else
+typedef long long file_size_type;
+#endif
+
+
+/**
+ * Writes to a file through a raw file descriptor opened with
+ * <code>O_APPEND</code>. Data are collected in a userspace buffer and
+ * written with a single <code>write()</code> call when the buffer
+ * fills up or when flush() is called.
+ *
+ * On Linux the file can be preallocated ahead of the writes and the
+ * written data can be dropped from the page cache once they are on
+ * the disk, see setPreallocate() and setDropCacheBehind().
+ *
+ * Every write() call that fits into the buffer ends up in a single
+ * <code>write()</code> system call together with the other buffered
+ * data. Appends of such whole records are therefore not interleaved
+ * with appends of other processes writing to the same file, see
+ * setShared().
+ *
+ * The class is not thread safe; FileAppender serializes access to it
+ * with its own mutex.
+ */
+class LOG4CPLUS_EXPORT FileOutput
+    : protected LogLogUser
+{
+public:
+    //! @param bufferSize Size of the userspace buffer in bytes. Zero
+    //! makes every write() go straight to the file.
+    explicit FileOutput (std::size_t bufferSize = 8192);
+    virtual ~FileOutput ();
+
+    //! Opens the file, creating it when it does not exist.
+    //! @param name File name.
+    //! @param append When false the file is truncated.
+    //! @returns true on success.
+    virtual bool open (tstring const & name, bool append);
+
+    //! Writes out buffered data and closes the file.
+    virtual void close ();
+
+    //! @returns true when the file is open and no write has failed
+    //! since it was opened.
+    bool good () const;
+
+    //! @returns true when the file is open.
+    bool is_open () const;
+
+    //! Appends data to the buffer, writing the buffer out first when
+    //! the data would not fit into it.
+    virtual void write (char const * data, std::size_t len);
+
+    //! Converts the text to bytes and appends it like above.
+    void write (tstring const & text);
+
+    //! Writes out buffered data.
+    virtual void flush ();
+
+    //! Writes out buffered data and waits until the data written so
+    //! far are on the disk, with <code>fdatasync()</code>.
+    virtual void sync ();
+
+    //! Writes out buffered data and duplicates the file descriptor,
+    //! so that the data can be synced with syncFd() by another thread
+    //! while this output goes on writing, or even after it has
+    //! switched to another file.
+    //! @returns The duplicate or -1 when the file is not open or the
+    //! platform does not support it.
+    virtual int dupForSync ();
+
+    //! @returns Number of bytes waiting in the buffer.
+    std::size_t getBuffered () const { return used; }
+
+    //! @returns Size of the file, including buffered bytes. The size
+    //! is read when the file is opened and then counted; writes of
+    //! other processes to the same file are accounted for only in
+    //! shared mode.
+    file_size_type getSize () const { return size; }
+
+    //! Changes size of the buffer. Buffered data are written out
+    //! first.
+    virtual void setBufferSize (std::size_t bufferSize);
+
+    //! @returns Size of the buffer.
+    std::size_t getBufferSize () const { return capacity; }
+
+    //! Makes the output keep disk space of this many bytes allocated
+    //! ahead of the written data, without changing the file size.
+    //! The allocated space beyond the data is released when the file
+    //! is closed. Zero, the default, disables preallocation. It is
+    //! ignored in shared mode.
+    void setPreallocate (file_size_type bytes) { preallocateSize = bytes; }
+
+    //! When enabled, written data are pushed to the disk in the
+    //! background and dropped from the page cache as soon as they are
+    //! written, so that the log does not evict other cached data.
+    void setDropCacheBehind (bool enable) { dropCache = enable; }
+
+    //! Tells the output that another thread waits for the writeback
+    //! and drops the pages with dupForDropCache() and dropCacheFd().
+    //! Otherwise the writes drop only the pages that have been
+    //! written back by the time of the next step.
+    void setDropCacheDeferred (bool enable) { dropDeferred = enable; }
+
+    //! Takes the range whose writeback the writes have started and
+    //! whose pages have not been dropped yet, and duplicates the file
+    //! descriptor for dropCacheFd().
+    //! @returns The duplicate or -1 when there is nothing to drop.
+    int dupForDropCache (file_size_type & offset, file_size_type & len);
+
+    //! Tells the output that other processes append to the file as
+    //! well. getSize() then includes their data, as of the last
+    //! write of this output.
+    void setShared (bool enable) { shared = enable; }
+
+    //! @returns true when the file name does not refer to the open
+    //! file anymore, e.g. because another process has renamed it, or
+    //! when the file is not open.
+    bool isReplaced () const;
+
+    //! @returns The file descriptor or -1 when the file is not open.
+    int getFd () const { return fd; }
+
+    //! Writes out buffered data and switches output to another open
+    //! file descriptor, e.g. one returned by openFile().
+    //! @param newFd The new descriptor; FileOutput takes ownership.
+    //! @param name Name of the new file, for error messages.
+    //! @returns The previous descriptor; the caller has to close it.
+    virtual int exchange (int newFd, tstring const & name);
+
+    //! Opens file descriptor suitable for exchange(). It does not
+    //! change the state of the output.
+    //! @param err Set to the error number on failure.
+    //! @returns The descriptor or -1 on failure.
+    virtual int openFile (tstring const & name, bool append, int & err) const;
+
+    //! Opens file descriptor the way open() does.
+    //! @param err Set to the error number on failure.
+    //! @returns The descriptor or -1 on failure.
+    static int openFd (tstring const & name, bool append, int & err);
+
+    //! Closes descriptor returned by openFd() or exchange().
+    //! @returns Zero or error number.
+    static int closeFd (int fd);
+
+    //! @returns Size of the file or -1 on failure.
+    static file_size_type getFdSize (int fd);
+
+    //! Waits until the data written to the file are on the disk, with
+    //! <code>fdatasync()</code>, and closes the descriptor returned
+    //! by dupForSync().
+    //! @returns Zero or error number.
+    static int syncFd (int fd);
+
+    //! Waits until the writeback of the range has finished, drops its
+    //! pages from the page cache and closes the descriptor returned
+    //! by dupForDropCache().
+    static void dropCacheFd (int fd, file_size_type offset,
+        file_size_type len);
+
+protected:
+    //! Writes the bytes to the file descriptor, looping over short
+    //! writes. On failure it reports the error and marks the output
+    //! as failed.
+    //! @returns true on success.
+    virtual bool writeOut (char const * data, std::size_t len);
+
+    //! Reports failed system call through LogLog.
+    void reportError (tchar const * func, int err);
+
+    //! Duplicates the file descriptor for dupForSync().
+    //! @returns The duplicate or -1.
+    int dupFd ();
+
+    //! Resets the offsets below for a newly opened file.
+    void resetOffsets ();
+
+    //! Preallocates disk space when data up to the offset would not
+    //! fit into the space allocated already.
+    void preallocate (file_size_type end);
+
+    //! Starts writeback of the data written up to the offset, without
+    //! waiting for it. Unless dropping is deferred it also drops from
+    //! the page cache the pages of the previous steps that have been
+    //! written back. It works in steps of a megabyte.
+    void dropCacheBehind (file_size_type end);
+
+    //! Releases the preallocated space beyond the end of the file and
+    //! the cached pages of the file, before it is closed.
+    void releaseFile ();
+
+    //! Open file descriptor or -1.
+    int fd;
+    //! Set when a write has failed, cleared by open().
+    bool failed;
+    //! Name of the open file, for error messages.
+    tstring filename;
+    //! Userspace buffer.
+    char * buffer;
+    //! Size of buffer.
+    std::size_t capacity;
+    //! Number of bytes in buffer.
+    std::size_t used;
+    //! Size of the file including buffered bytes.
+    file_size_type size;
+    //! Offset of the end of the data written to the file.
+    file_size_type written;
+    //! Bytes to preallocate ahead of the written data or zero.
+    file_size_type preallocateSize;
+    //! End of the preallocated space.
+    file_size_type preallocated;
+    //! True when the page cache should be dropped behind the writes.
+    bool dropCache;
+    //! Offset up to which writeback has been started.
+    file_size_type writebackStarted;
+    //! Offset up to which pages have been dropped from the page cache.
+    file_size_type cacheDropped;
+    //! True when another thread drops the pages, see
+    //! setDropCacheDeferred().
+    bool dropDeferred;
+    //! True when other processes append to the file.
+    bool shared;
+
+private:
+    FileOutput (FileOutput const &);
+    FileOutput & operator = (FileOutput const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_FILEOUTPUT_H
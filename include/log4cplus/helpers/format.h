@@ -0,0 +1,466 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_FORMAT_H
+#define LOG4CPLUS_HELPERS_FORMAT_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/streams.h>
+#include <log4cplus/tstring.h>
+#include <cstddef>
+
+
+namespace log4cplus { namespace helpers {
+
+
+//! Marks a string that lives for the whole run of the program, usually
+//! a string literal. See literal().
+struct FormatLiteral
+{
+    tchar const * str;
+};
+
+
+//! Wraps a string literal passed to the deferred logging macros so that
+//! it is captured by pointer instead of being copied.
+inline
+FormatLiteral
+literal (tchar const * str)
+{
+    FormatLiteral const lit = { str };
+    return lit;
+}
+
+
+//! Argument of format(). It captures integers, floating point numbers,
+//! characters and strings so that format_message() can convert them
+//! without going through a stream. Values of any other type are
+//! written using their operator <<.
+//!
+//! FormatArg only refers to the value it has been constructed from; it
+//! must not outlive it.
+class LOG4CPLUS_EXPORT FormatArg
+{
+public:
+    enum Type
+    {
+        LONG,
+        ULONG,
+        DOUBLE,
+        BOOL,
+        CHAR,
+        CSTR,
+        LITERAL,
+        STR,
+        TEXT,
+        STREAMABLE
+    };
+
+    //! Function writing a value of a streamable type.
+    typedef void (* write_func_type) (tostream &, void const *);
+
+    FormatArg (int v) : type (LONG) { value.l = v; }
+    FormatArg (unsigned v) : type (ULONG) { value.ul = v; }
+    FormatArg (long v) : type (LONG) { value.l = v; }
+    FormatArg (unsigned long v) : type (ULONG) { value.ul = v; }
+    FormatArg (double v) : type (DOUBLE) { value.d = v; }
+    FormatArg (float v) : type (DOUBLE) { value.d = v; }
+    FormatArg (bool v) : type (BOOL) { value.b = v; }
+    FormatArg (tchar v) : type (CHAR) { value.c = v; }
+    FormatArg (tchar const * v) : type (CSTR) { value.cstr = v; }
+    FormatArg (tstring const & v) : type (STR) { value.str = &v; }
+    FormatArg (FormatLiteral v) : type (LITERAL) { value.cstr = v.str; }
+    FormatArg (tchar const * str, std::size_t len)
+        : type (TEXT)
+    {
+        value.text.ptr = str;
+        value.text.len = len;
+    }
+
+    template <typename T>
+    FormatArg (T const & v)
+        : type (STREAMABLE)
+    {
+        value.obj.ptr = &v;
+        value.obj.write = &write_streamable<T>;
+    }
+
+    Type const type;
+
+    union
+    {
+        long l;
+        unsigned long ul;
+        double d;
+        bool b;
+        tchar c;
+        tchar const * cstr;
+        tstring const * str;
+        struct
+        {
+            tchar const * ptr;
+            std::size_t len;
+        } text;
+        struct
+        {
+            void const * ptr;
+            write_func_type write;
+        } obj;
+    } value;
+
+private:
+    template <typename T>
+    static
+    void
+    write_streamable (tostream & os, void const * p)
+    {
+        os << *static_cast<T const *>(p);
+    }
+
+    FormatArg & operator = (FormatArg const &);
+};
+
+
+//! Appends <code>fmt</code> to <code>out</code> with each
+//! <code>{}</code> placeholder replaced by the next argument.
+//! <code>{{</code> and <code>}}</code> produce literal braces. Placeholders
+//! without a corresponding argument are copied to the output unchanged;
+//! superfluous arguments are ignored.
+//!
+//! Integers and characters are formatted like by a default constructed
+//! stream, floating point numbers like by a stream with default
+//! precision, i.e. <code>%g</code>, and <code>bool</code> as
+//! <code>true</code> or <code>false</code>.
+//!
+//! Floating point numbers are converted by <code>sprintf()</code>, so
+//! their decimal point follows the global C locale set by
+//! <code>setlocale()</code>, not the C++ locale of any stream. With
+//! the default "C" locale they are the same as streamed numbers.
+LOG4CPLUS_EXPORT void format_message (tstring & out, tchar const * fmt,
+    FormatArg const * const * args, std::size_t count);
+
+
+inline
+void
+format (tstring & out, tchar const * fmt)
+{
+    format_message (out, fmt, 0, 0);
+}
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1)
+{
+    FormatArg const * const args[] = { &a1 };
+    format_message (out, fmt, args, 1);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2)
+{
+    FormatArg const * const args[] = { &a1, &a2 };
+    format_message (out, fmt, args, 2);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3 };
+    format_message (out, fmt, args, 3);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4 };
+    format_message (out, fmt, args, 4);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4,
+    FormatArg const & a5)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4, &a5 };
+    format_message (out, fmt, args, 5);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4,
+    FormatArg const & a5,
+    FormatArg const & a6)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4, &a5, &a6 };
+    format_message (out, fmt, args, 6);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4,
+    FormatArg const & a5,
+    FormatArg const & a6,
+    FormatArg const & a7)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7 };
+    format_message (out, fmt, args, 7);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4,
+    FormatArg const & a5,
+    FormatArg const & a6,
+    FormatArg const & a7,
+    FormatArg const & a8)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7, &a8 };
+    format_message (out, fmt, args, 8);
+}
+
+
+inline
+void
+format (tstring & out, tchar const * fmt,
+    FormatArg const & a1,
+    FormatArg const & a2,
+    FormatArg const & a3,
+    FormatArg const & a4,
+    FormatArg const & a5,
+    FormatArg const & a6,
+    FormatArg const & a7,
+    FormatArg const & a8,
+    FormatArg const & a9)
+{
+    FormatArg const * const args[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7, &a8, &a9 };
+    format_message (out, fmt, args, 9);
+}
+
+
+//! Message arguments captured for formatting at a later time, possibly
+//! by another thread. Numbers, characters and booleans are stored by
+//! value. Strings are copied; short ones into a buffer inside of the
+//! object, so that capturing a typical message does not allocate.
+//! Strings wrapped by literal() are kept by pointer. Values of other
+//! types are written into text right away.
+//!
+//! The format string is kept by pointer, too. It must be a string
+//! literal or otherwise outlive all copies of the message.
+class LOG4CPLUS_EXPORT DeferredMessage
+{
+public:
+    enum
+    {
+        //! Maximal number of arguments.
+        MAX_ARGS = 9,
+        //! Size of the inline buffer for copied strings.
+        INLINE_TEXT = 64
+    };
+
+    explicit DeferredMessage (tchar const * fmt_)
+    {
+        init (fmt_, 0, 0);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1)
+    {
+        FormatArg const * const a[] = { &a1 };
+        init (fmt_, a, 1);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2)
+    {
+        FormatArg const * const a[] = { &a1, &a2 };
+        init (fmt_, a, 2);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3 };
+        init (fmt_, a, 3);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4 };
+        init (fmt_, a, 4);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4,
+        FormatArg const & a5)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4, &a5 };
+        init (fmt_, a, 5);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4,
+        FormatArg const & a5,
+        FormatArg const & a6)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4, &a5, &a6 };
+        init (fmt_, a, 6);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4,
+        FormatArg const & a5,
+        FormatArg const & a6,
+        FormatArg const & a7)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7 };
+        init (fmt_, a, 7);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4,
+        FormatArg const & a5,
+        FormatArg const & a6,
+        FormatArg const & a7,
+        FormatArg const & a8)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7, &a8 };
+        init (fmt_, a, 8);
+    }
+
+    DeferredMessage (tchar const * fmt_,
+        FormatArg const & a1,
+        FormatArg const & a2,
+        FormatArg const & a3,
+        FormatArg const & a4,
+        FormatArg const & a5,
+        FormatArg const & a6,
+        FormatArg const & a7,
+        FormatArg const & a8,
+        FormatArg const & a9)
+    {
+        FormatArg const * const a[] = { &a1, &a2, &a3, &a4, &a5, &a6, &a7, &a8, &a9 };
+        init (fmt_, a, 9);
+    }
+    DeferredMessage (DeferredMessage const &);
+    ~DeferredMessage ();
+
+    //! Appends the formatted message to <code>out</code>. The result
+    //! is the same as that of format() with the original arguments.
+    void render (tstring & out) const;
+
+private:
+    void init (tchar const * fmt, FormatArg const * const * args,
+        std::size_t count);
+
+    struct Arg
+    {
+        FormatArg::Type type;
+        union
+        {
+            long l;
+            unsigned long ul;
+            double d;
+            bool b;
+            tchar c;
+            tchar const * cstr;
+            struct
+            {
+                std::size_t off;
+                std::size_t len;
+            } text;
+        } value;
+    };
+
+    tchar const * fmt;
+    std::size_t count;
+    Arg args[MAX_ARGS];
+    //! Copied strings, either inline_text or allocated.
+    tchar * text;
+    std::size_t text_size;
+    tchar inline_text[INLINE_TEXT];
+
+    DeferredMessage & operator = (DeferredMessage const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_FORMAT_H
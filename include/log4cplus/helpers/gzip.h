@@ -0,0 +1,147 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_GZIP_H
+#define LOG4CPLUS_HELPERS_GZIP_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * Streaming gzip (RFC 1952) compressor. The deflate stream uses LZ77
+ * with hash chains over a 32 KiB window and a dynamic or fixed Huffman
+ * code for each block, whichever is shorter.
+ *
+ * Input is compressed as it is written but the compressed output lags
+ * behind it by up to one block. flush() makes everything written so
+ * far decodable, finish() completes the gzip member.
+ *
+ * The class is not thread safe.
+ */
+class LOG4CPLUS_EXPORT GzipCompressor
+{
+public:
+    //! @param level Compression level from 1, fastest, to 9, best
+    //! compression, like the levels of <tt>gzip</tt>.
+    explicit GzipCompressor (int level = 6);
+    ~GzipCompressor ();
+
+    //! Compresses the data.
+    //! @param out Compressed output is appended to it.
+    void write (char const * data, std::size_t len, std::string & out);
+
+    //! Compresses all pending input and ends the output on a byte
+    //! boundary with an empty stored block, like zlib's
+    //! <code>Z_SYNC_FLUSH</code>. The gzip member stays open. It does
+    //! nothing when nothing has been written since the last flush()
+    //! or finish().
+    //! @param out Compressed output is appended to it.
+    void flush (std::string & out);
+
+    //! Compresses all pending input and writes the final block and the
+    //! gzip trailer. The next write() starts a new gzip member.
+    //! @param out Compressed output is appended to it.
+    void finish (std::string & out);
+
+    //! @returns true when the header of a gzip member has been
+    //! written and finish() has not been called since.
+    bool isStarted () const { return started; }
+
+    //! @returns File name suffix of gzip files, <tt>.gz</tt>.
+    static tchar const * getFileSuffix () { return LOG4CPLUS_TEXT (".gz"); }
+
+protected:
+    //! Finds matches in the window up to <code>end</code>. Unless
+    //! <code>all</code> is true, it stops when fewer than the longest
+    //! match length bytes are left, so that later input can extend
+    //! the match.
+    void deflate (bool all, std::string & out);
+
+    //! Moves the upper half of the window down.
+    void slide ();
+
+    //! Inserts position into the hash chains.
+    void insert (std::size_t p);
+
+    //! Writes the collected symbols as one block.
+    void writeBlock (bool last, std::string & out);
+
+    void writeHeader (std::string & out);
+    void putBits (unsigned long value, unsigned count, std::string & out);
+    void alignToByte (std::string & out);
+    void reset ();
+
+    //! Maximal number of hash chain entries tried for a match.
+    unsigned const maxChain;
+    //! Match length that is good enough to stop searching.
+    std::size_t const niceMatch;
+    //! Longest match whose positions are inserted into the hash
+    //! chains.
+    std::size_t const maxInsert;
+    //! Two window sizes of input.
+    std::vector<unsigned char> window;
+    //! Position of the first byte that has not been compressed yet.
+    std::size_t pos;
+    //! End of the input in the window.
+    std::size_t end;
+    //! Most recent position for each hash value or -1.
+    std::vector<int> head;
+    //! Previous position with the same hash, indexed by position
+    //! modulo the window size.
+    std::vector<int> prev;
+    //! Symbols of the current block; pairs of distance, zero for
+    //! literals, and literal byte or match length.
+    std::vector<unsigned short> symbols;
+    //! Bits that do not make a whole byte yet.
+    unsigned long bitBuffer;
+    //! Number of bits in bitBuffer.
+    unsigned bitCount;
+    //! CRC-32 of the input of the current member.
+    unsigned long crc;
+    //! Size of the input of the current member modulo 2^32.
+    unsigned long inputSize;
+    //! True when the header of the current member has been written.
+    bool started;
+    //! True when nothing has been written since the last flush() or
+    //! finish().
+    bool flushed;
+
+private:
+    GzipCompressor (GzipCompressor const &);
+    GzipCompressor & operator = (GzipCompressor const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_GZIP_H
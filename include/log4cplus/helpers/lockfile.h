@@ -0,0 +1,114 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_LOCKFILE_H
+#define LOG4CPLUS_HELPERS_LOCKFILE_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/logloguser.h>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * Advisory lock of a file, shared by processes that open the same
+ * file name. It serializes work that must not be done by several
+ * processes at once, e.g. rollover of a log file they all write.
+ *
+ * The lock is taken with <code>flock()</code>, so it also excludes
+ * other LockFile instances of the same process. It is not supported
+ * on platforms without <code>unistd.h</code>; good() then returns
+ * false and lock() does nothing.
+ */
+class LOG4CPLUS_EXPORT LockFile
+    : protected LogLogUser
+{
+public:
+    //! Opens the lock file, creating it when it does not exist.
+    //! @param name Name of the lock file.
+    explicit LockFile (tstring const & name);
+    ~LockFile ();
+
+    //! @returns true when the lock file is open.
+    bool good () const { return fd != -1; }
+
+    //! Waits until the lock is acquired. Failures are reported
+    //! through LogLog and the caller continues without the lock.
+    void lock ();
+
+    //! Releases the lock.
+    void unlock ();
+
+    //! @returns Name of the lock file.
+    tstring const & getName () const { return filename; }
+
+protected:
+    //! Reports failed system call through LogLog.
+    void reportError (tchar const * func, int err);
+
+    tstring const filename;
+    //! Open file descriptor or -1.
+    int fd;
+
+private:
+    LockFile (LockFile const &);
+    LockFile & operator = (LockFile const &);
+};
+
+
+/**
+ * Holds a LockFile locked for its lifetime. A null lock file is
+ * accepted and nothing is locked then.
+ */
+class LockFileGuard
+{
+public:
+    explicit LockFileGuard (LockFile * lf)
+        : lockFile (lf)
+    {
+        if (lockFile)
+            lockFile->lock ();
+    }
+
+    ~LockFileGuard ()
+    {
+        if (lockFile)
+            lockFile->unlock ();
+    }
+
+private:
+    LockFile * const lockFile;
+
+    LockFileGuard (LockFileGuard const &);
+    LockFileGuard & operator = (LockFileGuard const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_LOCKFILE_H
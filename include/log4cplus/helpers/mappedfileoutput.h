@@ -0,0 +1,124 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_MAPPEDFILEOUTPUT_H
+#define LOG4CPLUS_HELPERS_MAPPEDFILEOUTPUT_H
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/helpers/fileoutput.h>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * Writes to a file through a shared memory mapping. The file is
+ * extended with <code>posix_fallocate()</code> in steps of the window
+ * size and only a window of that size around the end of the file is
+ * mapped; it slides forward as the file grows. write() is then a
+ * <code>memcpy()</code> into the mapping, system calls are made only
+ * when the window moves. Callers serialize access, so the end offset
+ * is a plain counter.
+ *
+ * flush() writes the pages dirtied since the last flush to the disk
+ * with <code>msync()</code>. Without it they are written back by the
+ * kernel; they survive a crash of the process, not of the system.
+ *
+ * close() and exchange() truncate the file to the length of the data
+ * written. When a file is opened for appending and its size is a
+ * multiple of the window size, it has not been truncated, e.g.
+ * because of a crash, and the zero bytes at its end are dropped.
+ *
+ * setPreallocate() makes the file grow in bigger steps, rounded up
+ * to whole windows; with setDropCacheBehind() data are dropped from
+ * the page cache once the window has moved past them.
+ *
+ * The output is available only on POSIX systems.
+ */
+class LOG4CPLUS_EXPORT MappedFileOutput
+    : public FileOutput
+{
+public:
+    //! @param windowSize Size of the mapped window and of the
+    //! preallocation steps in bytes. It is rounded up to a multiple
+    //! of the page size.
+    explicit MappedFileOutput (std::size_t windowSize = 16 * 1024 * 1024);
+    virtual ~MappedFileOutput ();
+
+    virtual bool open (tstring const & name, bool append);
+    virtual void close ();
+    virtual void write (char const * data, std::size_t len);
+    virtual void flush ();
+    virtual int exchange (int newFd, tstring const & name);
+
+    //! Duplicates the file descriptor without flush(), so that the
+    //! dirty pages are written back by syncFd() and not under the
+    //! caller's lock.
+    virtual int dupForSync ();
+
+    //! Opens the file for reading and writing, memory mappings need
+    //! both, and without <code>O_APPEND</code>.
+    virtual int openFile (tstring const & name, bool append, int & err) const;
+
+    //! @returns Size of the mapped window.
+    std::size_t getWindowSize () const { return windowSize; }
+
+protected:
+    //! Maps the window containing the offset, extending the file when
+    //! it is shorter than the end of the window.
+    //! @returns true on success.
+    bool mapWindow (file_size_type offset);
+
+    //! Unmaps the window.
+    void unmapWindow ();
+
+    //! Truncates the file to the length of the data written.
+    void truncate ();
+
+    //! @returns Length of the data in the open file, without the zero
+    //! bytes of preallocated space that has not been written to.
+    file_size_type findEnd ();
+
+    //! Size of the window, a multiple of the page size.
+    std::size_t const windowSize;
+    //! Start of the mapped window or null.
+    char * window;
+    //! File offset of the window.
+    file_size_type windowOffset;
+    //! Length of the file including preallocated space.
+    file_size_type allocated;
+    //! Offset up to which the data have been flushed.
+    file_size_type synced;
+
+private:
+    MappedFileOutput (MappedFileOutput const &);
+    MappedFileOutput & operator = (MappedFileOutput const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_HELPERS_MAPPEDFILEOUTPUT_H
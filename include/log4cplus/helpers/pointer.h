@@ -68,6 +68,10 @@ namespace log4cplus {
             SharedObject& operator=(const SharedObject&) { return *this; }
 
         public:
+            /** Protects <code>count</code> where atomic operations are
+             *  not available. Appenders and their threads serialize on
+             *  it too. It is locked directly, also outside the library,
+             *  so it is created with every object. */
             LOG4CPLUS_MUTEX_PTR_DECLARE access_mutex;
 
         private:
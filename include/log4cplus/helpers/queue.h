@@ -0,0 +1,178 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_QUEUE_H
+#define LOG4CPLUS_HELPERS_QUEUE_H
+
+#include <log4cplus/config.hxx>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <log4cplus/loglevel.h>
+#include <log4cplus/helpers/pointer.h>
+#include <log4cplus/helpers/syncprims.h>
+#include <vector>
+
+
+namespace log4cplus {
+
+namespace spi {
+
+class InternalLoggingEvent;
+
+} // namespace spi
+
+
+namespace thread {
+
+
+//! Bounded queue of logging events shared by many producer threads
+//! and a single consumer thread. The queue owns the events it holds;
+//! they are copies of the events passed to put_event(), taken from
+//! spi::EventPool. Events returned by the consumer through
+//! recycle_events() are handed back to the producers' pools.
+class LOG4CPLUS_EXPORT Queue
+    : public virtual helpers::SharedObject
+{
+public:
+    //! Type of the buffer filled by get_events().
+    typedef std::vector<spi::InternalLoggingEvent *> queue_storage_type;
+
+    //! What put_event() does when the queue is full.
+    enum OverflowPolicy
+    {
+        //! Wait until the consumer makes room.
+        BLOCK,
+        //! Discard the event being put.
+        DROP_NEWEST,
+        //! Discard the oldest queued event to make room.
+        DROP_OLDEST,
+        //! Discard the event being put if its log level is below the
+        //! threshold, otherwise wait like BLOCK.
+        DROP_BELOW_THRESHOLD
+    };
+
+    //! @param len Maximal length of the queue.
+    //! @param policy Overflow policy.
+    //! @param threshold Log level threshold for DROP_BELOW_THRESHOLD.
+    explicit Queue (unsigned len = 100, OverflowPolicy policy = BLOCK,
+        LogLevel threshold = NOT_SET_LOG_LEVEL);
+    virtual ~Queue ();
+
+    // Producers' methods.
+
+    //! Puts a copy of the event into the queue.
+    //! @returns Flags.
+    unsigned put_event (spi::InternalLoggingEvent const & ev);
+
+    //! Signals the consumer thread to exit.
+    //! @param drain When true the consumer delivers all events that
+    //! are still queued before it exits; when false the queued events
+    //! are discarded.
+    //! @returns Flags.
+    unsigned signal_exit (bool drain = true);
+
+    // Consumer's methods.
+
+    //! Waits for events and moves all of them into the buffer.
+    //! @param buf Buffer the events are appended to. The caller
+    //! takes ownership of them.
+    //! @param msec Maximal time to wait for events in milliseconds,
+    //! zero means wait indefinitely.
+    //! @returns Flags.
+    unsigned get_events (queue_storage_type * buf, unsigned long msec = 0);
+
+    //! Takes back events retrieved by get_events() once they have been
+    //! delivered and clears the buffer.
+    void recycle_events (queue_storage_type * buf);
+
+    //! Returns the number of events discarded because of overflow
+    //! since the last call of this function and resets the counter.
+    unsigned long reset_dropped_count ();
+
+    //! Possible state flags.
+    enum Flags
+    {
+        //! EVENT flag is set in return value of get_events() when
+        //! at least one event has been retrieved.
+        EVENT      = 0x0001,
+        //! QUEUE flag is set when the event passed to put_event()
+        //! has been queued.
+        QUEUE      = 0x0002,
+        //! DROPPED flag is set when an event has been discarded
+        //! because of the overflow policy.
+        DROPPED    = 0x0004,
+        //! EXIT flag is set by signal_exit().
+        EXIT       = 0x0008,
+        //! When DRAIN flag is set together with EXIT flag, the queue
+        //! worker thread will first drain the queue before exiting.
+        DRAIN      = 0x0010
+    };
+
+protected:
+    //! Pops the oldest event out of the ring. Mutex must be held.
+    spi::InternalLoggingEvent * pop_front ();
+    //! Deletes all queued events. Mutex must be held.
+    void clear ();
+
+    //! Ring of queued events.
+    queue_storage_type ring;
+    //! Index of the oldest event in the ring.
+    std::size_t head;
+    //! Number of events in the ring.
+    std::size_t count;
+    //! Delivered events waiting to be reused by producers.
+    queue_storage_type spare;
+    //! Number of events discarded since last reset_dropped_count().
+    unsigned long dropped;
+    //! Overflow policy.
+    OverflowPolicy const policy;
+    //! Threshold for DROP_BELOW_THRESHOLD policy.
+    LogLevel const threshold;
+    //! Mutex protecting the queue and the flags.
+    Mutex mutex;
+    //! Signalled when the queue becomes non-empty or on exit.
+    ManualResetEvent ev_consumer;
+    //! Signalled when the consumer makes room in a full queue or on
+    //! exit.
+    ManualResetEvent ev_producers;
+    //! State flags.
+    unsigned flags;
+
+private:
+    Queue (Queue const &);
+    Queue & operator = (Queue const &);
+};
+
+
+typedef helpers::SharedObjectPtr<Queue> QueuePtr;
+
+
+} } // namespace log4cplus { namespace thread {
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_HELPERS_QUEUE_H
@@ -48,6 +48,8 @@ namespace log4cplus {
             size_t getSize() const { return size; }
             void setSize(size_t s) { size = s; }
             size_t getPos() const { return pos; }
+            //! Empties the buffer for reuse.
+            void clear() { size = 0; pos = 0; }
 
             unsigned char readByte();
             unsigned short readShort();
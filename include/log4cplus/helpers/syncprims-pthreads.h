@@ -262,10 +262,12 @@ ManualResetEvent::timed_wait (unsigned long msec) const
 
     if (! signaled)
     {       
-        helpers::Time const wakeup_time (helpers::Time::gettimeofday ()
+        // pthread_cond_timedwait() measures the deadline against
+        // CLOCK_REALTIME, whatever clock the timestamps come from.
+        helpers::Time const wakeup_time (helpers::Time::realtime ()
             + helpers::Time (msec / 1000, (msec % 1000) * 1000));
         struct timespec const ts = {wakeup_time.sec (),
-            wakeup_time.usec () * 1000};
+            wakeup_time.nsec ()};
         unsigned prev_count = sigcount;
         do
         {
@@ -139,5 +139,25 @@ LOG4CPLUS_EXPORT void deleteMutex(LOG4CPLUS_MUTEX_PTR_DECLARE);
 #define LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX } while (0)
 
 
+/**
+ * @def LOG4CPLUS_HAVE_ATOMICS
+ * Defined when LOG4CPLUS_ATOMIC_INCREMENT(x),
+ * LOG4CPLUS_ATOMIC_DECREMENT(x), LOG4CPLUS_ATOMIC_COMPARE_AND_SWAP(x,
+ * o, n) and LOG4CPLUS_MEMORY_BARRIER() are available. The increment
+ * and decrement return the new value, the compare and swap returns
+ * true when it has stored <code>n</code>. All of them act as full
+ * memory barriers.
+ */
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) && defined (__GNUC__) \
+    && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#  define LOG4CPLUS_HAVE_ATOMICS 1
+#  define LOG4CPLUS_ATOMIC_INCREMENT(x) __sync_add_and_fetch (&(x), 1)
+#  define LOG4CPLUS_ATOMIC_DECREMENT(x) __sync_sub_and_fetch (&(x), 1)
+#  define LOG4CPLUS_ATOMIC_COMPARE_AND_SWAP(x, o, n) \
+    __sync_bool_compare_and_swap (&(x), (o), (n))
+#  define LOG4CPLUS_MEMORY_BARRIER() __sync_synchronize ()
+#endif
+
+
 #endif // LOG4CPLUS_HELPERS_THREAD_CONFIG_HEADER_
 
@@ -25,6 +25,7 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/tstring.h>
+#include <vector>
 
 #if defined (LOG4CPLUS_HAVE_TIME_H)
 #include <time.h>
@@ -52,41 +53,140 @@ using std::tm;
 
 
 /**
- * This class represents a Epoch time with microsecond accuracy.
+ * Signed 64 bit integer type used to store Time.
+ */
+#if defined (_MSC_VER)
+typedef __int64 time_ns_type;
+#elif defined (__GNUC__)
+__extension__ typedef long long time_ns_type;
+#else
+typedef long long time_ns_type;
+#endif
+
+
+/**
+ * Clocks Time::gettimeofday() can read.
+ */
+enum ClockSource
+{
+    /** <code>CLOCK_REALTIME</code>, or the best wall clock available. */
+    REALTIME_CLOCK,
+    /** <code>CLOCK_REALTIME_COARSE</code>. It is much cheaper to read
+     *  than REALTIME_CLOCK but it advances only with the kernel
+     *  tick. */
+    COARSE_CLOCK,
+    /** <code>CLOCK_MONOTONIC</code> offset to the wall time when the
+     *  clock is selected. It never goes back but it does not follow
+     *  adjustments of the system time. */
+    MONOTONIC_CLOCK,
+    /** The processor's time stamp counter, calibrated against
+     *  <code>CLOCK_REALTIME</code> about once a second. Reading it
+     *  costs a few nanoseconds. It is available only on x86
+     *  processors with invariant TSC. */
+    TSC_CLOCK
+};
+
+
+/**
+ * Selects the clock used by Time::gettimeofday() from now on.
+ *
+ * @return The clock actually selected. It is REALTIME_CLOCK when the
+ * requested clock is not available.
+ */
+LOG4CPLUS_EXPORT ClockSource setClockSource (ClockSource source);
+
+/**
+ * Returns the clock used by Time::gettimeofday().
+ */
+LOG4CPLUS_EXPORT ClockSource getClockSource ();
+
+
+/**
+ * This class represents a Epoch time with nanosecond accuracy. It is
+ * stored as a single count of nanoseconds.
  */
 class LOG4CPLUS_EXPORT Time {
 public:
-    Time();
+    enum
+    {
+        NSEC_PER_SEC = 1000000000,
+        NSEC_PER_USEC = 1000
+    };
+
+    Time() : ns(0) { }
     Time(time_t tv_sec, long tv_usec);
     explicit Time(time_t time);
 
     /**
-     * Returns the current time using the <code>gettimeofday()</code>
-     * method if it is available on the current platform.  (Not on 
-     * WIN32.)
+     * Returns the current time read from the clock selected by
+     * setClockSource().
      */
     static Time gettimeofday();
 
+    /**
+     * Returns the current wall clock time, <code>CLOCK_REALTIME</code>,
+     * regardless of the clock selected by setClockSource(). Absolute
+     * deadlines of timed waits are computed from it.
+     */
+    static Time realtime();
+
+    /**
+     * Returns Time of <code>count</code> nanoseconds since the Epoch.
+     */
+    static Time fromNanoseconds(time_ns_type count)
+    {
+        Time t;
+        t.ns = count;
+        return t;
+    }
+
   // Methods
     /**
      * Returns <i>seconds</i> value.
      */
-    time_t sec() const { return tv_sec; }
+    time_t sec() const
+    {
+        return static_cast<time_t>(ns >= 0
+            ? ns / NSEC_PER_SEC
+            : -((-ns - 1) / NSEC_PER_SEC) - 1);
+    }
 
     /**
      * Returns <i>microseconds</i> value.
      */
-    long usec() const { return tv_usec; }
+    long usec() const { return nsec() / NSEC_PER_USEC; }
+
+    /**
+     * Returns <i>nanoseconds</i> value, i.e., the fraction of the
+     * current second.
+     */
+    long nsec() const
+    {
+        long const rem = static_cast<long>(ns % NSEC_PER_SEC);
+        return rem >= 0 ? rem : rem + NSEC_PER_SEC;
+    }
+
+    /**
+     * Returns the number of nanoseconds since the Epoch.
+     */
+    time_ns_type nanoseconds() const { return ns; }
 
     /**
      * Sets the <i>seconds</i> value.
      */
-    void sec(time_t s) { tv_sec = s; }
+    void sec(time_t s)
+    {
+        ns = static_cast<time_ns_type>(s) * NSEC_PER_SEC + nsec();
+    }
 
     /**
      * Sets the <i>microseconds</i> value.
      */
-    void usec(long us) { tv_usec = us; }
+    void usec(long us)
+    {
+        ns = static_cast<time_ns_type>(sec()) * NSEC_PER_SEC
+            + static_cast<time_ns_type>(us) * NSEC_PER_USEC;
+    }
 
     /**
      * Sets this Time using the <code>mktime</code> function.
@@ -127,18 +227,17 @@ public:
                                         bool use_gmtime = false) const;
 
   // Operators
-    Time& operator+=(const Time& rhs);
-    Time& operator-=(const Time& rhs);
-    Time& operator/=(long rhs);
-    Time& operator*=(long rhs);
+    Time& operator+=(const Time& rhs) { ns += rhs.ns; return *this; }
+    Time& operator-=(const Time& rhs) { ns -= rhs.ns; return *this; }
+    Time& operator/=(long rhs) { ns /= rhs; return *this; }
+    Time& operator*=(long rhs) { ns *= rhs; return *this; }
 
 private:
     void build_q_value (log4cplus::tstring & q_str) const;
     void build_uc_q_value (log4cplus::tstring & uc_q_str) const;
 
   // Data
-    time_t tv_sec;  /* seconds */
-    long tv_usec;  /* microseconds */
+    time_ns_type ns;  /* nanoseconds since the Epoch */
 };
 
 
@@ -170,6 +269,92 @@ LOG4CPLUS_EXPORT bool operator==(const log4cplus::helpers::Time& lhs,
 LOG4CPLUS_EXPORT bool operator!=(const log4cplus::helpers::Time& lhs,
                                  const log4cplus::helpers::Time& rhs);
 
+
+/**
+ * This class formats Time values using the same format string
+ * repeatedly. The output is identical to that of
+ * Time::getFormattedTime().
+ *
+ * Each thread remembers the text rendered for the last second it
+ * formatted. Further times within the same second only have the
+ * <code>%q</code> and <code>%Q</code> digits spliced into a copy of
+ * that text, without calling <code>localtime()</code> or
+ * <code>strftime()</code>.
+ *
+ * Formats that use only <code>%Y %y %m %d %e %j %H %M %S %F %T %s %z
+ * %q %Q %n %t %%</code> are compiled into a list of fixed width digit
+ * fields and rendered without <code>strftime()</code>. Local time is
+ * computed from a per-thread cached UTC offset, which is looked up
+ * again only when the time leaves the interval the offset was found
+ * valid for. Changes of the <code>TZ</code> environment variable are
+ * therefore not noticed until then. Other formats are rendered by
+ * <code>strftime()</code> once per second.
+ */
+class LOG4CPLUS_EXPORT TimeFormatter {
+public:
+    TimeFormatter(const log4cplus::tstring& fmt, bool use_gmtime = false);
+    ~TimeFormatter();
+
+    /**
+     * Appends the formatted time <code>t</code> to <code>str</code>.
+     */
+    void appendFormattedTime(log4cplus::tstring& str, const Time& t) const;
+
+    /**
+     * Returns the formatted time <code>t</code>.
+     */
+    log4cplus::tstring getFormattedTime(const Time& t) const;
+
+    const log4cplus::tstring& getFormat() const { return format; }
+    bool getUseGMTime() const { return use_gmtime; }
+
+    /** Per-thread cache entry, defined in the implementation. */
+    struct CacheEntry;
+
+private:
+    //! One directive of a compiled format.
+    struct Directive
+    {
+        //! Conversion specifier, or zero for literal text.
+        tchar spec;
+        //! Literal text.
+        log4cplus::tstring text;
+    };
+
+    void compile();
+    void render(CacheEntry& entry, const Time& t) const;
+    bool renderCompiled(CacheEntry& entry, const Time& t) const;
+
+  // Data
+    log4cplus::tstring format;
+    bool use_gmtime;
+
+    //! False when the format cannot be split, see the constructor.
+    bool cacheable;
+
+    //! Parts of the format between the %q and %Q fields, passed to
+    //! Time::getFormattedTime(). There is always one more piece than
+    //! there are fields.
+    std::vector<log4cplus::tstring> pieces;
+
+    //! Either 'q' or 'Q' for each field.
+    std::vector<tchar> fields;
+
+    //! True when the format has been compiled into the program.
+    bool compiled;
+
+    //! The compiled format.
+    std::vector<Directive> program;
+
+    //! Identifies this instance in the per-thread caches.
+    unsigned long id;
+
+  // Disallow copying of instances of this class
+    TimeFormatter(const TimeFormatter&);
+    TimeFormatter& operator=(const TimeFormatter&);
+};
+
+
 } // namespace helpers
 
 } // namespace log4cplus
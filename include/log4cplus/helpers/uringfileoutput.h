@@ -0,0 +1,213 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_URINGFILEOUTPUT_H
+#define LOG4CPLUS_HELPERS_URINGFILEOUTPUT_H
+
+#include <log4cplus/config.hxx>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <log4cplus/helpers/fileoutput.h>
+#include <log4cplus/helpers/pointer.h>
+#include <log4cplus/helpers/syncprims.h>
+#include <vector>
+
+
+namespace log4cplus { namespace helpers {
+
+
+/**
+ * Writes to a file asynchronously through Linux io_uring. The ring is
+ * driven by the raw system calls, no library is needed.
+ *
+ * Data are collected in a fixed set of buffers registered with the
+ * kernel. A full buffer, or the partially filled one on flush(), is
+ * submitted as a single write at its offset in the file and the
+ * caller continues with the next free buffer; it waits only when all
+ * buffers are in flight, which bounds both memory and the number of
+ * outstanding writes. A background thread reaps the completions,
+ * resubmits the rest of short writes and returns the buffers.
+ * Errors are reported by the next call of the writing thread. When
+ * waiting for completions fails for another reason than an interrupt
+ * or a full completion queue, the error is reported through LogLog,
+ * the writes in flight are given up and the output fails.
+ *
+ * Writes carry explicit offsets, so the file is opened without
+ * <code>O_APPEND</code> and the output cannot share the file with
+ * other processes. sync() waits for the writes in flight and then
+ * submits <code>fdatasync()</code> through the ring; syncFd() on the
+ * descriptor from dupForSync() calls it directly. close() and
+ * exchange() wait for the writes to the file in flight, so that the
+ * file is complete once it is closed or renamed.
+ *
+ * When the kernel does not support io_uring, isAvailable() returns
+ * false and the output must not be used; FileAppender then falls back
+ * to FileOutput.
+ */
+class LOG4CPLUS_EXPORT UringFileOutput
+    : public FileOutput
+{
+public:
+    //! @param bufferSize Size of each buffer in bytes.
+    //! @param queueDepth Number of buffers, i.e. maximal number of
+    //! writes in flight.
+    explicit UringFileOutput (std::size_t bufferSize = 64 * 1024,
+        unsigned queueDepth = 8);
+    virtual ~UringFileOutput ();
+
+    //! @returns true when the ring has been set up.
+    bool isAvailable () const { return ring != 0; }
+
+    virtual void close ();
+    virtual void write (char const * data, std::size_t len);
+
+    //! Submits the partially filled buffer. It does not wait for the
+    //! write to complete.
+    virtual void flush ();
+
+    //! Waits for the writes in flight and then submits
+    //! <code>fdatasync()</code> through the ring and waits for it.
+    virtual void sync ();
+
+    //! Waits for the writes in flight, so that syncing the duplicate
+    //! covers them.
+    virtual int dupForSync ();
+
+    virtual int exchange (int newFd, tstring const & name);
+
+    //! Waits for the writes in flight and replaces the buffers.
+    virtual void setBufferSize (std::size_t bufferSize);
+
+    //! Opens the file without <code>O_APPEND</code>.
+    virtual int openFile (tstring const & name, bool append, int & err) const;
+
+    //! @returns Number of buffers.
+    unsigned getQueueDepth () const { return queueDepth; }
+
+protected:
+    struct Ring;
+    class Reaper;
+    friend class Reaper;
+
+    //! Buffer and the write it is used for.
+    struct Slot
+    {
+        char * data;
+        //! Number of bytes in the buffer.
+        std::size_t len;
+        //! Number of bytes written already.
+        std::size_t done;
+        //! File offset of the buffer.
+        file_size_type offset;
+        //! File descriptor the buffer is written to.
+        int fd;
+        //! Set while the write is in flight; protected by the mutex.
+        bool queued;
+    };
+
+    //! Sets up the ring and starts the reaper thread.
+    void setupRing ();
+
+    //! Stops the reaper thread and tears the ring down.
+    void closeRing ();
+
+    //! Allocates the buffers and registers them with the ring.
+    void allocSlots (std::size_t bufferSize);
+
+    //! Unregisters and frees the buffers. No write may be in flight.
+    void freeSlots ();
+
+    //! Takes a free buffer as the current one, waiting for one when
+    //! all are in flight.
+    void acquireSlot ();
+
+    //! Waits until no write is in flight.
+    void waitIdle ();
+
+    //! Queues the rest of the buffer's write. Mutex must be held.
+    void queueWrite (unsigned index);
+
+    //! Queues an operation without data. Mutex must be held.
+    void queueOp (unsigned char opcode, int fd_, unsigned userData);
+
+    //! Passes the queued operations to the kernel. Mutex must be held.
+    void submitQueued ();
+
+    //! Reaps completions until the exit operation completes or the
+    //! ring fails. Run by the reaper thread.
+    void reap ();
+
+    //! Reports failure of the ring, completes the operations in
+    //! flight with the error and makes further ones fail right away.
+    //! Mutex must be held.
+    void failRing (int err);
+
+    //! Reports the error of a write completed in the background, if
+    //! any, and marks the output as failed.
+    void checkError ();
+
+    //! Mapped ring or null.
+    Ring * ring;
+    //! Number of buffers.
+    unsigned const queueDepth;
+    //! Size of each buffer.
+    std::size_t slotSize;
+    //! The buffers.
+    std::vector<Slot> slots;
+    //! Index of the buffer being filled or <code>NO_SLOT</code>.
+    unsigned current;
+
+    //! Protects the submission queue and the data below.
+    thread::Mutex mutex;
+    //! Signalled when a write or the sync completes.
+    thread::ManualResetEvent completed_ev;
+    //! Indexes of free buffers.
+    std::vector<unsigned> freeList;
+    //! Number of operations in flight.
+    unsigned inFlight;
+    //! Error number of a failed background write or zero.
+    int ioError;
+    //! Result of the last sync; set when it has completed.
+    int syncResult;
+    bool syncDone;
+    //! Set when the reaper has stopped because of an error of the
+    //! ring itself.
+    bool ringFailed;
+    //! Reaps completions.
+    SharedObjectPtr<Reaper> reaper;
+
+private:
+    UringFileOutput (UringFileOutput const &);
+    UringFileOutput & operator = (UringFileOutput const &);
+};
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_HELPERS_URINGFILEOUTPUT_H
@@ -289,6 +289,12 @@ namespace log4cplus {
          */
         void updateChildren(ProvisionNode& pn, Logger logger);
 
+        /**
+         * Increments the generation counter and thus invalidates the
+         * effective LogLevels cached by all loggers of this hierarchy.
+         */
+        void bumpGeneration();
+
     // Data
        LOG4CPLUS_MUTEX_PTR_DECLARE hashtable_mutex;
        std::auto_ptr<spi::LoggerFactory> defaultFactory;
@@ -297,6 +303,7 @@ namespace log4cplus {
        Logger root;
 
        int disableValue;
+       unsigned volatile generation;
 
        bool emittedNoAppenderWarning;
        bool emittedNoResourceBundleWarning;
@@ -32,6 +32,7 @@
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/spi/loggingevent.h>
 
+#include <memory>
 #include <vector>
 
 
@@ -39,7 +40,7 @@ namespace log4cplus {
 
     // Forward Declarations
     namespace pattern {
-        class PatternConverter;
+        class PatternProgram;
     }
 
 
@@ -56,7 +57,41 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event) = 0;
+
+        /**
+         * Appends the formatted event to <code>output</code>. This is
+         * what appenders call. The default implementation formats the
+         * event through the stream interface above, so layouts that
+         * implement only that one keep working.
+         *
+         * The layouts of this library append to the string directly
+         * only when the event is formatted by the library class
+         * itself. For classes derived from them this overload goes
+         * through the stream interface too, so that layouts that
+         * override only the stream overload are still used.
+         */
+        virtual void formatAndAppend(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
     protected:
+        /**
+         * Implements the stream interface in layouts that override the
+         * string one. The event is formatted by appendFormatted() into
+         * a buffer cached per thread, which is then written to the
+         * stream at once.
+         */
+        void formatAndWrite(log4cplus::tostream& output, 
+                            const log4cplus::spi::InternalLoggingEvent& event);
+
+        /**
+         * Appends the event formatted by this very layout class. The
+         * layouts of this library implement it, the default
+         * implementation calls the string overload of
+         * formatAndAppend().
+         */
+        virtual void appendFormatted(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
         LogLevelManager& llmCache;
         
     private:
@@ -84,6 +119,12 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event);
+        virtual void formatAndAppend(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
+    protected:
+        virtual void appendFormatted(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
 
     private: 
       // Disallow copying of instances of this class
@@ -138,10 +179,18 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event);
+        virtual void formatAndAppend(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
 
     protected:
+        virtual void appendFormatted(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
        log4cplus::tstring dateFormat;
        bool use_gmtime;
+
+       /** Formatter of <code>dateFormat</code>, created on first use. */
+       std::auto_ptr<helpers::TimeFormatter> formatter;
      
     private: 
       // Disallow copying of instances of this class
@@ -370,7 +419,8 @@ namespace log4cplus {
      *   <td align=center><b>i</b></td>
      *
      *   <td>Used to output the process ID of the process that generated the
-     *   logging event.</td>
+     *   logging event. It is taken when the pattern is compiled, like
+     *   the host name.</td>
      * </tr>
      *
      * <tr>
@@ -511,12 +561,20 @@ namespace log4cplus {
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event);
 
+        virtual void formatAndAppend(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
     protected:
+        virtual void appendFormatted(log4cplus::tstring& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
         void init(const log4cplus::tstring& pattern, unsigned ndcMaxDepth = 0);
 
       // Data
         log4cplus::tstring pattern;
-        std::vector<pattern::PatternConverter*> parsedPattern;
+
+        /** The pattern compiled into a list of instructions. */
+        pattern::PatternProgram* program;
 
     private: 
       // Disallow copying of instances of this class
@@ -49,6 +49,13 @@ namespace log4cplus
 
     }
 
+    namespace helpers
+    {
+
+        class DeferredMessage;
+
+    }
+
 
     /** \typedef std::vector<Logger> LoggerList
      * This is a list of {@link Logger Loggers}. */
@@ -183,6 +190,14 @@ namespace log4cplus
         void forcedLog(LogLevel ll, const log4cplus::tstring& message,
                        const char* file=NULL, int line=-1) const;
 
+        /**
+         * This method creates a new logging event with a message that
+         * is formatted only when an appender asks for it and logs the
+         * event without further checks.
+         */
+        void forcedLog(LogLevel ll, const helpers::DeferredMessage& message,
+                       const char* file=NULL, int line=-1) const;
+
         /**
          * Call the appenders in the hierrachy starting at
          * <code>this</code>.  If no appenders could be found, emit a
@@ -337,6 +352,24 @@ namespace log4cplus
 } // end namespace log4cplus
 
 
+#include <log4cplus/spi/loggerimpl.h>
+
+
+namespace log4cplus
+{
+
+    // The check is inline so that a disabled logging statement only loads
+    // the hierarchy generation and compares against the cached LogLevel.
+    inline
+    bool
+    Logger::isEnabledFor(LogLevel ll) const
+    {
+        return value->isEnabledForCached(ll);
+    }
+
+} // end namespace log4cplus
+
+
 #include <log4cplus/loggingmacros.h>
 
 
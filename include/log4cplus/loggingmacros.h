@@ -26,6 +26,7 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/streams.h>
+#include <log4cplus/helpers/format.h>
 
 
 #if defined(LOG4CPLUS_DISABLE_FATAL) && !defined(LOG4CPLUS_DISABLE_ERROR)
@@ -45,14 +46,84 @@
 #endif
 
 
-#if defined (LOG4CPLUS_SINGLE_THREADED)
-
 namespace log4cplus
 {
 
-extern LOG4CPLUS_EXPORT tostringstream _macros_oss;
+//! Stream buffer that appends everything written into it to a tstring.
+//! The string keeps its capacity when it is reused.
+class LOG4CPLUS_EXPORT _tstring_streambuf
+    : public std::basic_streambuf<tchar>
+{
+public:
+    tstring str;
+
+protected:
+    virtual int_type overflow (int_type c);
+    virtual std::streamsize xsputn (tchar const * s, std::streamsize n);
+};
+
+
+//! Stream and its buffer used by LOG4CPLUS_MACRO_BODY. Instances are
+//! cached per thread by _get_macros_oss() and _put_macros_oss().
+struct LOG4CPLUS_EXPORT _macros_oss_entry
+{
+    _macros_oss_entry ();
+
+    _tstring_streambuf buf;
+    tostream stream;
+    _macros_oss_entry * next;
+
+private:
+    _macros_oss_entry (_macros_oss_entry const &);
+    _macros_oss_entry & operator = (_macros_oss_entry const &);
+};
+
 
-LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
+//! Returns a cleared stream from the calling thread's cache. Nested
+//! calls, e.g. when operator << of logged object logs itself, get
+//! distinct streams.
+LOG4CPLUS_EXPORT _macros_oss_entry * _get_macros_oss ();
+
+//! Returns the stream into the calling thread's cache.
+LOG4CPLUS_EXPORT void _put_macros_oss (_macros_oss_entry *);
+
+
+//! Holds a cached stream for the duration of one macro invocation.
+class _macros_oss_holder
+{
+public:
+    _macros_oss_holder ()
+        : entry (_get_macros_oss ())
+    { }
+
+    ~_macros_oss_holder ()
+    {
+        _put_macros_oss (entry);
+    }
+
+    tostream & stream () const
+    {
+        return entry->stream;
+    }
+
+    //! The formatted message, referenced in place.
+    tstring const & str () const
+    {
+        return entry->buf.str;
+    }
+
+    //! The message buffer for direct formatting, bypassing the stream.
+    tstring & buffer () const
+    {
+        return entry->buf.str;
+    }
+
+private:
+    _macros_oss_entry * entry;
+
+    _macros_oss_holder (_macros_oss_holder const &);
+    _macros_oss_holder & operator = (_macros_oss_holder const &);
+};
 
 } // namespace log4cplus
 
@@ -60,36 +131,44 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
 #define LOG4CPLUS_MACRO_BODY(logger, logEvent, logLevel)                \
     do {                                                                \
         if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
-            log4cplus::_clear_tostringstream (log4cplus::_macros_oss);  \
-            log4cplus::_macros_oss << logEvent;                         \
+            log4cplus::_macros_oss_holder _log4cplus_buf;               \
+            _log4cplus_buf.stream () << logEvent;                       \
             (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
-                log4cplus::_macros_oss.str(), __FILE__, __LINE__);      \
+                _log4cplus_buf.str (), __FILE__, __LINE__);             \
         }                                                               \
     } while (0)
 
 
-#else // defined (LOG4CPLUS_SINGLE_THREADED)
-
-#define LOG4CPLUS_MACRO_BODY(logger, logEvent, logLevel)                \
+#define LOG4CPLUS_MACRO_STR_BODY(logger, logEvent, logLevel)            \
     do {                                                                \
         if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
-            log4cplus::tostringstream _log4cplus_buf;                   \
-            _log4cplus_buf << logEvent;                                 \
             (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
-                _log4cplus_buf.str(), __FILE__, __LINE__);              \
+                logEvent, __FILE__, __LINE__);                          \
         }                                                               \
-    } while (0)
-
+    } while(0)
 
-#endif // defined (LOG4CPLUS_SINGLE_THREADED)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_MACRO_FMT_BODY(logger, logLevel, ...)                 \
+    do {                                                                \
+        if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
+            log4cplus::_macros_oss_holder _log4cplus_buf;               \
+            log4cplus::helpers::format (_log4cplus_buf.buffer (),       \
+                __VA_ARGS__);                                           \
+            (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
+                _log4cplus_buf.str (), __FILE__, __LINE__);             \
+        }                                                               \
+    } while(0)
 
-#define LOG4CPLUS_MACRO_STR_BODY(logger, logEvent, logLevel)            \
+#define LOG4CPLUS_MACRO_DEFERRED_BODY(logger, logLevel, ...)            \
     do {                                                                \
         if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
+            log4cplus::helpers::DeferredMessage _log4cplus_msg (        \
+                __VA_ARGS__);                                           \
             (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
-                logEvent, __FILE__, __LINE__);                          \
+                _log4cplus_msg, __FILE__, __LINE__);                    \
         }                                                               \
     } while(0)
+#endif
 
 
 /**
@@ -106,85 +185,185 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, TRACE)
 #define LOG4CPLUS_TRACE_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, TRACE)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_TRACE_FMT(logger, ...)                        \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, TRACE, __VA_ARGS__)
+#define LOG4CPLUS_TRACE_DEFERRED(logger, ...)                   \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, TRACE, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_TRACE_METHOD(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_TRACE(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_TRACE_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_TRACE_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_TRACE_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 /**
  * @def LOG4CPLUS_DEBUG(logger, logEvent)  This macro is used to log a
  * DEBUG_LOG_LEVEL message to <code>logger</code>.  
  * <code>logEvent</code> will be streamed into an <code>ostream</code>.
+ *
+ * @def LOG4CPLUS_DEBUG_FMT(logger, fmt, ...)  This macro formats its
+ * arguments using log4cplus::helpers::format() and logs the result.
+ *
+ * @def LOG4CPLUS_DEBUG_DEFERRED(logger, fmt, ...)  Like
+ * LOG4CPLUS_DEBUG_FMT() but the arguments are only captured, see
+ * log4cplus::helpers::DeferredMessage, and formatted when an appender
+ * needs the message, e.g., on the AsyncAppender thread.
  */
 #if !defined(LOG4CPLUS_DISABLE_DEBUG)
 #define LOG4CPLUS_DEBUG(logger, logEvent)                               \
     LOG4CPLUS_MACRO_BODY (logger, logEvent, DEBUG)
 #define LOG4CPLUS_DEBUG_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, DEBUG)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_DEBUG_FMT(logger, ...)                        \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, DEBUG, __VA_ARGS__)
+#define LOG4CPLUS_DEBUG_DEFERRED(logger, ...)                   \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, DEBUG, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_DEBUG(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_DEBUG_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_DEBUG_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_DEBUG_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 /**
  * @def LOG4CPLUS_INFO(logger, logEvent)  This macro is used to log a
  * INFO_LOG_LEVEL message to <code>logger</code>.  
  * <code>logEvent</code> will be streamed into an <code>ostream</code>.
+ *
+ * @def LOG4CPLUS_INFO_FMT(logger, fmt, ...)  This macro formats its
+ * arguments using log4cplus::helpers::format() and logs the result.
+ *
+ * @def LOG4CPLUS_INFO_DEFERRED(logger, fmt, ...)  Like
+ * LOG4CPLUS_INFO_FMT() but the arguments are only captured, see
+ * log4cplus::helpers::DeferredMessage, and formatted when an appender
+ * needs the message, e.g., on the AsyncAppender thread.
  */
 #if !defined(LOG4CPLUS_DISABLE_INFO)
 #define LOG4CPLUS_INFO(logger, logEvent)                                \
     LOG4CPLUS_MACRO_BODY (logger, logEvent, INFO)
 #define LOG4CPLUS_INFO_STR(logger, logEvent)                            \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, INFO)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_INFO_FMT(logger, ...)                         \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, INFO, __VA_ARGS__)
+#define LOG4CPLUS_INFO_DEFERRED(logger, ...)                    \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, INFO, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_INFO(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_INFO_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_INFO_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_INFO_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 /**
  * @def LOG4CPLUS_WARN(logger, logEvent)  This macro is used to log a
  * WARN_LOG_LEVEL message to <code>logger</code>.  
  * <code>logEvent</code> will be streamed into an <code>ostream</code>.
+ *
+ * @def LOG4CPLUS_WARN_FMT(logger, fmt, ...)  This macro formats its
+ * arguments using log4cplus::helpers::format() and logs the result.
+ *
+ * @def LOG4CPLUS_WARN_DEFERRED(logger, fmt, ...)  Like
+ * LOG4CPLUS_WARN_FMT() but the arguments are only captured, see
+ * log4cplus::helpers::DeferredMessage, and formatted when an appender
+ * needs the message, e.g., on the AsyncAppender thread.
  */
 #if !defined(LOG4CPLUS_DISABLE_WARN)
 #define LOG4CPLUS_WARN(logger, logEvent)                                \
     LOG4CPLUS_MACRO_BODY (logger, logEvent, WARN)
 #define LOG4CPLUS_WARN_STR(logger, logEvent)                            \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, WARN)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_WARN_FMT(logger, ...)                         \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, WARN, __VA_ARGS__)
+#define LOG4CPLUS_WARN_DEFERRED(logger, ...)                    \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, WARN, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_WARN(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_WARN_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_WARN_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_WARN_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 /**
  * @def LOG4CPLUS_ERROR(logger, logEvent)  This macro is used to log a
  * ERROR_LOG_LEVEL message to <code>logger</code>.  
  * <code>logEvent</code> will be streamed into an <code>ostream</code>.
+ *
+ * @def LOG4CPLUS_ERROR_FMT(logger, fmt, ...)  This macro formats its
+ * arguments using log4cplus::helpers::format() and logs the result.
+ *
+ * @def LOG4CPLUS_ERROR_DEFERRED(logger, fmt, ...)  Like
+ * LOG4CPLUS_ERROR_FMT() but the arguments are only captured, see
+ * log4cplus::helpers::DeferredMessage, and formatted when an appender
+ * needs the message, e.g., on the AsyncAppender thread.
  */
 #if !defined(LOG4CPLUS_DISABLE_ERROR)
 #define LOG4CPLUS_ERROR(logger, logEvent)                               \
     LOG4CPLUS_MACRO_BODY (logger, logEvent, ERROR)
 #define LOG4CPLUS_ERROR_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, ERROR)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_ERROR_FMT(logger, ...)                        \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, ERROR, __VA_ARGS__)
+#define LOG4CPLUS_ERROR_DEFERRED(logger, ...)                   \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, ERROR, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_ERROR(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_ERROR_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_ERROR_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_ERROR_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 /**
  * @def LOG4CPLUS_FATAL(logger, logEvent)  This macro is used to log a
  * FATAL_LOG_LEVEL message to <code>logger</code>.  
  * <code>logEvent</code> will be streamed into an <code>ostream</code>.
+ *
+ * @def LOG4CPLUS_FATAL_FMT(logger, fmt, ...)  This macro formats its
+ * arguments using log4cplus::helpers::format() and logs the result.
+ *
+ * @def LOG4CPLUS_FATAL_DEFERRED(logger, fmt, ...)  Like
+ * LOG4CPLUS_FATAL_FMT() but the arguments are only captured, see
+ * log4cplus::helpers::DeferredMessage, and formatted when an appender
+ * needs the message, e.g., on the AsyncAppender thread.
  */
 #if !defined(LOG4CPLUS_DISABLE_FATAL)
 #define LOG4CPLUS_FATAL(logger, logEvent)                               \
     LOG4CPLUS_MACRO_BODY (logger, logEvent, FATAL)
 #define LOG4CPLUS_FATAL_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, FATAL)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_FATAL_FMT(logger, ...)                        \
+    LOG4CPLUS_MACRO_FMT_BODY (logger, FATAL, __VA_ARGS__)
+#define LOG4CPLUS_FATAL_DEFERRED(logger, ...)                   \
+    LOG4CPLUS_MACRO_DEFERRED_BODY (logger, FATAL, __VA_ARGS__)
+#endif
 #else
 #define LOG4CPLUS_FATAL(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_FATAL_STR(logger, logEvent) do { } while (0)
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+#define LOG4CPLUS_FATAL_FMT(logger, ...) do { } while (0)
+#define LOG4CPLUS_FATAL_DEFERRED(logger, ...) do { } while (0)
+#endif
 #endif
 
 #endif /* _LOG4CPLUS_LOGGING_MACROS_HEADER_ */
@@ -112,6 +112,10 @@ namespace log4cplus {
         log4cplus::tstring host;
         int port;
         log4cplus::tstring serverName;
+        //! Serialized event, reused by append().
+        log4cplus::helpers::SocketBuffer eventBuffer;
+        //! Size prefixed message, reused by append().
+        log4cplus::helpers::SocketBuffer msgBuffer;
 
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         class LOG4CPLUS_EXPORT ConnectorThread;
@@ -151,6 +155,13 @@ namespace log4cplus {
         SocketBuffer convertToBuffer(const log4cplus::spi::InternalLoggingEvent& event,
                                      const log4cplus::tstring& serverName);
 
+        //! Serializes the event into the given buffer. The buffer is
+        //! appended to, it is not cleared first.
+        LOG4CPLUS_EXPORT
+        void convertToBuffer(SocketBuffer& buffer,
+                             const log4cplus::spi::InternalLoggingEvent& event,
+                             const log4cplus::tstring& serverName);
+
         LOG4CPLUS_EXPORT
         log4cplus::spi::InternalLoggingEvent readFromBuffer(SocketBuffer& buffer);
     } // end namespace helpers
@@ -0,0 +1,123 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_SPI_EVENTPOOL_H
+#define LOG4CPLUS_SPI_EVENTPOOL_H
+
+#include <log4cplus/config.hxx>
+
+
+namespace log4cplus { namespace spi {
+
+
+class InternalLoggingEvent;
+
+
+/**
+ * Per-thread pools of recycled InternalLoggingEvent instances. A
+ * recycled event keeps the capacity of its strings, so in the steady
+ * state creating an event neither allocates the event object nor its
+ * message buffer.
+ *
+ * Events may be released by a different thread than the one that
+ * acquired them; they then end up in the pool of the releasing
+ * thread.
+ */
+class LOG4CPLUS_EXPORT EventPool
+{
+public:
+    /** Allocation statistics of the pools of all threads. */
+    struct Stats
+    {
+        /** Events allocated because the thread's pool was empty. */
+        unsigned long allocated;
+        /** Events deleted because the thread's pool was full, the
+         *  thread has exited or the event is not a plain
+         *  InternalLoggingEvent. */
+        unsigned long freed;
+        /** Times the message buffer of a recycled event had to grow. */
+        unsigned long bufferGrowths;
+    };
+
+    /** Returns an event from the calling thread's pool, or a newly
+     *  allocated one when the pool is empty. Its contents are
+     *  unspecified; it is to be set by
+     *  InternalLoggingEvent::setLoggingEvent() or by assignment. */
+    static InternalLoggingEvent * acquire ();
+
+    /** Returns a copy of <code>ev</code>. Copies of plain
+     *  InternalLoggingEvent instances are taken from the pool, other
+     *  events are cloned. The copy is to be given back to release(). */
+    static InternalLoggingEvent * copy (InternalLoggingEvent const & ev);
+
+    /** Returns the event into the calling thread's pool. Instances of
+     *  classes derived from InternalLoggingEvent are deleted. NULL is
+     *  ignored. */
+    static void release (InternalLoggingEvent * ev);
+
+    /** Returns the statistics collected since the start of the
+     *  program or since the last resetStats(). */
+    static Stats getStats ();
+
+    /** Resets all counters to zero. */
+    static void resetStats ();
+
+private:
+    static void noteBufferGrowth ();
+
+    friend class InternalLoggingEvent;
+};
+
+
+/**
+ * Holds an event acquired from EventPool for the duration of a scope.
+ */
+class PooledEvent
+{
+public:
+    PooledEvent ()
+        : ev (EventPool::acquire ())
+    { }
+
+    ~PooledEvent ()
+    {
+        EventPool::release (ev);
+    }
+
+    InternalLoggingEvent & operator * () const { return *ev; }
+    InternalLoggingEvent * operator -> () const { return ev; }
+
+private:
+    InternalLoggingEvent * const ev;
+
+    PooledEvent (PooledEvent const &);
+    PooledEvent & operator = (PooledEvent const &);
+};
+
+
+} } // namespace log4cplus { namespace spi {
+
+
+#endif // LOG4CPLUS_SPI_EVENTPOOL_H
@@ -81,6 +81,20 @@ namespace log4cplus {
              */
             virtual bool isEnabledFor(LogLevel ll) const;
 
+            /**
+             * Same as isEnabledFor() but answers from the cached effective
+             * LogLevel of this logger as long as the hierarchy has not
+             * changed since the cache was filled. This costs one load of
+             * the hierarchy generation counter and two comparisons.
+             */
+            bool isEnabledForCached(LogLevel ll_) const
+            {
+                if(cacheGeneration == *hierarchyGeneration) {
+                    return ll_ >= cachedLogLevel;
+                }
+                return isEnabledFor(ll_);
+            }
+
             /**
              * This generic form is intended to be used by wrappers. 
              */
@@ -107,7 +121,7 @@ namespace log4cplus {
             /**
              * Set the LogLevel of this Logger.
              */
-            void setLogLevel(LogLevel _ll) { this->ll = _ll; }
+            void setLogLevel(LogLevel _ll);
 
             /**
              * Return the the {@link Hierarchy} where this <code>Logger</code>
@@ -118,7 +132,7 @@ namespace log4cplus {
             /**
              * Return the logger name.  
              */
-            log4cplus::tstring getName() const { return name; }
+            const log4cplus::tstring& getName() const { return name; }
 
             /**
              * Get the additivity flag for this Logger instance.
@@ -189,6 +203,34 @@ namespace log4cplus {
             /** Loggers need to know what Hierarchy they are in. */
             Hierarchy& hierarchy;
 
+            /**
+             * Generation counter of the hierarchy. It is incremented every
+             * time a change in the hierarchy can change the effective
+             * LogLevel of any of its loggers.
+             */
+            unsigned const volatile * hierarchyGeneration;
+
+            /**
+             * Value of the hierarchy generation counter at the time
+             * <code>cachedLogLevel</code> was computed.
+             */
+            mutable unsigned volatile cacheGeneration;
+
+            /**
+             * The lowest LogLevel this logger is enabled for. It combines
+             * the chained LogLevel and the hierarchy's disable value.
+             */
+            mutable LogLevel volatile cachedLogLevel;
+
+            /**
+             * Non-zero while a thread is storing a new
+             * <code>cachedLogLevel</code>. Only one thread at a time may
+             * refill the cache, so that a level computed before a change
+             * of the hierarchy cannot be stored after the level computed
+             * after it.
+             */
+            mutable int volatile cacheWriter;
+
           // Disallow copying of instances of this class
             LoggerImpl(const LoggerImpl&);
             LoggerImpl& operator=(const LoggerImpl&);
@@ -27,11 +27,14 @@
 #include <log4cplus/loglevel.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/tstring.h>
+#include <log4cplus/helpers/format.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/threads.h>
 
 namespace log4cplus {
     namespace spi {
+        class EventPool;
+
         /**
          * The internal representation of logging events. When an affirmative
          * decision is made to log then a <code>InternalLoggingEvent</code> 
@@ -45,6 +48,10 @@ namespace log4cplus {
           // Ctors
              /**
               * Instantiate a LoggingEvent from the supplied parameters.
+              *
+              * The event keeps copies of <code>logger</code> and
+              * <code>filename</code>. Only events filled by
+              * setLoggingEvent() refer to them.
               * 
               * @param logger   The logger of this event.
               * @param ll_      The LogLevel of this event.
@@ -60,17 +67,52 @@ namespace log4cplus {
                                   const char* filename,
                                   int line_)
               : message(message_),
-                loggerName(logger),
+                loggerName(&ownedLoggerName),
+                ownedLoggerName(logger),
                 ll(ll_),
-                ndc(),
-                thread(),
                 timestamp(log4cplus::helpers::Time::gettimeofday()),
+                fileName(0),
                 file( (  filename
                        ? LOG4CPLUS_C_STR_TO_TSTRING(filename) 
                        : log4cplus::tstring()) ),
                 line(line_),
                 threadCached(false),
-                ndcCached(false)
+                ndcCached(false),
+                fileCached(true),
+                deferred(0),
+                deferredOwned(false)
+             {
+             }
+
+             /**
+              * Instantiate a LoggingEvent with a message that is formatted
+              * only when getMessage() is first called. Copies of the
+              * event, e.g. those queued by AsyncAppender, carry a copy
+              * of the captured arguments instead of the formatted text.
+              *
+              * @param message_ Captured message arguments. Unless the
+              *                 event is copied, it refers to them and
+              *                 they must outlive it.
+              */
+             InternalLoggingEvent(const log4cplus::tstring& logger,
+                                  LogLevel ll_,
+                                  const log4cplus::helpers::DeferredMessage& message_,
+                                  const char* filename,
+                                  int line_)
+              : loggerName(&ownedLoggerName),
+                ownedLoggerName(logger),
+                ll(ll_),
+                timestamp(log4cplus::helpers::Time::gettimeofday()),
+                fileName(0),
+                file( (  filename
+                       ? LOG4CPLUS_C_STR_TO_TSTRING(filename) 
+                       : log4cplus::tstring()) ),
+                line(line_),
+                threadCached(false),
+                ndcCached(false),
+                fileCached(true),
+                deferred(&message_),
+                deferredOwned(false)
              {
              }
 
@@ -83,29 +125,42 @@ namespace log4cplus {
                                   const log4cplus::tstring& file_,
                                   int line_)
               : message(message_),
-                loggerName(logger),
+                loggerName(&ownedLoggerName),
+                ownedLoggerName(logger),
                 ll(ll_),
                 ndc(ndc_),
                 thread(thread_),
                 timestamp(time),
+                fileName(0),
                 file(file_),
                 line(line_),
                 threadCached(true),
-                ndcCached(true)
+                ndcCached(true),
+                fileCached(true),
+                deferred(0),
+                deferredOwned(false)
              {
              }
 
              InternalLoggingEvent(const log4cplus::spi::InternalLoggingEvent& rhs)
-              : message(rhs.getMessage()),
-                loggerName(rhs.getLoggerName()),
+              : message(rhs.deferred ? log4cplus::tstring()
+                                     : rhs.getMessage()),
+                loggerName(&ownedLoggerName),
+                ownedLoggerName(rhs.getLoggerName()),
                 ll(rhs.getLogLevel()),
                 ndc(rhs.getNDC()),
                 thread(rhs.getThread()),
                 timestamp(rhs.getTimestamp()),
+                fileName(0),
                 file(rhs.getFile()),
                 line(rhs.getLine()),
                 threadCached(true),
-                ndcCached(true)
+                ndcCached(true),
+                fileCached(true),
+                deferred(rhs.deferred
+                         ? new log4cplus::helpers::DeferredMessage(*rhs.deferred)
+                         : 0),
+                deferredOwned(true)
              {
              }
 
@@ -133,7 +188,7 @@ namespace log4cplus {
             /** The logger of the logging event. It is set by 
              *  the LoggingEvent constructor. 
 	     */
-            const log4cplus::tstring& getLoggerName() const { return loggerName; }
+            const log4cplus::tstring& getLoggerName() const { return *loggerName; }
 
             /** LogLevel of logging event. */
             LogLevel getLogLevel() const { return ll; }
@@ -161,11 +216,48 @@ namespace log4cplus {
             const log4cplus::helpers::Time& getTimestamp() const { return timestamp; }
 
             /** The is the file where this log statement was written */
-            const log4cplus::tstring& getFile() const { return file; }
+            const log4cplus::tstring& getFile() const {
+                if(!fileCached) {
+                    if(fileName)
+                        file = LOG4CPLUS_C_STR_TO_TSTRING(fileName);
+                    fileCached = true;
+                }
+                return file;
+            }
 
             /** The is the line where this log statement was written */
             int getLine() const { return line; }
  
+            /**
+             * Sets all fields of the event as the constructor with the
+             * same parameters would, reusing the memory the event
+             * already holds. This is meant for events obtained from
+             * EventPool.
+             *
+             * Unlike the constructor the event refers to
+             * <code>logger</code> and <code>filename</code> instead of
+             * copying them, so it may be used only while they exist,
+             * e.g. within Logger::forcedLog(). Copies of the event,
+             * such as those queued by AsyncAppender, own both names.
+             */
+            void setLoggingEvent(const log4cplus::tstring& logger,
+                                 LogLevel ll_,
+                                 const log4cplus::tstring& message_,
+                                 const char* filename,
+                                 int line_);
+
+            /**
+             * Sets all fields of the event as the constructor with the
+             * same parameters would, reusing the memory the event
+             * already holds. Like the other overload, it refers to
+             * <code>logger</code> and <code>filename</code>.
+             */
+            void setLoggingEvent(const log4cplus::tstring& logger,
+                                 LogLevel ll_,
+                                 const log4cplus::helpers::DeferredMessage& message_,
+                                 const char* filename,
+                                 int line_);
+
           // public operators
             log4cplus::spi::InternalLoggingEvent&
             operator=(const log4cplus::spi::InternalLoggingEvent& rhs);
@@ -175,20 +267,40 @@ namespace log4cplus {
 
         protected:
           // Data
-            log4cplus::tstring message;
+            mutable log4cplus::tstring message;
 
         private:
-            log4cplus::tstring loggerName;
+            void setEventData(const log4cplus::tstring& logger, LogLevel ll_,
+                              const char* filename, int line_);
+            void releaseDeferred() const;
+            /** Clears the event before it is put into EventPool. */
+            void recycle();
+
+            friend class EventPool;
+
+            /** Points either to the logger's name or to ownedLoggerName. */
+            const log4cplus::tstring* loggerName;
+            log4cplus::tstring ownedLoggerName;
             LogLevel ll;
             mutable log4cplus::tstring ndc;
             mutable log4cplus::tstring thread;
             log4cplus::helpers::Time timestamp;
-            log4cplus::tstring file;
+            /** File name the event has been filled with by
+             *  setLoggingEvent(), or NULL. */
+            const char* fileName;
+            mutable log4cplus::tstring file;
             int line;
             /** Indicates whether or not the Threadname has been retrieved. */
             mutable bool threadCached;
             /** Indicates whether or not the NDC has been retrieved. */
             mutable bool ndcCached;
+            /** Indicates whether or not the file has been converted. */
+            mutable bool fileCached;
+            /** Message arguments not formatted yet, or NULL. */
+            mutable const log4cplus::helpers::DeferredMessage* deferred;
+            /** Indicates whether the deferred arguments are owned by
+             *  this event. */
+            mutable bool deferredOwned;
         };
 
     } // end namespace spi
@@ -208,6 +208,23 @@ Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
 
 
 
+const log4cplus::tstring&
+Appender::formatEvent(const log4cplus::spi::InternalLoggingEvent& event)
+{
+    // Do not keep the memory of an occasional huge event.
+    if(formatted.capacity() > 64 * 1024) {
+        log4cplus::tstring().swap(formatted);
+    }
+    else {
+        formatted.clear();
+    }
+
+    layout->formatAndAppend(formatted, event);
+    return formatted;
+}
+
+
+
 log4cplus::tstring
 Appender::getName()
 {
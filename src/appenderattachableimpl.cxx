@@ -46,18 +46,40 @@ namespace helpers
 {
 
 
+//////////////////////////////////////////////////////////////////////////////
+// log4cplus::helpers::AppenderAttachableImpl::ListSnapshot
+//////////////////////////////////////////////////////////////////////////////
+
+struct AppenderAttachableImpl::ListSnapshot
+{
+    explicit ListSnapshot(ListType const & l)
+        : list(l)
+        , refs(1)
+    { }
+
+    ListType const list;
+    int volatile refs;
+};
+
+
+
 //////////////////////////////////////////////////////////////////////////////
 // log4cplus::helpers::AppenderAttachableImpl ctor and dtor
 //////////////////////////////////////////////////////////////////////////////
 
 AppenderAttachableImpl::AppenderAttachableImpl()
- : appender_list_mutex(LOG4CPLUS_MUTEX_CREATE)
+ : appender_list_mutex(LOG4CPLUS_MUTEX_CREATE),
+   appenderList(new ListSnapshot(ListType())),
+   readerEpoch(0)
 {
+    readers[0] = 0;
+    readers[1] = 0;
 }
 
 
 AppenderAttachableImpl::~AppenderAttachableImpl()
 {
+   releaseSnapshot(appenderList);
    LOG4CPLUS_MUTEX_FREE( appender_list_mutex );
 }
 
@@ -70,16 +92,19 @@ AppenderAttachableImpl::~AppenderAttachableImpl()
 void
 AppenderAttachableImpl::addAppender(SharedAppenderPtr newAppender)
 {
-    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        if(newAppender == NULL) {
-            getLogLog().warn( LOG4CPLUS_TEXT("Tried to add NULL appender") );
-            return;
-        }
+    if(newAppender == NULL) {
+        getLogLog().warn( LOG4CPLUS_TEXT("Tried to add NULL appender") );
+        return;
+    }
 
-        ListType::iterator it = 
-            std::find(appenderList.begin(), appenderList.end(), newAppender);
-        if(it == appenderList.end()) {
-            appenderList.push_back(newAppender);
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
+        ListType const & current = appenderList->list;
+        ListType::const_iterator it = 
+            std::find(current.begin(), current.end(), newAppender);
+        if(it == current.end()) {
+            ListType list (current);
+            list.push_back(newAppender);
+            replaceSnapshot(list);
         }
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
@@ -89,9 +114,10 @@ AppenderAttachableImpl::addAppender(SharedAppenderPtr newAppender)
 AppenderAttachableImpl::ListType
 AppenderAttachableImpl::getAllAppenders()
 {
-    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        return appenderList;
-    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+    ListSnapshot * snapshot = acquireSnapshot();
+    ListType ret (snapshot->list);
+    releaseSnapshot(snapshot);
+    return ret;
 }
 
 
@@ -99,18 +125,20 @@ AppenderAttachableImpl::getAllAppenders()
 SharedAppenderPtr 
 AppenderAttachableImpl::getAppender(const log4cplus::tstring& name)
 {
-    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        for(ListType::iterator it=appenderList.begin(); 
-            it!=appenderList.end(); 
-            ++it)
-        {
-            if((*it)->getName() == name) {
-                return *it;
-            }
+    SharedAppenderPtr ret;
+    ListSnapshot * snapshot = acquireSnapshot();
+    for(ListType::const_iterator it=snapshot->list.begin(); 
+        it!=snapshot->list.end(); 
+        ++it)
+    {
+        if((*it)->getName() == name) {
+            ret = *it;
+            break;
         }
+    }
+    releaseSnapshot(snapshot);
 
-        return SharedAppenderPtr(NULL);
-    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+    return ret;
 }
 
 
@@ -119,7 +147,9 @@ void
 AppenderAttachableImpl::removeAllAppenders()
 {
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        appenderList.erase(appenderList.begin(), appenderList.end());
+        if(!appenderList->list.empty()) {
+            replaceSnapshot(ListType());
+        }
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
 
@@ -134,10 +164,13 @@ AppenderAttachableImpl::removeAppender(SharedAppenderPtr appender)
     }
 
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        ListType::iterator it =
-            std::find(appenderList.begin(), appenderList.end(), appender);
-        if(it != appenderList.end()) {
-            appenderList.erase(it);
+        ListType const & current = appenderList->list;
+        ListType::const_iterator it =
+            std::find(current.begin(), current.end(), appender);
+        if(it != current.end()) {
+            ListType list (current);
+            list.erase(list.begin() + (it - current.begin()));
+            replaceSnapshot(list);
         }
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
@@ -157,20 +190,105 @@ AppenderAttachableImpl::appendLoopOnAppenders(const spi::InternalLoggingEvent& e
 {
     int count = 0;
 
-    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
-        for(ListType::const_iterator it=appenderList.begin();
-            it!=appenderList.end();
+    ListSnapshot * snapshot = acquireSnapshot();
+    try {
+        for(ListType::const_iterator it=snapshot->list.begin();
+            it!=snapshot->list.end();
             ++it)
         {
             ++count;
             (*it)->doAppend(event);
         }
-    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+    }
+    catch(...) {
+        releaseSnapshot(snapshot);
+        throw;
+    }
+    releaseSnapshot(snapshot);
 
     return count;
 }
 
 
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::helpers::AppenderAttachableImpl protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+AppenderAttachableImpl::ListSnapshot *
+AppenderAttachableImpl::acquireSnapshot() const
+{
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    // Announce ourselves in the readers counter of the current epoch. If
+    // the epoch has changed meanwhile, the writer might have missed our
+    // announcement, so retry with the new epoch.
+    for(;;) {
+        unsigned const epoch = readerEpoch;
+        int volatile & slot = readers[epoch & 1];
+        LOG4CPLUS_ATOMIC_INCREMENT(slot);
+        if(readerEpoch == epoch) {
+            ListSnapshot * snapshot = appenderList;
+            LOG4CPLUS_ATOMIC_INCREMENT(snapshot->refs);
+            LOG4CPLUS_ATOMIC_DECREMENT(slot);
+            return snapshot;
+        }
+        LOG4CPLUS_ATOMIC_DECREMENT(slot);
+    }
+
+#else
+    ListSnapshot * snapshot;
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
+        snapshot = appenderList;
+        ++snapshot->refs;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+    return snapshot;
+
+#endif
+}
+
+
+void
+AppenderAttachableImpl::releaseSnapshot(ListSnapshot * snapshot) const
+{
+    bool destroy;
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    destroy = LOG4CPLUS_ATOMIC_DECREMENT(snapshot->refs) == 0;
+
+#else
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
+        destroy = --snapshot->refs == 0;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+
+#endif
+    if(destroy) {
+        delete snapshot;
+    }
+}
+
+
+void
+AppenderAttachableImpl::replaceSnapshot(ListType const & list)
+{
+    ListSnapshot * const old = appenderList;
+    appenderList = new ListSnapshot(list);
+
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    // Start a new epoch and wait until all readers of the previous one have
+    // taken their references. They only load the pointer and increment
+    // the reference count, so this does not wait for any appender.
+    LOG4CPLUS_MEMORY_BARRIER();
+    unsigned const epoch = readerEpoch;
+    readerEpoch = epoch + 1;
+    LOG4CPLUS_MEMORY_BARRIER();
+    while(readers[epoch & 1] != 0) {
+        thread::yield();
+    }
+
+#endif
+    releaseSnapshot(old);
+}
+
+
 } // namespace helpers
 
 
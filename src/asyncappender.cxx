@@ -0,0 +1,311 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/factory.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <cstdlib>
+#include <memory>
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+
+class QueueThread
+    : public thread::AbstractThread
+{
+public:
+    QueueThread (AsyncAppender * app, thread::QueuePtr const & q,
+        unsigned long report_interval)
+        : appender (app)
+        , queue (q)
+        , dropReportInterval (report_interval)
+        , totalDropped (0)
+    { }
+
+    virtual void run ();
+
+private:
+    void reportDropped ();
+
+    AsyncAppender * const appender;
+    thread::QueuePtr queue;
+    unsigned long const dropReportInterval;
+    unsigned long totalDropped;
+};
+
+
+void
+QueueThread::run ()
+{
+    thread::Queue::queue_storage_type events;
+    helpers::Time lastReport (helpers::Time::gettimeofday ());
+    helpers::Time const reportPeriod (dropReportInterval / 1000,
+        (dropReportInterval % 1000) * 1000);
+
+    for (;;)
+    {
+        unsigned ret_flags = queue->get_events (&events, dropReportInterval);
+
+        for (thread::Queue::queue_storage_type::iterator it = events.begin ();
+            it != events.end (); ++it)
+            appender->appendLoopOnAppenders (**it);
+        queue->recycle_events (&events);
+
+        if (dropReportInterval != 0)
+        {
+            helpers::Time const now (helpers::Time::gettimeofday ());
+            if (now - lastReport >= reportPeriod)
+            {
+                reportDropped ();
+                lastReport = now;
+            }
+        }
+
+        // Exit only after the queue has been drained.
+        if ((ret_flags & thread::Queue::EXIT)
+            && ! (ret_flags & thread::Queue::EVENT))
+            break;
+    }
+
+    reportDropped ();
+    if (totalDropped != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("AsyncAppender [") << appender->getName ()
+            << LOG4CPLUS_TEXT ("]: ") << totalDropped
+            << LOG4CPLUS_TEXT (" events dropped in total.");
+        helpers::LogLog::getLogLog ()->warn (oss.str ());
+    }
+}
+
+
+void
+QueueThread::reportDropped ()
+{
+    unsigned long const dropped = queue->reset_dropped_count ();
+    if (dropped == 0)
+        return;
+
+    totalDropped += dropped;
+
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT ("AsyncAppender [") << appender->getName ()
+        << LOG4CPLUS_TEXT ("]: ") << dropped
+        << LOG4CPLUS_TEXT (" events dropped because of full queue.");
+    helpers::LogLog::getLogLog ()->warn (oss.str ());
+}
+
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::AsyncAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+AsyncAppender::AsyncAppender (SharedAppenderPtr const & app,
+    unsigned queueLimit, thread::Queue::OverflowPolicy policy,
+    LogLevel overflowThreshold)
+    : dropReportInterval (10000)
+{
+    addAppender (app);
+    init (queueLimit, policy, overflowThreshold);
+}
+
+
+AsyncAppender::AsyncAppender (helpers::Properties const & properties)
+    : Appender (properties)
+    , dropReportInterval (10000)
+{
+    helpers::LogLog & loglog = *helpers::LogLog::getLogLog ();
+
+    // Create the attached appenders.
+    spi::AppenderFactoryRegistry & reg = spi::getAppenderFactoryRegistry ();
+    helpers::Properties appendersProps
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("appenders."));
+    int appenderCount = 0;
+    tstring appenderName;
+    while (appendersProps.exists (
+        appenderName = helpers::convertIntegerToString (++appenderCount)))
+    {
+        tstring const factoryName = appendersProps.getProperty (appenderName);
+        spi::AppenderFactory * factory = reg.get (factoryName);
+        if (! factory)
+        {
+            loglog.error (
+                LOG4CPLUS_TEXT ("AsyncAppender::ctor()- Cannot find AppenderFactory: ")
+                + factoryName);
+            continue;
+        }
+
+        helpers::Properties appenderProps = appendersProps.getPropertySubset (
+            appenderName + LOG4CPLUS_TEXT ("."));
+        SharedAppenderPtr app (factory->createObject (appenderProps));
+        if (! app)
+        {
+            loglog.error (
+                LOG4CPLUS_TEXT ("AsyncAppender::ctor()- Failed to create appender: ")
+                + factoryName);
+            continue;
+        }
+        addAppender (app);
+    }
+
+    unsigned queueLimit = 100;
+    if (properties.exists (LOG4CPLUS_TEXT ("QueueLimit")))
+    {
+        tstring tmp = properties.getProperty (LOG4CPLUS_TEXT ("QueueLimit"));
+        queueLimit = std::atoi (LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str ());
+    }
+
+    thread::Queue::OverflowPolicy policy = thread::Queue::BLOCK;
+    if (properties.exists (LOG4CPLUS_TEXT ("OverflowPolicy")))
+    {
+        tstring tmp = helpers::toUpper (
+            properties.getProperty (LOG4CPLUS_TEXT ("OverflowPolicy")));
+        if (tmp == LOG4CPLUS_TEXT ("BLOCK"))
+            policy = thread::Queue::BLOCK;
+        else if (tmp == LOG4CPLUS_TEXT ("DROP_NEWEST"))
+            policy = thread::Queue::DROP_NEWEST;
+        else if (tmp == LOG4CPLUS_TEXT ("DROP_OLDEST"))
+            policy = thread::Queue::DROP_OLDEST;
+        else if (tmp == LOG4CPLUS_TEXT ("DROP_BELOW_THRESHOLD"))
+            policy = thread::Queue::DROP_BELOW_THRESHOLD;
+        else
+            loglog.warn (
+                LOG4CPLUS_TEXT ("AsyncAppender::ctor()- \"OverflowPolicy\" not valid: ")
+                + tmp);
+    }
+
+    LogLevel overflowThreshold = WARN_LOG_LEVEL;
+    if (properties.exists (LOG4CPLUS_TEXT ("OverflowThreshold")))
+    {
+        tstring tmp = helpers::toUpper (
+            properties.getProperty (LOG4CPLUS_TEXT ("OverflowThreshold")));
+        overflowThreshold = getLogLevelManager ().fromString (tmp);
+    }
+
+    if (properties.exists (LOG4CPLUS_TEXT ("DropReportInterval")))
+    {
+        tstring tmp
+            = properties.getProperty (LOG4CPLUS_TEXT ("DropReportInterval"));
+        dropReportInterval = std::strtoul (
+            LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str (), 0, 10);
+    }
+
+    init (queueLimit, policy, overflowThreshold);
+}
+
+
+void
+AsyncAppender::init (unsigned queueLimit,
+    thread::Queue::OverflowPolicy policy, LogLevel overflowThreshold)
+{
+    queue = thread::QueuePtr (
+        new thread::Queue (queueLimit, policy, overflowThreshold));
+    queue_thread = thread::AbstractThreadPtr (
+        new QueueThread (this, queue, dropReportInterval));
+    queue_thread->start ();
+    helpers::LogLog::getLogLog ()->debug (
+        LOG4CPLUS_TEXT ("Queue thread of AsyncAppender started."));
+}
+
+
+AsyncAppender::~AsyncAppender ()
+{
+    destructorImpl ();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::AsyncAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::close ()
+{
+    // Let the writer thread deliver what is queued and wake up producers
+    // blocked on a full queue before taking the appender's mutex.
+    if (queue)
+        queue->signal_exit (true);
+
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+        if (queue_thread)
+        {
+            queue_thread->join ();
+            queue_thread = 0;
+        }
+
+        removeAllAppenders ();
+        closed = true;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+}
+
+
+// The queue is synchronized on its own, access_mutex is left to
+// close(). After close() the queue refuses new events.
+void
+AsyncAppender::doAppend (spi::InternalLoggingEvent const & event)
+{
+    if (! isAsSevereAsThreshold (event.getLogLevel ()))
+        return;
+
+    if (checkFilter (filter.get (), event) == spi::DENY)
+        return;
+
+    append (event);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::AsyncAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::append (spi::InternalLoggingEvent const & event)
+{
+    if (queue->put_event (event) & thread::Queue::EXIT)
+        helpers::LogLog::getLogLog ()->error (
+            LOG4CPLUS_TEXT ("Attempted to append to closed appender named [")
+            + name + LOG4CPLUS_TEXT ("]."));
+}
+
+
+} // namespace log4cplus
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
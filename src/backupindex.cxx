@@ -0,0 +1,489 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/backupindex.h>
+#include <log4cplus/helpers/gzip.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <algorithm>
+
+#if defined (LOG4CPLUS_HAVE_SYS_TYPES_H)
+#include <sys/types.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <dirent.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+
+static
+bool
+is_digit (tchar ch)
+{
+    return ch >= LOG4CPLUS_TEXT ('0') && ch <= LOG4CPLUS_TEXT ('9');
+}
+
+
+//! Parses run of decimal digits at the given position.
+//! @returns Number of digits parsed.
+static
+std::size_t
+parse_digits (tstring const & str, std::size_t pos, file_size_type & value)
+{
+    std::size_t const start = pos;
+    for (; pos != str.size () && is_digit (str[pos]); ++pos)
+        value = value * 10 + (str[pos] - LOG4CPLUS_TEXT ('0'));
+    return pos - start;
+}
+
+
+//! Splits file name into directory and the last component.
+static
+void
+split_path (tstring const & path, tstring & dir, tstring & base)
+{
+#if defined (_WIN32)
+    tchar const * const separators = LOG4CPLUS_TEXT ("/\\");
+#else
+    tchar const * const separators = LOG4CPLUS_TEXT ("/");
+#endif
+
+    tstring::size_type const pos = path.find_last_of (separators);
+    if (pos == tstring::npos)
+    {
+        dir = LOG4CPLUS_TEXT (".");
+        base = path;
+    }
+    else
+    {
+        dir.assign (path, 0, pos + 1);
+        base.assign (path, pos + 1, tstring::npos);
+    }
+}
+
+
+//! Suffix of files being compressed.
+static
+tstring
+partial_suffix ()
+{
+    return tstring (GzipCompressor::getFileSuffix ()) + LOG4CPLUS_TEXT (".tmp");
+}
+
+
+static
+bool
+ends_with (tstring const & str, tstring const & suffix)
+{
+    return str.size () >= suffix.size ()
+        && str.compare (str.size () - suffix.size (), suffix.size (),
+            suffix) == 0;
+}
+
+
+} // namespace
+
+
+bool
+BackupIndex::Entry::operator < (Entry const & other) const
+{
+    if (key != other.key)
+        return key < other.key;
+    else
+        return name < other.name;
+}
+
+
+bool
+BackupIndex::Entry::nameLess (Entry const & a, Entry const & b)
+{
+    return a.name < b.name;
+}
+
+
+BackupIndex::BackupIndex (tstring const & filename_, Naming naming_)
+    : filename (filename_)
+    , naming (naming_)
+    , scanned (false)
+    , lastSequence (0)
+    , totalSize (0)
+{ }
+
+
+BackupIndex::~BackupIndex ()
+{ }
+
+
+tstring
+BackupIndex::nextName (Time const & now)
+{
+    if (! scanned)
+        scan ();
+
+    tstring name (filename);
+    name += LOG4CPLUS_TEXT ('.');
+    if (naming == TIMESTAMP)
+    {
+        // Two rollovers within the same millisecond get distinct names.
+        Time t (now);
+        if (t <= lastTime)
+            t = lastTime + Time (0, 1000);
+        lastTime = t;
+        name += t.getFormattedTime (LOG4CPLUS_TEXT ("%Y%m%d-%H%M%S.%q"),
+            false);
+    }
+    else
+        name += convertIntegerToString (++lastSequence);
+
+    return name;
+}
+
+
+tstring
+BackupIndex::uniqueName (tstring const & name)
+{
+    if (! scanned)
+        scan ();
+
+    // Continue after the highest number of the period, so that names
+    // of deleted backups are not reused and the numbers keep growing.
+    tstring const prefix (name + LOG4CPLUS_TEXT ('.'));
+    bool taken = false;
+    file_size_type highest = 0;
+    for (std::deque<Entry>::const_iterator it = entries.begin ();
+        it != entries.end (); ++it)
+    {
+        file_size_type number = 0;
+        if (it->name == name)
+            taken = true;
+        else if (it->name.compare (0, prefix.size (), prefix) == 0
+            && it->name.size () - prefix.size () <= 9
+            && parse_digits (it->name, prefix.size (), number)
+                == it->name.size () - prefix.size ())
+        {
+            taken = true;
+            highest = (std::max) (highest, number);
+        }
+    }
+
+    if (! taken)
+        return name;
+
+    return prefix + convertIntegerToString (highest + 1);
+}
+
+
+void
+BackupIndex::add (tstring const & name, Time const & time,
+    file_size_type bytes)
+{
+    if (! scanned)
+        scan ();
+
+    Entry entry;
+    entry.key = naming == PERIOD ? time.sec () : 0;
+    entry.bytes = bytes;
+    entry.name = name;
+    entry.forms = PLAIN;
+    entries.push_back (entry);
+    totalSize += bytes;
+}
+
+
+bool
+BackupIndex::popOldest (tstring & name)
+{
+    if (! scanned)
+        scan ();
+
+    if (entries.empty ())
+        return false;
+
+    name = entries.front ().name;
+    totalSize -= entries.front ().bytes;
+    entries.pop_front ();
+    return true;
+}
+
+
+std::size_t
+BackupIndex::size ()
+{
+    if (! scanned)
+        scan ();
+
+    return entries.size ();
+}
+
+
+file_size_type
+BackupIndex::getTotalSize ()
+{
+    if (! scanned)
+        scan ();
+
+    return totalSize;
+}
+
+
+Time
+BackupIndex::getOldestTime ()
+{
+    if (! scanned)
+        scan ();
+
+    if (entries.empty () || naming != PERIOD)
+        return Time ();
+    else
+        return Time (static_cast<time_t>(entries.front ().key));
+}
+
+
+void
+BackupIndex::invalidate ()
+{
+    entries.clear ();
+    orphans.clear ();
+    totalSize = 0;
+    scanned = false;
+}
+
+
+void
+BackupIndex::findUncompressed (std::vector<tstring> & uncompressed,
+    std::vector<tstring> & stale)
+{
+    if (! scanned)
+        scan ();
+
+    tstring const partial (partial_suffix ());
+    for (std::deque<Entry>::const_iterator it = entries.begin ();
+        it != entries.end (); ++it)
+    {
+        if (it->forms & PARTIAL)
+            stale.push_back (it->name + partial);
+
+        // The compressed file is renamed into place only when it is
+        // complete; the original may have been left behind.
+        if ((it->forms & PLAIN) && (it->forms & COMPRESSED))
+            stale.push_back (it->name);
+        else if (it->forms & PLAIN)
+            uncompressed.push_back (it->name);
+    }
+
+    for (std::vector<tstring>::const_iterator it = orphans.begin ();
+        it != orphans.end (); ++it)
+        stale.push_back (*it + partial);
+}
+
+
+void
+BackupIndex::scan ()
+{
+    entries.clear ();
+    orphans.clear ();
+    totalSize = 0;
+    scanned = true;
+
+    tstring dir;
+    tstring base;
+    split_path (filename, dir, base);
+    base += LOG4CPLUS_TEXT ('.');
+
+    Entry entry;
+
+#if defined (_WIN32)
+    tstring const pattern (dir + base + LOG4CPLUS_TEXT ('*'));
+    WIN32_FIND_DATA data;
+    HANDLE const handle = FindFirstFile (pattern.c_str (), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        tstring const name (data.cFileName);
+        if (name.compare (0, base.size (), base) != 0
+            || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            continue;
+
+        tstring suffix (name, base.size ());
+        entry.forms = stripForm (suffix);
+        entry.key = 0;
+        entry.bytes = 0;
+        if (! parseSuffix (suffix, entry.key))
+            continue;
+
+        if (naming == PERIOD)
+        {
+            // Seconds since the Epoch; the file time counts 100
+            // nanoseconds intervals since 1601.
+            entry.key = ((static_cast<file_size_type>(
+                data.ftLastWriteTime.dwHighDateTime) << 32)
+                | data.ftLastWriteTime.dwLowDateTime) / 10000000
+                - static_cast<file_size_type>(116444736) * 100;
+            entry.bytes = (static_cast<file_size_type>(
+                data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        }
+
+        entry.name = filename + LOG4CPLUS_TEXT ('.') + suffix;
+        entries.push_back (entry);
+    }
+    while (FindNextFile (handle, &data));
+    FindClose (handle);
+
+#elif defined (LOG4CPLUS_HAVE_UNISTD_H)
+    std::string const dirName (LOG4CPLUS_TSTRING_TO_STRING (dir));
+    DIR * const handle = opendir (dirName.c_str ());
+    if (! handle)
+        return;
+
+    while (struct dirent const * ent = readdir (handle))
+    {
+        tstring const name (LOG4CPLUS_C_STR_TO_TSTRING (ent->d_name));
+        if (name.compare (0, base.size (), base) != 0)
+            continue;
+
+        tstring suffix (name, base.size ());
+        entry.forms = stripForm (suffix);
+        entry.key = 0;
+        entry.bytes = 0;
+        if (! parseSuffix (suffix, entry.key))
+            continue;
+
+        entry.name = filename + LOG4CPLUS_TEXT ('.') + suffix;
+
+        if (naming == PERIOD)
+        {
+            struct stat st;
+            tstring const file (filename + name.substr (base.size () - 1));
+            if (stat (LOG4CPLUS_TSTRING_TO_STRING (file).c_str (), &st) != 0
+                || ! S_ISREG (st.st_mode))
+                continue;
+            entry.key = st.st_mtime;
+            entry.bytes = st.st_size;
+        }
+
+        entries.push_back (entry);
+    }
+    closedir (handle);
+
+#endif
+
+    // Merge forms of the same backup. Partially compressed files of
+    // backups that are gone are not backups.
+    std::sort (entries.begin (), entries.end (), Entry::nameLess);
+    std::deque<Entry> merged;
+    for (std::deque<Entry>::const_iterator it = entries.begin ();
+        it != entries.end (); ++it)
+    {
+        if (! merged.empty () && merged.back ().name == it->name)
+        {
+            merged.back ().forms |= it->forms;
+            merged.back ().key = (std::min) (merged.back ().key, it->key);
+            merged.back ().bytes += it->bytes;
+        }
+        else
+            merged.push_back (*it);
+    }
+    entries.clear ();
+    for (std::deque<Entry>::const_iterator it = merged.begin ();
+        it != merged.end (); ++it)
+    {
+        if (it->forms == PARTIAL)
+            orphans.push_back (it->name);
+        else
+        {
+            entries.push_back (*it);
+            totalSize += it->bytes;
+        }
+    }
+
+    std::sort (entries.begin (), entries.end ());
+
+    if (naming == SEQUENCE && ! entries.empty ())
+        lastSequence = (std::max) (lastSequence, entries.back ().key);
+}
+
+
+bool
+BackupIndex::parseSuffix (tstring const & suffix, file_size_type & key) const
+{
+    switch (naming)
+    {
+    case SEQUENCE:
+        // E.g. "17".
+        return ! suffix.empty () && suffix.size () <= 18
+            && parse_digits (suffix, 0, key) == suffix.size ();
+
+    case TIMESTAMP:
+        // E.g. "20101107-134501.250".
+        return suffix.size () == 19
+            && parse_digits (suffix, 0, key) == 8
+            && suffix[8] == LOG4CPLUS_TEXT ('-')
+            && parse_digits (suffix, 9, key) == 6
+            && suffix[15] == LOG4CPLUS_TEXT ('.')
+            && parse_digits (suffix, 16, key) == 3;
+
+    case PERIOD:
+        // E.g. "2010-11-07", "2010-45" or "2010-11-07-PM.2"; the year
+        // is followed by a dash in all DailyRollingFileAppender
+        // schedules.
+        return suffix.size () > 5
+            && parse_digits (suffix, 0, key) == 4
+            && suffix[4] == LOG4CPLUS_TEXT ('-');
+    }
+
+    return false;
+}
+
+
+BackupIndex::Form
+BackupIndex::stripForm (tstring & suffix)
+{
+    tstring const compressed (GzipCompressor::getFileSuffix ());
+    tstring const partial (partial_suffix ());
+
+    if (ends_with (suffix, partial))
+    {
+        suffix.erase (suffix.size () - partial.size ());
+        return PARTIAL;
+    }
+    else if (ends_with (suffix, compressed))
+    {
+        suffix.erase (suffix.size () - compressed.size ());
+        return COMPRESSED;
+    }
+    else
+        return PLAIN;
+}
+
+
+} } // namespace log4cplus { namespace helpers {
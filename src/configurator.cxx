@@ -330,6 +330,7 @@ PropertyConfigurator::configure()
         LOG4CPLUS_TEXT ("configDebug"), LOG4CPLUS_TEXT ("false"));
     getLogLog ().setInternalDebugging (
         helpers::toLower (val) == LOG4CPLUS_TEXT ("true"));
+    configureClockSource ();
 
     initializeLog4cplus();
     configureAppenders();
@@ -408,6 +409,37 @@ PropertyConfigurator::replaceEnvironVariables()
 
 
 
+void
+PropertyConfigurator::configureClockSource()
+{
+    if (! properties.exists (LOG4CPLUS_TEXT ("clockSource")))
+        return;
+
+    tstring const name = helpers::toUpper (
+        properties.getProperty (LOG4CPLUS_TEXT ("clockSource")));
+    helpers::ClockSource source;
+    if (name == LOG4CPLUS_TEXT ("REALTIME"))
+        source = helpers::REALTIME_CLOCK;
+    else if (name == LOG4CPLUS_TEXT ("COARSE"))
+        source = helpers::COARSE_CLOCK;
+    else if (name == LOG4CPLUS_TEXT ("MONOTONIC"))
+        source = helpers::MONOTONIC_CLOCK;
+    else if (name == LOG4CPLUS_TEXT ("TSC"))
+        source = helpers::TSC_CLOCK;
+    else
+    {
+        getLogLog ().warn (LOG4CPLUS_TEXT ("Invalid clockSource value: \"")
+                           + name + LOG4CPLUS_TEXT ("\""));
+        return;
+    }
+
+    if (helpers::setClockSource (source) != source)
+        getLogLog ().warn (LOG4CPLUS_TEXT ("Clock source ") + name
+                           + LOG4CPLUS_TEXT (" is not available,")
+                           LOG4CPLUS_TEXT (" using REALTIME"));
+}
+
+
 void
 PropertyConfigurator::configureLoggers()
 {
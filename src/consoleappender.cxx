@@ -89,9 +89,12 @@ log4cplus::ConsoleAppender::close()
 void
 log4cplus::ConsoleAppender::append(const spi::InternalLoggingEvent& event)
 {
+    // Format the event before taking the console mutex.
+    const log4cplus::tstring& text = formatEvent(event);
+
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( getLogLog().mutex )
         log4cplus::tostream& output = (logToStdErr ? tcerr : tcout);
-        layout->formatAndAppend(output, event);
+        output.write(text.data(), static_cast<std::streamsize>(text.size()));
         if(immediateFlush) {
             output.flush();
         }
@@ -0,0 +1,207 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/spi/eventpool.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/helpers/thread-config.h>
+#include <memory>
+#include <typeinfo>
+
+
+namespace log4cplus { namespace spi {
+
+
+namespace
+{
+
+
+//! Maximal number of events kept by a single thread.
+static std::size_t const max_pooled_events = 32;
+
+//! Recycled events whose message buffers are larger than this are
+//! deleted instead of being pooled.
+static std::size_t const max_pooled_capacity = 64 * 1024;
+
+
+//! Pool of one thread. It is a fixed size array so that pooling
+//! itself does not allocate either.
+struct ThreadPool
+{
+    std::size_t count;
+    InternalLoggingEvent * events[max_pooled_events];
+};
+
+
+// The counters change only when the pools are not in the steady
+// state, so they are cheap to keep.
+
+unsigned long volatile stats_allocated;
+unsigned long volatile stats_freed;
+unsigned long volatile stats_buffer_growths;
+
+
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+#  define LOG4CPLUS_COUNT(x) LOG4CPLUS_ATOMIC_INCREMENT (x)
+#else
+// Without atomics the counters might miss concurrent increments.
+#  define LOG4CPLUS_COUNT(x) (++(x))
+#endif
+
+
+static
+void
+delete_event (InternalLoggingEvent * ev)
+{
+    LOG4CPLUS_COUNT (stats_freed);
+    delete ev;
+}
+
+
+static
+void
+delete_thread_pool (void * p)
+{
+    ThreadPool * const pool = static_cast<ThreadPool *>(p);
+    while (pool->count != 0)
+        delete_event (pool->events[--pool->count]);
+    delete pool;
+}
+
+
+//! The key is created on first use so that events can be created even
+//! in static constructors which run before this file's initializers.
+static
+LOG4CPLUS_THREAD_LOCAL_TYPE &
+get_thread_pool_key ()
+{
+    static LOG4CPLUS_THREAD_LOCAL_TYPE key
+        = LOG4CPLUS_THREAD_LOCAL_INIT (delete_thread_pool);
+    return key;
+}
+
+
+static
+ThreadPool *
+get_thread_pool ()
+{
+    LOG4CPLUS_THREAD_LOCAL_TYPE & key = get_thread_pool_key ();
+    ThreadPool * pool = static_cast<ThreadPool *>(
+        LOG4CPLUS_GET_THREAD_LOCAL_VALUE (key));
+    if (! pool)
+    {
+        pool = new ThreadPool;
+        pool->count = 0;
+        LOG4CPLUS_SET_THREAD_LOCAL_VALUE (key, pool);
+    }
+
+    return pool;
+}
+
+
+} // namespace
+
+
+InternalLoggingEvent *
+EventPool::acquire ()
+{
+    ThreadPool * const pool = get_thread_pool ();
+    if (pool->count != 0)
+        return pool->events[--pool->count];
+
+    LOG4CPLUS_COUNT (stats_allocated);
+    InternalLoggingEvent * const ev = new InternalLoggingEvent (
+        tstring (), NOT_SET_LOG_LEVEL, tstring (), 0, -1);
+    ev->recycle ();
+    return ev;
+}
+
+
+InternalLoggingEvent *
+EventPool::copy (InternalLoggingEvent const & ev)
+{
+    if (typeid (ev) != typeid (InternalLoggingEvent))
+        return ev.clone ().release ();
+
+    InternalLoggingEvent * const ret = acquire ();
+    try
+    {
+        *ret = ev;
+    }
+    catch (...)
+    {
+        release (ret);
+        throw;
+    }
+
+    return ret;
+}
+
+
+void
+EventPool::release (InternalLoggingEvent * ev)
+{
+    if (! ev)
+        return;
+
+    ThreadPool * const pool = get_thread_pool ();
+    if (pool->count == max_pooled_events
+        || typeid (*ev) != typeid (InternalLoggingEvent)
+        || ev->message.capacity () > max_pooled_capacity)
+    {
+        delete_event (ev);
+        return;
+    }
+
+    ev->recycle ();
+    pool->events[pool->count++] = ev;
+}
+
+
+EventPool::Stats
+EventPool::getStats ()
+{
+    Stats stats;
+    stats.allocated = stats_allocated;
+    stats.freed = stats_freed;
+    stats.bufferGrowths = stats_buffer_growths;
+    return stats;
+}
+
+
+void
+EventPool::resetStats ()
+{
+    stats_allocated = 0;
+    stats_freed = 0;
+    stats_buffer_growths = 0;
+}
+
+
+void
+EventPool::noteBufferGrowth ()
+{
+    LOG4CPLUS_COUNT (stats_buffer_growths);
+}
+
+
+} } // namespace log4cplus { namespace spi {
@@ -20,6 +20,7 @@
 
 #include <log4cplus/spi/factory.h>
 #include <log4cplus/spi/loggerfactory.h>
+#include <log4cplus/asyncappender.h>
 #include <log4cplus/consoleappender.h>
 #include <log4cplus/fileappender.h>
 #include <log4cplus/nullappender.h>
@@ -154,7 +155,12 @@ void initializeFactoryRegistry()
     REG_APPENDER (reg, FileAppender);
     REG_APPENDER (reg, RollingFileAppender);
     REG_APPENDER (reg, DailyRollingFileAppender);
+    REG_APPENDER (reg, TimeBasedRollingFileAppender);
+    REG_APPENDER (reg, MappedFileAppender);
     REG_APPENDER (reg, SocketAppender);
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    REG_APPENDER (reg, AsyncAppender);
+#endif
 #if defined(_WIN32)
 #  if defined(LOG4CPLUS_HAVE_NT_EVENT_LOG)
     REG_APPENDER (reg, NTEventLogAppender);
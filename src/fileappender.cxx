@@ -21,12 +21,23 @@
 #include <log4cplus/fileappender.h>
 #include <log4cplus/layout.h>
 #include <log4cplus/streams.h>
+#include <log4cplus/helpers/backupindex.h>
+#include <log4cplus/helpers/gzip.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/mappedfileoutput.h>
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/timehelper.h>
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <log4cplus/helpers/syncprims.h>
+#include <log4cplus/helpers/uringfileoutput.h>
+#endif
 #include <log4cplus/spi/loggingevent.h>
 #include <algorithm>
 #include <cstdio>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <vector>
 #if defined (__BORLANDC__)
 // For _wrename() and _wremove() on Windows.
 #  include <stdio.h>
@@ -42,6 +53,17 @@
 #include <windows.h>
 #endif
 
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined (__linux__) && ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 
 namespace log4cplus
 {
@@ -121,6 +143,37 @@ file_remove (tstring const & src)
 }
 
 
+//! Makes renames and removals of files in the directory of the file
+//! durable.
+//! @returns Zero or error number.
+static
+long
+sync_directory_of (tstring const & name)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    tstring::size_type const pos = name.rfind (LOG4CPLUS_TEXT ('/'));
+    tstring const dir (pos == tstring::npos ? tstring (LOG4CPLUS_TEXT ("."))
+        : pos == 0 ? tstring (LOG4CPLUS_TEXT ("/")) : name.substr (0, pos));
+
+    int fd;
+    do
+        fd = ::open (LOG4CPLUS_TSTRING_TO_STRING (dir).c_str (), O_RDONLY);
+    while (fd == -1 && errno == EINTR);
+    if (fd == -1)
+        return errno;
+
+    long const ret = ::fsync (fd) == 0 ? 0 : errno;
+    ::close (fd);
+    return ret;
+
+#else
+    (void)name;
+    return 0;
+
+#endif
+}
+
+
 static
 void
 loglog_renaming_result (helpers::LogLog & loglog, tstring const & src,
@@ -150,10 +203,10 @@ loglog_renaming_result (helpers::LogLog & loglog, tstring const & src,
 
 static
 void
-loglog_opening_result (helpers::LogLog & loglog,
-    log4cplus::tostream const & os, tstring const & filename)
+loglog_opening_result (helpers::LogLog & loglog, bool good,
+    tstring const & filename)
 {
-    if (! os)
+    if (! good)
     {
         loglog.error (
             LOG4CPLUS_TEXT("Failed to open file ") 
@@ -162,9 +215,176 @@ loglog_opening_result (helpers::LogLog & loglog,
 }
 
 
+#if defined (__linux__) && ! defined (LOG4CPLUS_SINGLE_THREADED)
+//! Lowers CPU and I/O priority of the calling thread. On Linux both
+//! are per thread.
+static
+void
+lower_thread_priority ()
+{
+#if defined (SYS_gettid)
+    pid_t const tid = static_cast<pid_t>(syscall (SYS_gettid));
+    setpriority (PRIO_PROCESS, tid, 19);
+
+#if defined (SYS_ioprio_set)
+    // IOPRIO_WHO_PROCESS, lowest priority of IOPRIO_CLASS_BE. The idle
+    // class could starve the compression under constant load.
+    syscall (SYS_ioprio_set, 1, tid, (2 << 13) | 7);
+#endif
+#endif
+}
+
+#elif ! defined (LOG4CPLUS_SINGLE_THREADED)
+static
+void
+lower_thread_priority ()
+{ }
+
+#endif
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// helpers::BackupCompressor
+///////////////////////////////////////////////////////////////////////////////
+
+namespace helpers
+{
+
+//! Compresses backups of the rolling appenders into gzip files.
+//! Backups are queued and compressed by worker threads, in single
+//! threaded builds they are compressed right away. Renames and
+//! removals of backups go through it, so that they cannot get mixed
+//! up with compressions in progress.
+class BackupCompressor
+    : public virtual SharedObject
+    , public LogLogUser
+{
+public:
+    //! @param threads Number of worker threads.
+    //! @param level Compression level, see GzipCompressor.
+    BackupCompressor (unsigned threads, int level);
+    virtual ~BackupCompressor ();
+
+    //! Queues compression of the backup into <tt>name.gz</tt>.
+    void compress (tstring const & name);
+
+    //! Renames the backup and its compressed file and updates the
+    //! name of its queued or running compression.
+    //! @returns Zero or error number.
+    long rename (tstring const & src, tstring const & target);
+
+    //! Removes the backup and its compressed file and cancels its
+    //! compression.
+    //! @returns Zero or error number.
+    long remove (tstring const & name);
+
+    //! Removes files left behind by interrupted compressions and
+    //! queues backups that have not been compressed.
+    void recover (BackupIndex & index);
+
+    //! Finishes queued compressions and stops the threads.
+    void terminate ();
+
+private:
+    struct Job
+    {
+        //! Current name of the backup.
+        tstring name;
+        //! Temporary output file, set when the compression starts.
+        tstring partial;
+        bool running;
+        //! Set when the backup has been removed while it was being
+        //! compressed.
+        bool cancelled;
+        //! Set while the worker renames its output into place or
+        //! removes the backup.
+        bool moving;
+    };
+
+    typedef std::list<Job> JobList;
+
+    //! Compresses the input into the job's partial file.
+    //! @returns true on success.
+    bool compressFile (std::ifstream & in, JobList::iterator job);
+
+    //! Renames the partial file of successful job into place and
+    //! removes the backup, or removes the partial file.
+    void finishJob (JobList::iterator job, bool ok);
+
+    bool isCancelled (JobList::iterator job);
+
+    //! Compression level.
+    int const level;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    class Worker;
+    friend class Worker;
+
+    //! Main loop of the worker threads.
+    void work ();
+
+    //! @returns The first queued job whose partial file name is not
+    //! used by a running job, or <code>jobs.end ()</code>.
+    JobList::iterator nextJob ();
+
+    //! Waits until no job moves the files of the backup.
+    void waitForFiles (thread::MutexGuard & guard, tstring const & name);
+
+    //! Protects the data below and the jobs.
+    thread::Mutex mutex;
+    //! Signalled when a job is queued or finished and on exit.
+    thread::ManualResetEvent work_ev;
+    //! Signalled when a job stops moving its files.
+    thread::ManualResetEvent files_ev;
+    std::vector<thread::AbstractThreadPtr> workers;
+    bool exit_flag;
+#endif
+
+    //! Queued and running compressions.
+    JobList jobs;
+};
+
+} // namespace helpers
+
+
+namespace
+{
+
+
+//! Renames a backup, together with its compressed file when backups
+//! are compressed.
+static
+long
+rename_backup (helpers::BackupCompressor * compressor,
+    tstring const & src, tstring const & target)
+{
+    if (compressor)
+        return compressor->rename (src, target);
+    else
+        return file_rename (src, target);
+}
+
+
+//! Removes a backup, together with its compressed file when backups
+//! are compressed.
+static
+long
+remove_backup (helpers::BackupCompressor * compressor,
+    tstring const & name)
+{
+    if (compressor)
+        return compressor->remove (name);
+    else
+        return file_remove (name);
+}
+
+
 static
 void
-rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
+rolloverFiles(const tstring& filename, unsigned int maxBackupIndex,
+    helpers::BackupCompressor * compressor)
 {
     helpers::SharedObjectPtr<helpers::LogLog> loglog
         = helpers::LogLog::getLogLog();
@@ -172,7 +392,7 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
     // Delete the oldest file
     tostringstream buffer;
     buffer << filename << LOG4CPLUS_TEXT(".") << maxBackupIndex;
-    long ret = file_remove (buffer.str ());
+    long ret = remove_backup (compressor, buffer.str ());
 
     tostringstream source_oss;
     tostringstream target_oss;
@@ -192,181 +412,1918 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
 #if defined (WIN32)
         // Try to remove the target first. It seems it is not
         // possible to rename over existing file.
-        ret = file_remove (target);
+        ret = remove_backup (compressor, target);
 #endif
 
-        ret = file_rename (source, target);
+        ret = rename_backup (compressor, source, target);
         loglog_renaming_result (*loglog, source, target, ret);
     }
 } // end rolloverFiles()
 
+
+//! Renames the log file to a new backup name taken from the index and
+//! deletes the oldest backups over the limit. Unlike rolloverFiles(),
+//! older backups are never renamed.
+static
+void
+renameToBackup (helpers::BackupIndex & index, tstring const & filename,
+    tstring const & target, std::size_t maxBackups,
+    helpers::BackupCompressor * compressor)
+{
+    helpers::SharedObjectPtr<helpers::LogLog> loglog
+        = helpers::LogLog::getLogLog();
+
+    loglog->debug (
+        LOG4CPLUS_TEXT("Renaming file ") 
+        + filename 
+        + LOG4CPLUS_TEXT(" to ")
+        + target);
+    long ret = file_rename (filename, target);
+    loglog_renaming_result (*loglog, filename, target, ret);
+    if (ret == 0)
+    {
+        index.add (target);
+        if (compressor)
+            compressor->compress (target);
+    }
+
+    // Normally only the one oldest backup is over the limit.
+    tstring oldest;
+    while (index.size () > maxBackups && index.popOldest (oldest))
+    {
+        ret = remove_backup (compressor, oldest);
+        if (ret == 0)
+            loglog->debug (LOG4CPLUS_TEXT("Removed file ") + oldest);
+        else if (ret != LOG4CPLUS_FILE_NOT_FOUND)
+        {
+            tostringstream oss;
+            oss << LOG4CPLUS_TEXT("Failed to remove file ")
+                << oldest
+                << LOG4CPLUS_TEXT("; error ")
+                << ret;
+            loglog->error (oss.str ());
+        }
+    }
 }
 
 
-///////////////////////////////////////////////////////////////////////////////
-// FileAppender ctors and dtor
-///////////////////////////////////////////////////////////////////////////////
+//! Reads the BackupNaming property.
+//! @returns true and sets naming for "sequence" and "timestamp",
+//! false for "index", the default.
+static
+bool
+getBackupNaming (Properties const & properties, helpers::LogLog & loglog,
+    helpers::BackupIndex::Naming & naming)
+{
+    tstring const value = helpers::toLower (
+        properties.getProperty (LOG4CPLUS_TEXT("BackupNaming")));
 
-FileAppender::FileAppender(const tstring& filename_, 
-    LOG4CPLUS_OPEN_MODE_TYPE mode, bool immediateFlush_)
-    : immediateFlush(immediateFlush_)
-    , reopenDelay(1)
-    , bufferSize (0)
-    , buffer (0)
+    if (value == LOG4CPLUS_TEXT("sequence"))
+        naming = helpers::BackupIndex::SEQUENCE;
+    else if (value == LOG4CPLUS_TEXT("timestamp"))
+        naming = helpers::BackupIndex::TIMESTAMP;
+    else
+    {
+        if (! value.empty () && value != LOG4CPLUS_TEXT("index"))
+            loglog.warn (LOG4CPLUS_TEXT("\"BackupNaming\" not valid: ")
+                + properties.getProperty (LOG4CPLUS_TEXT("BackupNaming")));
+        return false;
+    }
+
+    return true;
+}
+
+
+//! @returns Size in bytes given with optional <tt>KB</tt>, <tt>MB</tt>
+//! or <tt>GB</tt> suffix.
+static
+helpers::file_size_type
+parse_file_size (tstring const & value)
 {
-    init(filename_, mode);
+    tstring const tmp = helpers::toUpper (value);
+    helpers::file_size_type size = std::strtoul (
+        LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str (), 0, 10);
+    if (tmp.find (LOG4CPLUS_TEXT ("GB")) == tmp.length () - 2)
+        size *= 1024 * 1024 * 1024;
+    else if (tmp.find (LOG4CPLUS_TEXT ("MB")) == tmp.length () - 2)
+        size *= 1024 * 1024;
+    else if (tmp.find (LOG4CPLUS_TEXT ("KB")) == tmp.length () - 2)
+        size *= 1024;
+    return size;
 }
 
 
-FileAppender::FileAppender(const Properties& properties, 
-                           LOG4CPLUS_OPEN_MODE_TYPE mode)
-    : Appender(properties)
-    , immediateFlush(true)
-    , reopenDelay(1)
-    , bufferSize (0)
-    , buffer (0)
+//! @returns Number of seconds given with optional <tt>m</tt>,
+//! <tt>h</tt> or <tt>d</tt> suffix for minutes, hours or days.
+static
+unsigned long
+parse_duration (tstring const & value)
 {
-    bool append_ = (mode == std::ios::app);
-    tstring filename_ = properties.getProperty( LOG4CPLUS_TEXT("File") );
-    if (filename_.empty())
+    tstring const tmp = helpers::toLower (value);
+    unsigned long secs = std::strtoul (
+        LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str (), 0, 10);
+    if (! tmp.empty ())
+        switch (tmp[tmp.size () - 1])
+        {
+        case LOG4CPLUS_TEXT ('m'):
+            secs *= 60;
+            break;
+
+        case LOG4CPLUS_TEXT ('h'):
+            secs *= 60 * 60;
+            break;
+
+        case LOG4CPLUS_TEXT ('d'):
+            secs *= 24 * 60 * 60;
+            break;
+        }
+    return secs;
+}
+
+
+//! @returns The <tt>CompressLevel</tt> property or the default.
+static
+int
+getCompressLevel (Properties const & properties, int defaultLevel)
+{
+    tstring const value = properties.getProperty (
+        LOG4CPLUS_TEXT("CompressLevel"));
+    if (value.empty ())
+        return defaultLevel;
+    else
+        return std::atoi (LOG4CPLUS_TSTRING_TO_STRING (value).c_str ());
+}
+
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// helpers::BackupCompressor implementation
+///////////////////////////////////////////////////////////////////////////////
+
+namespace helpers
+{
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+class BackupCompressor::Worker
+    : public thread::AbstractThread
+{
+public:
+    explicit Worker (BackupCompressor & c)
+        : compressor (c)
+    { }
+
+    virtual void run ()
     {
-        getErrorHandler()->error( LOG4CPLUS_TEXT("Invalid filename") );
-        return;
-    }
-    if(properties.exists( LOG4CPLUS_TEXT("ImmediateFlush") )) {
-        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ImmediateFlush") );
-        immediateFlush = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
-    }
-    if(properties.exists( LOG4CPLUS_TEXT("Append") )) {
-        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Append") );
-        append_ = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
-    }
-    if(properties.exists( LOG4CPLUS_TEXT("ReopenDelay") )) {
-        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ReopenDelay") );
-        reopenDelay = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        compressor.work ();
     }
-    if(properties.exists( LOG4CPLUS_TEXT("BufferSize") )) {
-        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("BufferSize") );
-        bufferSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+
+private:
+    BackupCompressor & compressor;
+};
+
+#endif
+
+
+BackupCompressor::BackupCompressor (unsigned threads, int level_)
+    : level (level_)
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    , mutex (thread::Mutex::DEFAULT)
+    , work_ev (false)
+    , files_ev (false)
+    , exit_flag (false)
+#endif
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    for (unsigned i = 0; i != threads; ++i)
+    {
+        thread::AbstractThreadPtr worker (new Worker (*this));
+        worker->start ();
+        workers.push_back (worker);
     }
 
-    init(filename_, (append_ ? std::ios::app : std::ios::trunc));
+#else
+    (void)threads;
+
+#endif
 }
 
 
+BackupCompressor::~BackupCompressor ()
+{
+    terminate ();
+}
+
 
 void
-FileAppender::init(const tstring& filename_, 
-                   LOG4CPLUS_OPEN_MODE_TYPE mode)
+BackupCompressor::compress (tstring const & name)
 {
-    this->filename = filename_;
-    open(mode);
+    Job job;
+    job.name = name;
+    job.running = false;
+    job.cancelled = false;
+    job.moving = false;
 
-    if (bufferSize != 0)
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
     {
-        delete[] buffer;
-        buffer = new tchar[bufferSize];
-        out.rdbuf ()->pubsetbuf (buffer, bufferSize);
+        thread::MutexGuard guard (mutex);
+        jobs.push_back (job);
     }
+    work_ev.signal ();
 
-    if(!out.good()) {
-        getErrorHandler()->error(  LOG4CPLUS_TEXT("Unable to open file: ") 
-                                 + filename);
-        return;
+#else
+    JobList::iterator const it = jobs.insert (jobs.end (), job);
+    it->running = true;
+    it->partial = name + GzipCompressor::getFileSuffix ()
+        + LOG4CPLUS_TEXT (".tmp");
+    std::ifstream in (LOG4CPLUS_TSTRING_TO_STRING (name).c_str (),
+        std::ios::binary);
+    finishJob (it, compressFile (in, it));
+
+#endif
+}
+
+
+long
+BackupCompressor::rename (tstring const & src, tstring const & target)
+{
+    tstring const suffix (GzipCompressor::getFileSuffix ());
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (mutex);
+    waitForFiles (guard, src);
+#endif
+
+    // A running compression reads through its open stream; the name
+    // matters only when its output is renamed into place.
+    for (JobList::iterator it = jobs.begin (); it != jobs.end (); ++it)
+        if (it->name == src)
+            it->name = target;
+
+    long const ret = file_rename (src, target);
+    long const ret_compressed = file_rename (src + suffix, target + suffix);
+    return ret == LOG4CPLUS_FILE_NOT_FOUND ? ret_compressed : ret;
+}
+
+
+long
+BackupCompressor::remove (tstring const & name)
+{
+    tstring const suffix (GzipCompressor::getFileSuffix ());
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (mutex);
+    waitForFiles (guard, name);
+#endif
+
+    JobList::iterator it = jobs.begin ();
+    while (it != jobs.end ())
+    {
+        if (it->name != name)
+            ++it;
+        else if (it->running)
+        {
+            it->cancelled = true;
+            ++it;
+        }
+        else
+            it = jobs.erase (it);
     }
-    getLogLog().debug(LOG4CPLUS_TEXT("Just opened file: ") + filename);
+
+    long const ret = file_remove (name);
+    long const ret_compressed = file_remove (name + suffix);
+    return ret == LOG4CPLUS_FILE_NOT_FOUND ? ret_compressed : ret;
 }
 
 
+void
+BackupCompressor::recover (BackupIndex & index)
+{
+    std::vector<tstring> uncompressed;
+    std::vector<tstring> stale;
+    index.findUncompressed (uncompressed, stale);
+
+    for (std::vector<tstring>::const_iterator it = stale.begin ();
+        it != stale.end (); ++it)
+    {
+        if (file_remove (*it) == 0)
+            getLogLog ().debug (LOG4CPLUS_TEXT ("Removed file ") + *it);
+    }
+
+    for (std::vector<tstring>::const_iterator it = uncompressed.begin ();
+        it != uncompressed.end (); ++it)
+        compress (*it);
+}
+
 
-FileAppender::~FileAppender()
+void
+BackupCompressor::terminate ()
 {
-    destructorImpl();
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    {
+        thread::MutexGuard guard (mutex);
+        exit_flag = true;
+    }
+    work_ev.signal ();
+
+    for (std::vector<thread::AbstractThreadPtr>::iterator it
+            = workers.begin (); it != workers.end (); ++it)
+        (*it)->join ();
+    workers.clear ();
+#endif
 }
 
 
+bool
+BackupCompressor::compressFile (std::ifstream & in, JobList::iterator job)
+{
+    if (! in.is_open ())
+        return false;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    // Written through a file descriptor, so that the compressed data
+    // can be synced before the rename makes them replace the backup.
+    helpers::FileOutput out (0);
+    out.open (job->partial, false);
+#else
+    std::ofstream out (LOG4CPLUS_TSTRING_TO_STRING (job->partial).c_str (),
+        std::ios::binary | std::ios::trunc);
+#endif
+    GzipCompressor gzip (level);
+    std::vector<char> buf (64 * 1024);
+    std::string data;
+
+    while (out.good ())
+    {
+        in.read (&buf[0], static_cast<std::streamsize>(buf.size ()));
+        std::streamsize const len = in.gcount ();
+        if (len <= 0)
+            break;
+
+        gzip.write (&buf[0], static_cast<std::size_t>(len), data);
+        out.write (data.data (), data.size ());
+        data.clear ();
 
-///////////////////////////////////////////////////////////////////////////////
-// FileAppender public methods
-///////////////////////////////////////////////////////////////////////////////
+        if (isCancelled (job))
+            return false;
+    }
 
-void 
-FileAppender::close()
+    gzip.finish (data);
+    out.write (data.data (), data.size ());
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    bool const written = out.good ()
+        && helpers::FileOutput::syncFd (out.dupForSync ()) == 0;
+    out.close ();
+#else
+    out.close ();
+    bool const written = out.good ();
+#endif
+
+    return written && ! in.bad ();
+}
+
+
+void
+BackupCompressor::finishJob (JobList::iterator job, bool ok)
 {
-    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
-        out.close();
-        delete[] buffer;
-        buffer = 0;
-        closed = true;
+    helpers::LogLog & loglog = getLogLog ();
+
+    // Only the job is updated under the mutex, the files are renamed,
+    // synced and removed outside of it, so that rollovers do not wait
+    // for the directory sync. The job stays listed until the end and
+    // rename() and remove() of the backup wait while it moves its files.
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (mutex);
+#endif
+
+    tstring name = job->name;
+    bool const cancelled = job->cancelled;
+    job->moving = ok && ! cancelled;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    guard.unlock ();
+#endif
+
+    if (ok && ! cancelled)
+    {
+        tstring target = name + GzipCompressor::getFileSuffix ();
+
+#if defined (WIN32)
+        file_remove (target);
+#endif
+
+        long const ret = file_rename (job->partial, target);
+        bool synced = false;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        guard.lock ();
+#endif
+        job->moving = false;
+
+        // Keep the backup until the rename is durable, so that a crash
+        // cannot lose both of them. The backup and its compressed file
+        // can be renamed meanwhile, then the new name is synced too.
+        while (ret == 0 && ! job->cancelled
+            && ! (synced && name == job->name))
+        {
+            name = job->name;
+            target = name + GzipCompressor::getFileSuffix ();
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            guard.unlock ();
+            files_ev.signal ();
+#endif
+
+            long const sync_ret = sync_directory_of (target);
+            if (sync_ret != 0)
+            {
+                tostringstream oss;
+                oss << LOG4CPLUS_TEXT ("Failed to sync directory of ")
+                    << target << LOG4CPLUS_TEXT ("; error ") << sync_ret;
+                loglog.warn (oss.str ());
+            }
+            synced = true;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            guard.lock ();
+#endif
+        }
+
+        bool const remove_backup = ret == 0 && ! job->cancelled;
+        job->moving = remove_backup;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        guard.unlock ();
+        files_ev.signal ();
+#endif
+
+        if (ret != 0)
+            loglog_renaming_result (loglog, job->partial, target, ret);
+        else if (remove_backup)
+        {
+            file_remove (name);
+            loglog.debug (LOG4CPLUS_TEXT ("Compressed file ") + name
+                + LOG4CPLUS_TEXT (" to ") + target);
+        }
+    }
+    else
+    {
+        // The partial file name is not reused while the job is listed.
+        file_remove (job->partial);
+        if (! cancelled)
+            loglog.error (LOG4CPLUS_TEXT ("Failed to compress file ")
+                + name);
+    }
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    guard.lock ();
+#endif
+    jobs.erase (job);
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    guard.unlock ();
+    guard.detach ();
+    // A job may wait for the partial file name of this one.
+    work_ev.signal ();
+    files_ev.signal ();
+#endif
+}
+
+
+bool
+BackupCompressor::isCancelled (JobList::iterator job)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (mutex);
+#endif
+
+    return job->cancelled;
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+void
+BackupCompressor::work ()
+{
+    lower_thread_priority ();
+
+    for (;;)
+    {
+        JobList::iterator job;
+        std::ifstream in;
+
+        {
+            thread::MutexGuard guard (mutex);
+
+            while ((job = nextJob ()) == jobs.end () && ! exit_flag)
+            {
+                // The event is reset only after the jobs have been
+                // checked under the mutex and it is signalled after
+                // they change, so no wake up can be lost.
+                work_ev.reset ();
+                guard.unlock ();
+                work_ev.wait ();
+                guard.lock ();
+            }
+
+            // Queued jobs are finished before exit.
+            if (job == jobs.end ())
+                break;
+
+            job->running = true;
+            job->partial = job->name + GzipCompressor::getFileSuffix ()
+                + LOG4CPLUS_TEXT (".tmp");
+
+            // Open the file while its name cannot change.
+            in.open (LOG4CPLUS_TSTRING_TO_STRING (job->name).c_str (),
+                std::ios::binary);
+        }
+
+        finishJob (job, compressFile (in, job));
+    }
+}
+
+
+void
+BackupCompressor::waitForFiles (thread::MutexGuard & guard,
+    tstring const & name)
+{
+    for (;;)
+    {
+        bool moving = false;
+        for (JobList::const_iterator it = jobs.begin ();
+            it != jobs.end () && ! moving; ++it)
+            moving = it->moving && it->name == name;
+
+        if (! moving)
+            break;
+
+        // Reset under the mutex, like work_ev in work ().
+        files_ev.reset ();
+        guard.unlock ();
+        files_ev.wait ();
+        guard.lock ();
+    }
+}
+
+
+BackupCompressor::JobList::iterator
+BackupCompressor::nextJob ()
+{
+    tstring const suffix (GzipCompressor::getFileSuffix ()
+        + tstring (LOG4CPLUS_TEXT (".tmp")));
+
+    for (JobList::iterator it = jobs.begin (); it != jobs.end (); ++it)
+    {
+        if (it->running)
+            continue;
+
+        // With the index naming a new backup can get the name that
+        // a running compression had when it started.
+        tstring const partial (it->name + suffix);
+        bool busy = false;
+        for (JobList::const_iterator other = jobs.begin ();
+            other != jobs.end () && ! busy; ++other)
+            busy = other->running && other->partial == partial;
+        if (! busy)
+            return it;
+    }
+
+    return jobs.end ();
+}
+
+#endif
+
+} // namespace helpers
+
+
+///////////////////////////////////////////////////////////////////////////////
+// helpers::BackupRetention
+///////////////////////////////////////////////////////////////////////////////
+
+namespace helpers
+{
+
+//! Backups of TimeBasedRollingFileAppender and the deletion of those
+//! over its limits. The backups are listed by the index, which scans
+//! the directory only once. Deletion runs on a background thread, in
+//! single threaded builds it is done right after the rollover.
+class BackupRetention
+    : public virtual SharedObject
+    , public LogLogUser
+{
+public:
+    //! @param totalSizeCap Maximal total size of backups or zero.
+    //! @param maxAge Maximal age of backups in seconds or zero.
+    //! @param comp Compressor of the appender or null.
+    BackupRetention (tstring const & filename, file_size_type totalSizeCap,
+        unsigned long maxAge, BackupCompressor * comp);
+    virtual ~BackupRetention ();
+
+    //! Renames the file to a new backup named after the period and
+    //! makes the thread delete the backups over the limits.
+    //! @param scheduled Name of the period's backup, see
+    //! BackupIndex::uniqueName().
+    //! @param bytes Size of the file.
+    void rollover (tstring const & filename, tstring const & scheduled,
+        file_size_type bytes);
+
+    //! Makes the next rollover list the backups again.
+    void invalidate ();
+
+    //! Deletes the backups over the limits and stops the thread.
+    void terminate ();
+
+private:
+    //! Deletes the oldest backups while they are over the limits.
+    void prune ();
+
+    //! @returns true when the oldest backup is over a limit. The mutex
+    //! must be held.
+    bool isOverLimit (Time const & now);
+
+    BackupIndex index;
+    file_size_type const totalSizeCap;
+    unsigned long const maxAge;
+    BackupCompressor * const compressor;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    class Worker;
+    friend class Worker;
+
+    //! Main loop of the thread.
+    void work ();
+
+    //! @returns Milliseconds until the oldest backup gets too old or
+    //! zero when there is no such backup. The mutex must be held.
+    unsigned long timeToExpiry (Time const & now);
+
+    //! Protects the index and the flag.
+    thread::Mutex mutex;
+    //! Signalled when a backup is added and on exit.
+    thread::ManualResetEvent work_ev;
+    thread::AbstractThreadPtr worker;
+    bool exit_flag;
+#endif
+};
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+class BackupRetention::Worker
+    : public thread::AbstractThread
+{
+public:
+    explicit Worker (BackupRetention & r)
+        : retention (r)
+    { }
+
+    virtual void run ()
+    {
+        lower_thread_priority ();
+        retention.work ();
+    }
+
+private:
+    BackupRetention & retention;
+};
+
+#endif
+
+
+BackupRetention::BackupRetention (tstring const & filename,
+    file_size_type totalSizeCap_, unsigned long maxAge_,
+    BackupCompressor * comp)
+    : index (filename, BackupIndex::PERIOD)
+    , totalSizeCap (totalSizeCap_)
+    , maxAge (maxAge_)
+    , compressor (comp)
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    , mutex (thread::Mutex::DEFAULT)
+    , work_ev (false)
+    , exit_flag (false)
+#endif
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The thread lists the backups and deletes those left over the
+    // limits by previous runs.
+    worker = new Worker (*this);
+    worker->start ();
+
+#else
+    prune ();
+
+#endif
+}
+
+
+BackupRetention::~BackupRetention ()
+{
+    terminate ();
+}
+
+
+void
+BackupRetention::rollover (tstring const & filename,
+    tstring const & scheduled, file_size_type bytes)
+{
+    helpers::LogLog & loglog = getLogLog ();
+
+    {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        thread::MutexGuard guard (mutex);
+#endif
+
+        // Rename e.g. "log" to "log.2009-11-07", or to
+        // "log.2009-11-07.1" when the period has been rolled over
+        // already.
+        tstring const target (index.uniqueName (scheduled));
+        loglog.debug (
+            LOG4CPLUS_TEXT ("Renaming file ")
+            + filename
+            + LOG4CPLUS_TEXT (" to ")
+            + target);
+        long const ret = file_rename (filename, target);
+        loglog_renaming_result (loglog, filename, target, ret);
+        if (ret == 0)
+        {
+            index.add (target, Time::gettimeofday (), bytes);
+            if (compressor)
+                compressor->compress (target);
+        }
+    }
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    work_ev.signal ();
+
+#else
+    prune ();
+
+#endif
+}
+
+
+void
+BackupRetention::invalidate ()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (mutex);
+#endif
+
+    index.invalidate ();
+}
+
+
+void
+BackupRetention::terminate ()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    {
+        thread::MutexGuard guard (mutex);
+        exit_flag = true;
+    }
+    work_ev.signal ();
+
+    if (worker.get ())
+    {
+        worker->join ();
+        worker = 0;
+    }
+#endif
+}
+
+
+void
+BackupRetention::prune ()
+{
+    helpers::LogLog & loglog = getLogLog ();
+    tstring oldest;
+
+    for (;;)
+    {
+        {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            thread::MutexGuard guard (mutex);
+#endif
+
+            if (! isOverLimit (Time::gettimeofday ())
+                || ! index.popOldest (oldest))
+                break;
+        }
+
+        // Rollovers can go on while the file is being deleted.
+        long ret = remove_backup (compressor, oldest);
+        if (! compressor)
+        {
+            // The backup can have been compressed by a previous run.
+            long const ret_compressed = file_remove (
+                oldest + GzipCompressor::getFileSuffix ());
+            if (ret == LOG4CPLUS_FILE_NOT_FOUND)
+                ret = ret_compressed;
+        }
+        if (ret == 0)
+            loglog.debug (LOG4CPLUS_TEXT ("Removed file ") + oldest);
+        else if (ret != LOG4CPLUS_FILE_NOT_FOUND)
+        {
+            tostringstream oss;
+            oss << LOG4CPLUS_TEXT ("Failed to remove file ")
+                << oldest
+                << LOG4CPLUS_TEXT ("; error ")
+                << ret;
+            loglog.error (oss.str ());
+        }
+    }
+}
+
+
+bool
+BackupRetention::isOverLimit (Time const & now)
+{
+    if (index.size () == 0)
+        return false;
+
+    return (totalSizeCap != 0 && index.getTotalSize () > totalSizeCap)
+        || (maxAge != 0
+            && index.getOldestTime () + Time (maxAge) <= now);
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+void
+BackupRetention::work ()
+{
+    for (;;)
+    {
+        prune ();
+
+        unsigned long wait;
+        {
+            thread::MutexGuard guard (mutex);
+            if (exit_flag)
+                break;
+
+            wait = timeToExpiry (Time::gettimeofday ());
+
+            // Rollovers and terminate() signal the event after they
+            // have changed the state under the mutex, so no wake up
+            // can be lost.
+            work_ev.reset ();
+        }
+
+        if (wait == 0)
+            work_ev.wait ();
+        else
+            work_ev.timed_wait (wait);
+    }
+}
+
+
+unsigned long
+BackupRetention::timeToExpiry (Time const & now)
+{
+    if (maxAge == 0 || index.size () == 0)
+        return 0;
+
+    // Look again at least every hour, in case the clock changes.
+    Time const left = index.getOldestTime () + Time (maxAge) - now;
+    if (left.sec () >= 60 * 60)
+        return 60 * 60 * 1000;
+    else if (left.nanoseconds () <= 0)
+        return 1;
+    else
+        return static_cast<unsigned long>(left.sec ()) * 1000
+            + left.usec () / 1000 + 1;
+}
+
+#endif
+
+} // namespace helpers
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+///////////////////////////////////////////////////////////////////////////////
+// FileAppender::FlushThread
+///////////////////////////////////////////////////////////////////////////////
+
+class FileAppender::FlushThread
+    : public thread::AbstractThread
+{
+public:
+    FlushThread (FileAppender & app)
+        : appender (app)
+    { }
+
+    virtual void run ();
+    void terminate ();
+
+private:
+    FileAppender & appender;
+    thread::ManualResetEvent exit_ev;
+};
+
+
+void
+FileAppender::FlushThread::run ()
+{
+    unsigned long const flushInterval = appender.flushInterval;
+    unsigned long const syncInterval = appender.syncInterval;
+    Time const now = Time::gettimeofday ();
+    Time nextFlush = now
+        + Time (flushInterval / 1000, (flushInterval % 1000) * 1000);
+    Time nextSync = now
+        + Time (syncInterval / 1000, (syncInterval % 1000) * 1000);
+
+    for (;;)
+    {
+        Time next;
+        if (flushInterval == 0)
+            next = nextSync;
+        else if (syncInterval == 0)
+            next = nextFlush;
+        else
+            next = (std::min) (nextFlush, nextSync);
+
+        Time const left = next - Time::gettimeofday ();
+        unsigned long const wait = left.nanoseconds () > 1000000
+            ? static_cast<unsigned long>(left.nanoseconds () / 1000000) : 1;
+        if (exit_ev.timed_wait (wait))
+            break;
+
+        Time const woken = Time::gettimeofday ();
+        if (syncInterval != 0 && woken >= nextSync)
+        {
+            // The sync flushes the output as well.
+            appender.syncFile ();
+            nextSync = woken
+                + Time (syncInterval / 1000, (syncInterval % 1000) * 1000);
+            nextFlush = woken
+                + Time (flushInterval / 1000, (flushInterval % 1000) * 1000);
+        }
+        else if (flushInterval != 0 && woken >= nextFlush)
+        {
+            {
+                thread::Guard guard (appender.access_mutex);
+                if (! appender.closed)
+                    appender.flushFile ();
+            }
+            nextFlush = woken
+                + Time (flushInterval / 1000, (flushInterval % 1000) * 1000);
+        }
+
+        // The logging threads only start the writeback.
+        appender.dropFileCache ();
+    }
+}
+
+
+void
+FileAppender::FlushThread::terminate ()
+{
+    exit_ev.signal ();
+    join ();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RollingFileAppender::RolloverThread
+///////////////////////////////////////////////////////////////////////////////
+
+class RollingFileAppender::RolloverThread
+    : public thread::AbstractThread
+    , public helpers::LogLogUser
+{
+public:
+    enum NextFileState
+    {
+        //! The next file is open and it has been handed over.
+        NEXT_READY,
+        //! The next file is being prepared.
+        NEXT_PENDING,
+        //! The next file could not be opened.
+        NEXT_FAILED
+    };
+
+    RolloverThread (tstring const & file, int backups,
+        helpers::BackupIndex * index, helpers::BackupCompressor * comp,
+        helpers::FileOutput const & out);
+
+    virtual void run ();
+
+    //! Takes the pre-opened next file.
+    //! @param fd Set to its descriptor when NEXT_READY is returned.
+    NextFileState takeNextFile (int & fd);
+
+    //! Queues rollover of the file that has been replaced by the next
+    //! file. The thread closes the descriptor, renames the backups and
+    //! renames the next file into place.
+    void rollover (int oldFd);
+
+    //! Makes the thread try to open the next file again after
+    //! NEXT_FAILED.
+    void prepareNext ();
+
+    //! Finishes queued rollovers and stops the thread.
+    void terminate ();
+
+private:
+    void doRollover (int oldFd);
+    void openNext ();
+    void closeNext ();
+
+    tstring const filename;
+    tstring const nextFilename;
+    int const maxBackupIndex;
+    //! Backups of the appender, used only by this thread while it
+    //! runs. Null with the rename chain naming.
+    helpers::BackupIndex * const backupIndex;
+    //! Compressor of the appender or null.
+    helpers::BackupCompressor * const compressor;
+    //! Output of the appender, opens the next file.
+    helpers::FileOutput const & output;
+
+    //! Protects the data below.
+    thread::Mutex mutex;
+    //! Signalled when there is work for the thread.
+    thread::ManualResetEvent work_ev;
+    //! Descriptors of replaced files waiting for rollover.
+    std::deque<int> pending;
+    //! Pre-opened next file or -1.
+    int nextFd;
+    //! Set when the next file could not be opened.
+    bool failed;
+    bool exit_flag;
+};
+
+
+RollingFileAppender::RolloverThread::RolloverThread (tstring const & file,
+    int backups, helpers::BackupIndex * index,
+    helpers::BackupCompressor * comp, helpers::FileOutput const & out)
+    : filename (file)
+    , nextFilename (file + LOG4CPLUS_TEXT (".next"))
+    , maxBackupIndex (backups)
+    , backupIndex (index)
+    , compressor (comp)
+    , output (out)
+    , mutex (thread::Mutex::DEFAULT)
+    , work_ev (true)
+    , nextFd (-1)
+    , failed (false)
+    , exit_flag (false)
+{ }
+
+
+void
+RollingFileAppender::RolloverThread::run ()
+{
+    for (;;)
+    {
+        work_ev.wait ();
+
+        int oldFd = -1;
+        {
+            thread::MutexGuard guard (mutex);
+            if (! pending.empty ())
+            {
+                oldFd = pending.front ();
+                pending.pop_front ();
+            }
+            else if (nextFd == -1 && ! failed && ! exit_flag)
+                ; // Open the next file below.
+            else if (exit_flag)
+                break;
+            else
+            {
+                // Nothing to do. The event is reset only after the
+                // state has been checked under the mutex and appender
+                // signals it after changing the state, so no wake up
+                // can be lost.
+                work_ev.reset ();
+                continue;
+            }
+        }
+
+        if (oldFd != -1)
+            doRollover (oldFd);
+        else
+            openNext ();
+    }
+
+    closeNext ();
+}
+
+
+RollingFileAppender::RolloverThread::NextFileState
+RollingFileAppender::RolloverThread::takeNextFile (int & fd)
+{
+    thread::MutexGuard guard (mutex);
+
+    if (nextFd != -1)
+    {
+        fd = nextFd;
+        nextFd = -1;
+        return NEXT_READY;
+    }
+    else if (failed && pending.empty ())
+        return NEXT_FAILED;
+    else
+        return NEXT_PENDING;
+}
+
+
+void
+RollingFileAppender::RolloverThread::rollover (int oldFd)
+{
+    {
+        thread::MutexGuard guard (mutex);
+        pending.push_back (oldFd);
+    }
+    work_ev.signal ();
+}
+
+
+void
+RollingFileAppender::RolloverThread::prepareNext ()
+{
+    {
+        thread::MutexGuard guard (mutex);
+        failed = false;
+    }
+    work_ev.signal ();
+}
+
+
+void
+RollingFileAppender::RolloverThread::terminate ()
+{
+    {
+        thread::MutexGuard guard (mutex);
+        exit_flag = true;
+        work_ev.signal ();
+    }
+    join ();
+}
+
+
+void
+RollingFileAppender::RolloverThread::doRollover (int oldFd)
+{
+    helpers::LogLog & loglog = getLogLog ();
+
+    long ret = helpers::FileOutput::closeFd (oldFd);
+    if (ret != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Failed to close file ") << filename
+            << LOG4CPLUS_TEXT ("; error ") << ret;
+        loglog.error (oss.str ());
+    }
+
+    if (backupIndex)
+        renameToBackup (*backupIndex, filename,
+            backupIndex->nextName (Time::gettimeofday ()), maxBackupIndex,
+            compressor);
+    else if (maxBackupIndex > 0)
+    {
+        rolloverFiles (filename, maxBackupIndex, compressor);
+
+        tstring const target = filename + LOG4CPLUS_TEXT (".1");
+        loglog.debug (
+            LOG4CPLUS_TEXT ("Renaming file ") 
+            + filename 
+            + LOG4CPLUS_TEXT (" to ")
+            + target);
+        ret = file_rename (filename, target);
+        loglog_renaming_result (loglog, filename, target, ret);
+        if (ret == 0 && compressor)
+            compressor->compress (target);
+    }
+    else
+        file_remove (filename);
+
+    ret = file_rename (nextFilename, filename);
+    loglog_renaming_result (loglog, nextFilename, filename, ret);
+}
+
+
+void
+RollingFileAppender::RolloverThread::openNext ()
+{
+    // Open in append mode. The next file is normally empty; if it is
+    // not, it has been left behind by a process that has crashed
+    // before renaming it and its content is kept.
+    int err = 0;
+    int const fd = output.openFile (nextFilename, true, err);
+
+    thread::MutexGuard guard (mutex);
+    if (fd != -1)
+        nextFd = fd;
+    else
+    {
+        failed = true;
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Failed to open file ") << nextFilename
+            << LOG4CPLUS_TEXT ("; error ") << err;
+        getLogLog ().error (oss.str ());
+    }
+}
+
+
+void
+RollingFileAppender::RolloverThread::closeNext ()
+{
+    int fd;
+    {
+        thread::MutexGuard guard (mutex);
+        fd = nextFd;
+        nextFd = -1;
+    }
+    if (fd == -1)
+        return;
+
+    bool const empty = helpers::FileOutput::getFdSize (fd) == 0;
+    helpers::FileOutput::closeFd (fd);
+    if (empty)
+        file_remove (nextFilename);
+}
+
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+FileAppender::FileAppender(const tstring& filename_, 
+    LOG4CPLUS_OPEN_MODE_TYPE mode, bool immediateFlush_)
+    : immediateFlush(immediateFlush_)
+    , reopenDelay(1)
+    , bufferSize (0)
+    , buffer (0)
+    , streamSize (0)
+    , flushLevel (NOT_SET_LOG_LEVEL)
+    , flushInterval (0)
+    , durability (NOT_DURABLE)
+    , syncInterval (0)
+    , syncLevel (ALL_LOG_LEVEL)
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    , commitMutex (thread::Mutex::DEFAULT)
+    , commitEvent (false)
+    , appendCount (0)
+    , syncedCount (0)
+    , committing (false)
+#endif
+{
+    init(filename_, mode);
+}
+
+
+FileAppender::FileAppender(const Properties& properties, 
+                           LOG4CPLUS_OPEN_MODE_TYPE mode)
+    : Appender(properties)
+    , immediateFlush(true)
+    , reopenDelay(1)
+    , bufferSize (0)
+    , buffer (0)
+    , streamSize (0)
+    , flushLevel (NOT_SET_LOG_LEVEL)
+    , flushInterval (0)
+    , durability (NOT_DURABLE)
+    , syncInterval (0)
+    , syncLevel (ALL_LOG_LEVEL)
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    , commitMutex (thread::Mutex::DEFAULT)
+    , commitEvent (false)
+    , appendCount (0)
+    , syncedCount (0)
+    , committing (false)
+#endif
+{
+    bool append_ = (mode == std::ios::app);
+    tstring filename_ = properties.getProperty( LOG4CPLUS_TEXT("File") );
+    if (filename_.empty())
+    {
+        getErrorHandler()->error( LOG4CPLUS_TEXT("Invalid filename") );
+        return;
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("ImmediateFlush") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ImmediateFlush") );
+        immediateFlush = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("Append") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Append") );
+        append_ = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("ReopenDelay") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ReopenDelay") );
+        reopenDelay = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("BufferSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("BufferSize") );
+        bufferSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("FlushInterval") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("FlushInterval") );
+        flushInterval = std::strtoul(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str(), 0, 10);
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("FlushLevel") )) {
+        tstring tmp = helpers::toUpper(
+            properties.getProperty( LOG4CPLUS_TEXT("FlushLevel") ));
+        flushLevel = getLogLevelManager().fromString(tmp);
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("Durability") )) {
+        tstring tmp = helpers::toLower(
+            properties.getProperty( LOG4CPLUS_TEXT("Durability") ));
+        if (tmp == LOG4CPLUS_TEXT("interval")) {
+            durability = SYNC_INTERVAL;
+            syncInterval = 1000;
+        }
+        else if (tmp == LOG4CPLUS_TEXT("group"))
+            durability = GROUP_COMMIT;
+        else if (tmp != LOG4CPLUS_TEXT("none"))
+            getLogLog().warn(  LOG4CPLUS_TEXT("FileAppender::ctor()- \"Durability\" not valid: ")
+                             + properties.getProperty(LOG4CPLUS_TEXT("Durability")));
+    }
+    if(durability == SYNC_INTERVAL
+        && properties.exists( LOG4CPLUS_TEXT("SyncInterval") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("SyncInterval") );
+        syncInterval = std::strtoul(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str(), 0, 10);
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("SyncLevel") )) {
+        tstring tmp = helpers::toUpper(
+            properties.getProperty( LOG4CPLUS_TEXT("SyncLevel") ));
+        syncLevel = getLogLevelManager().fromString(tmp);
+    }
+    bool useLockFile = false;
+    if(properties.exists( LOG4CPLUS_TEXT("UseLockFile") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("UseLockFile") );
+        useLockFile = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("Backend") )) {
+        tstring tmp = helpers::toLower(
+            properties.getProperty( LOG4CPLUS_TEXT("Backend") ));
+        if (tmp == LOG4CPLUS_TEXT("fd"))
+            fileOutput.reset (new helpers::FileOutput);
+        else if (useLockFile)
+            getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"UseLockFile\" needs Backend=fd, using it"));
+        else if (tmp == LOG4CPLUS_TEXT("uring"))
+        {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            unsigned depth = 8;
+            if(properties.exists( LOG4CPLUS_TEXT("UringQueueDepth") )) {
+                tstring value = properties.getProperty( LOG4CPLUS_TEXT("UringQueueDepth") );
+                depth = std::strtoul(LOG4CPLUS_TSTRING_TO_STRING(value).c_str(), 0, 10);
+            }
+            std::auto_ptr<helpers::UringFileOutput> uring (
+                new helpers::UringFileOutput (
+                    bufferSize != 0 ? bufferSize : 64 * 1024, depth));
+            if (uring->isAvailable ())
+                fileOutput.reset (uring.release ());
+            else
+#endif
+            {
+                getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- io_uring is not available, using Backend=fd"));
+                fileOutput.reset (new helpers::FileOutput);
+            }
+        }
+        else if (tmp == LOG4CPLUS_TEXT("mmap"))
+        {
+            std::size_t mapSize = 16 * 1024 * 1024;
+            if(properties.exists( LOG4CPLUS_TEXT("MapSize") ))
+                mapSize = static_cast<std::size_t>(parse_file_size (
+                    properties.getProperty( LOG4CPLUS_TEXT("MapSize") )));
+            fileOutput.reset (new helpers::MappedFileOutput (mapSize));
+        }
+        else if (tmp != LOG4CPLUS_TEXT("stream"))
+            getLogLog().warn(  LOG4CPLUS_TEXT("FileAppender::ctor()- \"Backend\" not valid: ")
+                             + properties.getProperty(LOG4CPLUS_TEXT("Backend")));
+    }
+    if (useLockFile) {
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+        // Only whole events appended by single writes can be shared.
+        if (! fileOutput.get ())
+            fileOutput.reset (new helpers::FileOutput);
+        fileOutput->setShared (true);
+        lockFile.reset (new helpers::LockFile (properties.getProperty(
+            LOG4CPLUS_TEXT("LockFile"), filename_ + LOG4CPLUS_TEXT(".lock"))));
+#else
+        getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"UseLockFile\" is not supported on this platform"));
+#endif
+    }
+    if (durability != NOT_DURABLE) {
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+        // The stream cannot be synced.
+        if (! fileOutput.get ())
+            fileOutput.reset (new helpers::FileOutput);
+#else
+        getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"Durability\" is not supported on this platform"));
+        durability = NOT_DURABLE;
+        syncInterval = 0;
+#endif
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("Preallocate") )) {
+        helpers::file_size_type size = parse_file_size(
+            properties.getProperty( LOG4CPLUS_TEXT("Preallocate") ));
+        // Releasing the space truncates the file, that would cut off
+        // lines appended by other processes meanwhile.
+        if (lockFile.get () && size != 0)
+            getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"Preallocate\" cannot be used with \"UseLockFile\""));
+        else if (fileOutput.get ())
+            fileOutput->setPreallocate (size);
+        else if (size != 0)
+            getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"Preallocate\" needs Backend=fd or Backend=mmap"));
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("DropCacheBehind") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("DropCacheBehind") );
+        bool drop = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+        if (fileOutput.get ())
+            fileOutput->setDropCacheBehind (drop);
+        else if (drop)
+            getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"DropCacheBehind\" needs Backend=fd or Backend=mmap"));
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("CompressOutput") )) {
+        tstring tmp = helpers::toLower(
+            properties.getProperty( LOG4CPLUS_TEXT("CompressOutput") ));
+        if (tmp == LOG4CPLUS_TEXT("gzip"))
+        {
+            // Gzip streams of several processes cannot be interleaved.
+            if (lockFile.get ())
+                getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"CompressOutput\" cannot be used with \"UseLockFile\""));
+            else
+#if defined (UNICODE)
+            // Wide file streams cannot carry binary data.
+            if (! fileOutput.get ())
+                getLogLog().warn( LOG4CPLUS_TEXT("FileAppender::ctor()- \"CompressOutput\" needs Backend=fd"));
+            else
+#endif
+            outputCompressor.reset (new helpers::GzipCompressor (
+                getCompressLevel (properties, 1)));
+        }
+        else if (tmp != LOG4CPLUS_TEXT("none"))
+            getLogLog().warn(  LOG4CPLUS_TEXT("FileAppender::ctor()- \"CompressOutput\" not valid: ")
+                             + properties.getProperty(LOG4CPLUS_TEXT("CompressOutput")));
+    }
+
+    init(filename_, (append_ ? std::ios::app : std::ios::trunc));
+}
+
+
+
+void
+FileAppender::init(const tstring& filename_, 
+                   LOG4CPLUS_OPEN_MODE_TYPE mode)
+{
+    this->filename = filename_;
+    if (fileOutput.get () && bufferSize != 0)
+        fileOutput->setBufferSize (bufferSize);
+    open(mode);
+
+    if (bufferSize != 0 && ! fileOutput.get ())
+    {
+        delete[] buffer;
+        buffer = new tchar[bufferSize];
+        out.rdbuf ()->pubsetbuf (buffer, bufferSize);
+    }
+
+    startFlushThread();
+
+    if(!isFileGood()) {
+        getErrorHandler()->error(  LOG4CPLUS_TEXT("Unable to open file: ") 
+                                 + filename);
+        return;
+    }
+    getLogLog().debug(LOG4CPLUS_TEXT("Just opened file: ") + filename);
+}
+
+
+
+FileAppender::~FileAppender()
+{
+    destructorImpl();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void 
+FileAppender::close()
+{
+    // The flushing thread locks access_mutex, stop it first.
+    stopFlushThread();
+
+    // Let compressions of the backups finish.
+    if (compressor.get ())
+        compressor->terminate ();
+
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+        closeFile();
+        delete[] buffer;
+        buffer = 0;
+        closed = true;
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+}
+
+
+void
+FileAppender::doAppend(const spi::InternalLoggingEvent& event)
+{
+    Appender::doAppend(event);
+
+    // Wait outside of the appender's lock, so that other threads can
+    // append while the file is being synced.
+    if (durability == GROUP_COMMIT && event.getLogLevel() >= syncLevel)
+        groupCommit();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+FileAppender::append(const spi::InternalLoggingEvent& event)
+{
+    if(!isFileGood()) {
+        if(!reopen()) {
+            getErrorHandler()->error(  LOG4CPLUS_TEXT("file is not open: ") 
+                                     + filename);
+            return;
+        }
+        // Resets the error handler to make it 
+        // ready to handle a future append error.
+        else
+            getErrorHandler()->reset();
+    }
+
+    writeText(formatEvent(event));
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (durability == GROUP_COMMIT) {
+        thread::MutexGuard guard (commitMutex);
+        ++appendCount;
+    }
+#endif
+
+    if(immediateFlush
+        || (flushLevel != NOT_SET_LOG_LEVEL
+            && event.getLogLevel() >= flushLevel)) {
+        flushFile();
+    }
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    else if (flushInterval != 0 && event.getTimestamp() >= nextFlushTime) {
+        flushFile();
+        nextFlushTime = event.getTimestamp()
+            + Time(flushInterval / 1000, (flushInterval % 1000) * 1000);
+    }
+
+    if (syncInterval != 0 && event.getTimestamp() >= nextSyncTime) {
+        syncFile();
+        nextSyncTime = event.getTimestamp()
+            + Time(syncInterval / 1000, (syncInterval % 1000) * 1000);
+    }
+#endif
+}
+
+void
+FileAppender::open(std::ios::openmode mode)
+{
+    if (fileOutput.get ())
+        fileOutput->open(filename, (mode & std::ios::app) != 0);
+    else
+    {
+        // Compressed output must not be subject to newline conversion.
+        if (outputCompressor.get ())
+            mode |= std::ios::binary;
+
+        out.open(LOG4CPLUS_TSTRING_TO_STRING(filename).c_str(), mode);
+
+        // Find out the initial size once, getFileSize() then only
+        // counts. Seeking through the buffer does not touch stream
+        // state and does not move the writes in append mode.
+        streamSize = 0;
+        if ((mode & std::ios::app) != 0 && out.good())
+        {
+            std::streamoff const end = out.rdbuf()->pubseekoff(0,
+                std::ios::end, std::ios::out);
+            if (end > 0)
+                streamSize = end;
+        }
+    }
+}
+
+bool
+FileAppender::reopen()
+{
+    // When append never failed and the file re-open attempt must 
+    // be delayed, set the time when reopen should take place.
+    if (reopen_time == log4cplus::helpers::Time () && reopenDelay != 0)
+        reopen_time = log4cplus::helpers::Time::gettimeofday()
+			+ log4cplus::helpers::Time(reopenDelay);
+    else
+	{
+        // Otherwise, check for end of the delay (or absence of delay) to re-open the file.
+        if (reopen_time <= log4cplus::helpers::Time::gettimeofday()
+			|| reopenDelay == 0)
+		{
+            // Close the current file
+            closeFile();
+
+            // Re-open the file.
+            open(std::ios::app);
+
+            // Reset last fail time.
+            reopen_time = log4cplus::helpers::Time ();
+
+            // Succeed if no errors are found.
+            if(isFileGood())
+                return true;
+        }
+    }
+    return false;
+}
+
+void
+FileAppender::closeFile()
+{
+    finishCompressedOutput();
+
+    if (fileOutput.get ())
+    {
+        // Events in the file must not wait for a sync of the next one.
+        if (durability != NOT_DURABLE)
+            fileOutput->sync();
+        fileOutput->close();
+    }
+    else
+    {
+        out.close();
+        out.clear(); // reset flags since the C++ standard specified that all the
+                     // flags should remain unchanged on a close
+    }
+}
+
+bool
+FileAppender::isFileGood() const
+{
+    if (fileOutput.get ())
+        return fileOutput->good();
+    else
+        return out.good();
+}
+
+void
+FileAppender::flushFile()
+{
+    if (outputCompressor.get ())
+    {
+        outputCompressor->flush(compressedOutput);
+        writeBytes(compressedOutput.data(), compressedOutput.size());
+        compressedOutput.clear();
+    }
+
+    if (fileOutput.get ())
+        fileOutput->flush();
+    else
+        out.flush();
+}
+
+helpers::file_size_type
+FileAppender::getFileSize()
+{
+    if (fileOutput.get ())
+        return fileOutput->getSize();
+    else
+        return streamSize;
+}
+
+void
+FileAppender::writeText(const tstring& text)
+{
+    if (! outputCompressor.get ())
+    {
+        if (fileOutput.get ())
+            fileOutput->write(text);
+        else
+        {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            streamSize += text.size();
+        }
+        return;
+    }
+
+#if defined (UNICODE)
+    std::string const bytes (LOG4CPLUS_TSTRING_TO_STRING (text));
+    outputCompressor->write(bytes.data(), bytes.size(), compressedOutput);
+#else
+    outputCompressor->write(text.data(), text.size(), compressedOutput);
+#endif
+    if (! compressedOutput.empty())
+    {
+        writeBytes(compressedOutput.data(), compressedOutput.size());
+        compressedOutput.clear();
+    }
+}
+
+void
+FileAppender::writeBytes(const char * data, std::size_t len)
+{
+    if (fileOutput.get ())
+        fileOutput->write(data, len);
+#if ! defined (UNICODE)
+    else
+    {
+        out.write(data, static_cast<std::streamsize>(len));
+        streamSize += len;
+    }
+#endif
+}
+
+void
+FileAppender::finishCompressedOutput()
+{
+    if (! outputCompressor.get () || ! outputCompressor->isStarted ())
+        return;
+
+    outputCompressor->finish(compressedOutput);
+    writeBytes(compressedOutput.data(), compressedOutput.size());
+    compressedOutput.clear();
+}
+
+bool
+FileAppender::reopenIfReplaced()
+{
+    if (! lockFile.get () || ! fileOutput->isReplaced ())
+        return false;
+
+    helpers::LogLog & loglog = getLogLog();
+    loglog.debug(filename
+        + LOG4CPLUS_TEXT(" has been rolled over by another process, reopening it"));
+    closeFile();
+    open(std::ios::app);
+    loglog_opening_result (loglog, isFileGood (), filename);
+    return true;
+}
+
+void
+FileAppender::syncFile()
+{
+    int fd = -1;
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+        if (closed || ! fileOutput.get ())
+            return;
+
+        flushFile();
+        fd = fileOutput->dupForSync();
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+
+    int const err = helpers::FileOutput::syncFd (fd);
+    if (err != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Failed to sync file ") << filename
+            << LOG4CPLUS_TEXT ("; error ") << err;
+        getLogLog ().error (oss.str ());
+    }
 }
 
+void
+FileAppender::dropFileCache()
+{
+    int fd = -1;
+    helpers::file_size_type offset = 0;
+    helpers::file_size_type len = 0;
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+        if (closed || ! fileOutput.get ())
+            return;
 
+        fd = fileOutput->dupForDropCache(offset, len);
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 
-///////////////////////////////////////////////////////////////////////////////
-// FileAppender protected methods
-///////////////////////////////////////////////////////////////////////////////
+    helpers::FileOutput::dropCacheFd (fd, offset, len);
+}
 
-// This method does not need to be locked since it is called by
-// doAppend() which performs the locking
 void
-FileAppender::append(const spi::InternalLoggingEvent& event)
+FileAppender::groupCommit()
 {
-    if(!out.good()) {
-        if(!reopen()) {
-            getErrorHandler()->error(  LOG4CPLUS_TEXT("file is not open: ") 
-                                     + filename);
-            return;
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    thread::MutexGuard guard (commitMutex);
+
+    // The event of this thread is among the events appended so far.
+    unsigned long const ticket = appendCount;
+    while (static_cast<long>(ticket - syncedCount) > 0)
+    {
+        if (committing)
+        {
+            // The syncing thread clears the flag under the mutex and
+            // signals the event afterwards, so the wake up cannot be
+            // lost.
+            commitEvent.reset ();
+            guard.unlock ();
+            commitEvent.wait ();
+            guard.lock ();
         }
-        // Resets the error handler to make it 
-        // ready to handle a future append error.
         else
-            getErrorHandler()->reset();
+        {
+            // Sync for all threads waiting now. Events appended during
+            // the sync wait for the next one.
+            committing = true;
+            unsigned long const target = appendCount;
+            guard.unlock ();
+            syncFile ();
+            guard.lock ();
+            committing = false;
+            syncedCount = target;
+            guard.unlock ();
+            commitEvent.signal ();
+            guard.lock ();
+        }
     }
 
-    layout->formatAndAppend(out, event);
-    if(immediateFlush) {
-        out.flush();
+#else
+    syncFile();
+
+#endif
+}
+
+void
+FileAppender::startFlushThread()
+{
+    if (flushInterval == 0 && syncInterval == 0)
+        return;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (! flushThread.get ())
+    {
+        // The thread drops the written pages from the page cache.
+        if (fileOutput.get ())
+            fileOutput->setDropCacheDeferred (true);
+
+        flushThread = new FlushThread (*this);
+        flushThread->start ();
     }
+
+#else
+    nextFlushTime = Time::gettimeofday()
+        + Time(flushInterval / 1000, (flushInterval % 1000) * 1000);
+    nextSyncTime = Time::gettimeofday()
+        + Time(syncInterval / 1000, (syncInterval % 1000) * 1000);
+
+#endif
 }
 
 void
-FileAppender::open(std::ios::openmode mode)
+FileAppender::stopFlushThread()
 {
-    out.open(LOG4CPLUS_TSTRING_TO_STRING(filename).c_str(), mode);
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (flushThread.get ())
+    {
+        flushThread->terminate ();
+        flushThread = 0;
+    }
+#endif
 }
 
-bool
-FileAppender::reopen()
+void
+FileAppender::initBackupCompression(const Properties& properties,
+    helpers::BackupIndex::Naming naming)
 {
-    // When append never failed and the file re-open attempt must 
-    // be delayed, set the time when reopen should take place.
-    if (reopen_time == log4cplus::helpers::Time () && reopenDelay != 0)
-        reopen_time = log4cplus::helpers::Time::gettimeofday()
-			+ log4cplus::helpers::Time(reopenDelay);
-    else
-	{
-        // Otherwise, check for end of the delay (or absence of delay) to re-open the file.
-        if (reopen_time <= log4cplus::helpers::Time::gettimeofday()
-			|| reopenDelay == 0)
-		{
-            // Close the current file
-            out.close();
-            out.clear(); // reset flags since the C++ standard specified that all the
-                         // flags should remain unchanged on a close
+    tstring const value = helpers::toLower(
+        properties.getProperty( LOG4CPLUS_TEXT("CompressBackups") ));
+    if (value.empty() || value == LOG4CPLUS_TEXT("none"))
+        return;
+    else if (value != LOG4CPLUS_TEXT("gzip")) {
+        getLogLog().warn(  LOG4CPLUS_TEXT("\"CompressBackups\" not valid: ")
+                         + properties.getProperty(LOG4CPLUS_TEXT("CompressBackups")));
+        return;
+    }
+    else if (outputCompressor.get ()) {
+        getLogLog().warn( LOG4CPLUS_TEXT("\"CompressBackups\" ignored, the output is compressed already"));
+        return;
+    }
+    else if (lockFile.get ()) {
+        // Other processes would rename and remove backups being
+        // compressed by this one.
+        getLogLog().warn( LOG4CPLUS_TEXT("\"CompressBackups\" cannot be used with \"UseLockFile\""));
+        return;
+    }
 
-            // Re-open the file.
-            open(std::ios::app);
+    int threads = 1;
+    if(properties.exists( LOG4CPLUS_TEXT("CompressThreads") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("CompressThreads") );
+        threads = (std::max)(std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str()), 1);
+    }
 
-            // Reset last fail time.
-            reopen_time = log4cplus::helpers::Time ();
+    compressor = new helpers::BackupCompressor (threads,
+        getCompressLevel (properties, 6));
 
-            // Succeed if no errors are found.
-            if(out.good())
-                return true;
-        }
-    }
-    return false;
+    // Uses its own index, the one of the appender is filled lazily.
+    helpers::BackupIndex index (filename, naming);
+    compressor->recover (index);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -403,6 +2360,13 @@ RollingFileAppender::RollingFileAppender(const Properties& properties)
         maxBackupIndex_ = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
     }
 
+    // Names of the index naming are sequence numbers as well.
+    helpers::BackupIndex::Naming naming = helpers::BackupIndex::SEQUENCE;
+    if (getBackupNaming (properties, getLogLog (), naming))
+        backupIndex.reset (new helpers::BackupIndex (filename, naming));
+
+    initBackupCompression (properties, naming);
+
     init(maxFileSize_, maxBackupIndex_);
 }
 
@@ -422,6 +2386,17 @@ RollingFileAppender::init(long maxFileSize_, int maxBackupIndex_)
 
     this->maxFileSize = maxFileSize_;
     this->maxBackupIndex = (std::max)(maxBackupIndex_, 1);
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The next file cannot be prepared in advance when other
+    // processes share the file, they would use the same name for it.
+    if (fileOutput.get () && isFileGood () && ! lockFile.get ())
+    {
+        rolloverThread = new RolloverThread (filename, maxBackupIndex,
+            backupIndex.get (), compressor.get (), *fileOutput);
+        rolloverThread->start ();
+    }
+#endif
 }
 
 
@@ -431,6 +2406,31 @@ RollingFileAppender::~RollingFileAppender()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// RollingFileAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+RollingFileAppender::close()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // Once closed is set no append can hand over a file to the thread.
+    // Let queued renames finish so that the file names are consistent
+    // when the current file is closed.
+    LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
+        closed = true;
+        if (rolloverThread.get ())
+        {
+            rolloverThread->terminate ();
+            rolloverThread = 0;
+        }
+    LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+#endif
+
+    FileAppender::close();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // RollingFileAppender protected methods
 ///////////////////////////////////////////////////////////////////////////////
@@ -442,7 +2442,7 @@ RollingFileAppender::append(const spi::InternalLoggingEvent& event)
 {
     FileAppender::append(event);
 
-    if(out.tellp() > maxFileSize) {
+    if(getFileSize() > maxFileSize) {
         rollover();
     }
 }
@@ -451,17 +2451,60 @@ RollingFileAppender::append(const spi::InternalLoggingEvent& event)
 void 
 RollingFileAppender::rollover()
 {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (rolloverThread.get () && fileOutput.get ())
+    {
+        int fd = -1;
+        switch (rolloverThread->takeNextFile (fd))
+        {
+        case RolloverThread::NEXT_READY:
+            // The gzip member must end in the file it started in.
+            finishCompressedOutput();
+            // Events in the file must not wait for a sync of the next
+            // one.
+            if (durability != NOT_DURABLE)
+                fileOutput->sync ();
+            rolloverThread->rollover (
+                fileOutput->exchange (fd, filename));
+            return;
+
+        case RolloverThread::NEXT_PENDING:
+            // Keep writing into the current file until the next one
+            // is ready.
+            return;
+
+        case RolloverThread::NEXT_FAILED:
+            // Roll over synchronously below. The thread is idle now.
+            break;
+        }
+    }
+#endif
+
     helpers::LogLog & loglog = getLogLog();
 
+    // Processes sharing the file roll it over one at a time. The first
+    // one renames the file, the others only reopen the new one.
+    helpers::LockFileGuard guard (lockFile.get ());
+    if (reopenIfReplaced ())
+        return;
+
     // Close the current file
-    out.close();
-    out.clear(); // reset flags since the C++ standard specified that all the
-                 // flags should remain unchanged on a close
+    closeFile();
+
+    if (backupIndex.get ())
+    {
+        // Other processes add and remove backups as well.
+        if (lockFile.get ())
+            backupIndex->invalidate ();
 
+        renameToBackup (*backupIndex, filename,
+            backupIndex->nextName (Time::gettimeofday ()), maxBackupIndex,
+            compressor.get ());
+    }
     // If maxBackups <= 0, then there is no file renaming to be done.
-    if (maxBackupIndex > 0)
+    else if (maxBackupIndex > 0)
     {
-        rolloverFiles(filename, maxBackupIndex);
+        rolloverFiles(filename, maxBackupIndex, compressor.get ());
 
         // Rename fileName to fileName.1
         tstring target = filename + LOG4CPLUS_TEXT(".1");
@@ -471,7 +2514,7 @@ RollingFileAppender::rollover()
 #if defined (WIN32)
         // Try to remove the target first. It seems it is not
         // possible to rename over existing file.
-        ret = file_remove (target);
+        ret = remove_backup (compressor.get (), target);
 #endif
 
         loglog.debug (
@@ -481,6 +2524,8 @@ RollingFileAppender::rollover()
             + target);
         ret = file_rename (filename, target);
         loglog_renaming_result (loglog, filename, target, ret);
+        if (ret == 0 && compressor.get ())
+            compressor->compress (target);
     }
     else
     {
@@ -489,7 +2534,71 @@ RollingFileAppender::rollover()
 
     // Open it up again in truncation mode
     open(std::ios::out | std::ios::trunc);
-    loglog_opening_result (loglog, out, filename);
+    loglog_opening_result (loglog, isFileGood (), filename);
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (rolloverThread.get ())
+        rolloverThread->prepareNext ();
+#endif
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFileAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+//! @returns Copy of the properties with the mmap backend and with
+//! ImmediateFlush false unless it is set.
+static
+Properties
+mapped_properties (Properties const & properties)
+{
+    Properties props (properties);
+    props.setProperty (LOG4CPLUS_TEXT ("Backend"), LOG4CPLUS_TEXT ("mmap"));
+    if (! props.exists (LOG4CPLUS_TEXT ("ImmediateFlush")))
+        props.setProperty (LOG4CPLUS_TEXT ("ImmediateFlush"),
+            LOG4CPLUS_TEXT ("false"));
+    return props;
+}
+
+
+static
+Properties
+mapped_properties (tstring const & filename, long maxFileSize,
+    int maxBackupIndex, unsigned long mapSize)
+{
+    Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("File"), filename);
+    props.setProperty (LOG4CPLUS_TEXT ("MaxFileSize"),
+        helpers::convertIntegerToString (maxFileSize));
+    props.setProperty (LOG4CPLUS_TEXT ("MaxBackupIndex"),
+        helpers::convertIntegerToString (maxBackupIndex));
+    props.setProperty (LOG4CPLUS_TEXT ("MapSize"),
+        helpers::convertIntegerToString (mapSize));
+    return mapped_properties (props);
+}
+
+} // namespace
+
+
+MappedFileAppender::MappedFileAppender(const tstring& filename_,
+    long maxFileSize_, int maxBackupIndex_, unsigned long mapSize_)
+    : RollingFileAppender(mapped_properties (filename_, maxFileSize_,
+        maxBackupIndex_, mapSize_))
+{ }
+
+
+MappedFileAppender::MappedFileAppender(const Properties& properties)
+    : RollingFileAppender(mapped_properties (properties))
+{ }
+
+
+MappedFileAppender::~MappedFileAppender()
+{
+    destructorImpl();
 }
 
 
@@ -540,6 +2649,14 @@ DailyRollingFileAppender::DailyRollingFileAppender(
         maxBackupIndex = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
     }
 
+    // The period already is a timestamp, both naming schemes keep it.
+    helpers::BackupIndex::Naming naming;
+    if (getBackupNaming (properties, getLogLog (), naming))
+        backupIndex.reset (new helpers::BackupIndex (filename,
+            helpers::BackupIndex::PERIOD));
+
+    initBackupCompression (properties, helpers::BackupIndex::PERIOD);
+
     init(theSchedule);
 }
 
@@ -615,7 +2732,17 @@ DailyRollingFileAppender::~DailyRollingFileAppender()
 void
 DailyRollingFileAppender::close()
 {
-    rollover();
+    // The final rollover must not be repeated when the appender is
+    // closed again, e.g. by Logger::shutdown().
+    if (closed)
+        return;
+
+    // Do not let the flushing thread run during the final rollover.
+    // A shared file is still being written by other processes, it is
+    // rolled over by the first of them that reaches the next period.
+    stopFlushThread();
+    if (! lockFile.get ())
+        rollover();
     FileAppender::close();
 }
 
@@ -642,55 +2769,79 @@ DailyRollingFileAppender::append(const spi::InternalLoggingEvent& event)
 void
 DailyRollingFileAppender::rollover()
 {
-    // Close the current file
-    out.close();
-    out.clear(); // reset flags since the C++ standard specified that all the
-                 // flags should remain unchanged on a close
-
-    // If we've already rolled over this time period, we'll make sure that we
-    // don't overwrite any of those previous files.
-    // E.g. if "log.2009-11-07.1" already exists we rename it
-    // to "log.2009-11-07.2", etc.
-    rolloverFiles(scheduledFilename, maxBackupIndex);
-
-    // Do not overwriet the newest file either, e.g. if "log.2009-11-07"
-    // already exists rename it to "log.2009-11-07.1"
-    tostringstream backup_target_oss;
-    backup_target_oss << scheduledFilename << LOG4CPLUS_TEXT(".") << 1;
-    tstring backupTarget = backup_target_oss.str();
-
     helpers::LogLog & loglog = getLogLog();
-    long ret;
+
+    // Processes sharing the file roll it over one at a time. The first
+    // one renames the file, the others only reopen the new one.
+    helpers::LockFileGuard guard (lockFile.get ());
+    if (! reopenIfReplaced ())
+    {
+        // Close the current file
+        closeFile();
+
+        if (backupIndex.get ())
+        {
+            // Other processes add and remove backups as well.
+            if (lockFile.get ())
+                backupIndex->invalidate ();
+
+            // Rename e.g. "log" to "log.2009-11-07", or to "log.2009-11-07.1"
+            // when the period has been rolled over already. Older backups
+            // keep their names.
+            renameToBackup (*backupIndex, filename,
+                backupIndex->uniqueName (scheduledFilename), maxBackupIndex,
+                compressor.get ());
+        }
+        else
+        {
+            long ret;
+
+            // If we've already rolled over this time period, we'll make sure that we
+            // don't overwrite any of those previous files.
+            // E.g. if "log.2009-11-07.1" already exists we rename it
+            // to "log.2009-11-07.2", etc.
+            rolloverFiles(scheduledFilename, maxBackupIndex, compressor.get ());
+
+            // Do not overwriet the newest file either, e.g. if "log.2009-11-07"
+            // already exists rename it to "log.2009-11-07.1"
+            tostringstream backup_target_oss;
+            backup_target_oss << scheduledFilename << LOG4CPLUS_TEXT(".") << 1;
+            tstring backupTarget = backup_target_oss.str();
 
 #if defined (WIN32)
-    // Try to remove the target first. It seems it is not
-    // possible to rename over existing file, e.g. "log.2009-11-07.1".
-    ret = file_remove (backupTarget);
+            // Try to remove the target first. It seems it is not
+            // possible to rename over existing file, e.g. "log.2009-11-07.1".
+            ret = remove_backup (compressor.get (), backupTarget);
 #endif
 
-    // Rename e.g. "log.2009-11-07" to "log.2009-11-07.1".
-    ret = file_rename (scheduledFilename, backupTarget);
-    loglog_renaming_result (loglog, scheduledFilename, backupTarget, ret);
+            // Rename e.g. "log.2009-11-07" to "log.2009-11-07.1".
+            ret = rename_backup (compressor.get (), scheduledFilename,
+                backupTarget);
+            loglog_renaming_result (loglog, scheduledFilename, backupTarget, ret);
 
 #if defined (WIN32)
-    // Try to remove the target first. It seems it is not
-    // possible to rename over existing file, e.g. "log.2009-11-07".
-    ret = file_remove (scheduledFilename);
+            // Try to remove the target first. It seems it is not
+            // possible to rename over existing file, e.g. "log.2009-11-07".
+            ret = remove_backup (compressor.get (), scheduledFilename);
 #endif
    
-    // Rename filename to scheduledFilename,
-    // e.g. rename "log" to "log.2009-11-07".
-    loglog.debug(
-        LOG4CPLUS_TEXT("Renaming file ")
-        + filename 
-        + LOG4CPLUS_TEXT(" to ")
-        + scheduledFilename);
-    ret = file_rename (filename, scheduledFilename);
-    loglog_renaming_result (loglog, filename, scheduledFilename, ret);
+            // Rename filename to scheduledFilename,
+            // e.g. rename "log" to "log.2009-11-07".
+            loglog.debug(
+                LOG4CPLUS_TEXT("Renaming file ")
+                + filename 
+                + LOG4CPLUS_TEXT(" to ")
+                + scheduledFilename);
+            ret = file_rename (filename, scheduledFilename);
+            loglog_renaming_result (loglog, filename, scheduledFilename, ret);
+            if (ret == 0 && compressor.get ())
+                compressor->compress (scheduledFilename);
+        }
 
-    // Open a new file, e.g. "log".
-    open(std::ios::out | std::ios::trunc);
-    loglog_opening_result (loglog, out, filename);
+        // Open a new file, e.g. "log".
+        open(std::ios::out | std::ios::trunc);
+        loglog_opening_result (loglog, isFileGood (), filename);
+    }
 
     // Calculate the next rollover time
     log4cplus::helpers::Time now = Time::gettimeofday();
@@ -795,4 +2946,158 @@ DailyRollingFileAppender::getFilename(const Time& t) const
     return result;
 }
 
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TimeBasedRollingFileAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+TimeBasedRollingFileAppender::TimeBasedRollingFileAppender(
+    const tstring& filename_, DailyRollingFileSchedule schedule_,
+    long maxFileSize_, helpers::file_size_type totalSizeCap_,
+    unsigned long maxBackupAge_, bool immediateFlush_)
+    : DailyRollingFileAppender(filename_, schedule_, immediateFlush_)
+    , maxFileSize(0)
+{
+    init(maxFileSize_, totalSizeCap_, maxBackupAge_);
+}
+
+
+
+TimeBasedRollingFileAppender::TimeBasedRollingFileAppender(
+    const Properties& properties)
+    : DailyRollingFileAppender(properties)
+    , maxFileSize(0)
+{
+    helpers::file_size_type maxFileSize_ = 10*1024*1024;
+    if(properties.exists( LOG4CPLUS_TEXT("MaxFileSize") ))
+        maxFileSize_ = parse_file_size(
+            properties.getProperty( LOG4CPLUS_TEXT("MaxFileSize") ));
+
+    helpers::file_size_type totalSizeCap_ = 0;
+    if(properties.exists( LOG4CPLUS_TEXT("TotalSizeCap") ))
+        totalSizeCap_ = parse_file_size(
+            properties.getProperty( LOG4CPLUS_TEXT("TotalSizeCap") ));
+
+    unsigned long maxBackupAge_ = 0;
+    if(properties.exists( LOG4CPLUS_TEXT("MaxBackupAge") ))
+        maxBackupAge_ = parse_duration(
+            properties.getProperty( LOG4CPLUS_TEXT("MaxBackupAge") ));
+
+    // The backups are kept by the retention, whatever the naming.
+    backupIndex.reset ();
+
+    init(maxFileSize_, totalSizeCap_, maxBackupAge_);
+}
+
+
+
+void
+TimeBasedRollingFileAppender::init(helpers::file_size_type maxFileSize_,
+    helpers::file_size_type totalSizeCap_, unsigned long maxBackupAge_)
+{
+    if (maxFileSize_ != 0 && maxFileSize_ < MINIMUM_ROLLING_LOG_SIZE)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("TimeBasedRollingFileAppender: MaxFileSize property")
+            LOG4CPLUS_TEXT (" value is too small. Resetting to ")
+            << MINIMUM_ROLLING_LOG_SIZE << ".";
+        getLogLog ().warn (oss.str ());
+        maxFileSize_ = MINIMUM_ROLLING_LOG_SIZE;
+    }
+    maxFileSize = maxFileSize_;
+
+    if (! filename.empty ())
+        retention = new helpers::BackupRetention (filename, totalSizeCap_,
+            maxBackupAge_, compressor.get ());
+}
+
+
+
+TimeBasedRollingFileAppender::~TimeBasedRollingFileAppender()
+{
+    destructorImpl();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TimeBasedRollingFileAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+TimeBasedRollingFileAppender::close()
+{
+    DailyRollingFileAppender::close();
+
+    // The thread deletes backups over the limits, including those
+    // left by the final rollover, before it stops.
+    if (retention.get ())
+        retention->terminate ();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TimeBasedRollingFileAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+TimeBasedRollingFileAppender::append(const spi::InternalLoggingEvent& event)
+{
+    if(event.getTimestamp() >= nextRolloverTime) {
+        rollover();
+    }
+
+    FileAppender::append(event);
+
+    if(maxFileSize != 0 && getFileSize() > maxFileSize) {
+        rollover();
+    }
+}
+
+
+
+void
+TimeBasedRollingFileAppender::rollover()
+{
+    helpers::LogLog & loglog = getLogLog();
+
+    // Processes sharing the file roll it over one at a time. The first
+    // one renames the file, the others only reopen the new one.
+    helpers::LockFileGuard guard (lockFile.get ());
+    if (! reopenIfReplaced ())
+    {
+        helpers::file_size_type const size = getFileSize();
+
+        // Close the current file
+        closeFile();
+
+        if (retention.get ())
+        {
+            // Other processes add and remove backups as well.
+            if (lockFile.get ())
+                retention->invalidate ();
+
+            retention->rollover (filename, scheduledFilename, size);
+        }
+
+        // Open a new file, e.g. "log".
+        open(std::ios::out | std::ios::trunc);
+        loglog_opening_result (loglog, isFileGood (), filename);
+    }
+
+    // Calculate the next rollover time
+    log4cplus::helpers::Time now = Time::gettimeofday();
+    if (now >= nextRolloverTime)
+    {
+        scheduledFilename = getFilename(now);
+        nextRolloverTime = calculateNextRolloverTime(now);
+    }
+}
+
 } // namespace log4cplus
@@ -0,0 +1,580 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/fileoutput.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/streams.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <cerrno>
+#include <unistd.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_SYS_TYPES_H)
+#include <sys/types.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <fcntl.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+//! Amount of data written before writeback is started and the data
+//! written before are dropped from the page cache.
+file_size_type const DROP_CACHE_STEP = 1024 * 1024;
+
+} // namespace
+
+
+FileOutput::FileOutput (std::size_t bufferSize)
+    : fd (-1)
+    , failed (false)
+    , buffer (0)
+    , capacity (0)
+    , used (0)
+    , size (0)
+    , written (0)
+    , preallocateSize (0)
+    , preallocated (0)
+    , dropCache (false)
+    , writebackStarted (0)
+    , cacheDropped (0)
+    , dropDeferred (false)
+    , shared (false)
+{
+    setBufferSize (bufferSize);
+}
+
+
+FileOutput::~FileOutput ()
+{
+    close ();
+    delete[] buffer;
+}
+
+
+bool
+FileOutput::open (tstring const & name, bool append)
+{
+    close ();
+
+    filename = name;
+    failed = false;
+    size = 0;
+
+    int err = 0;
+    fd = openFile (name, append, err);
+    if (fd == -1)
+    {
+        reportError (LOG4CPLUS_TEXT ("open"), err);
+        return false;
+    }
+
+    size = (std::max) (getFdSize (fd), static_cast<file_size_type>(0));
+    resetOffsets ();
+    return true;
+}
+
+
+void
+FileOutput::close ()
+{
+    if (fd == -1)
+        return;
+
+    flush ();
+    releaseFile ();
+
+    int const ret = closeFd (fd);
+    if (ret != 0)
+        reportError (LOG4CPLUS_TEXT ("close"), ret);
+
+    fd = -1;
+    used = 0;
+}
+
+
+int
+FileOutput::exchange (int newFd, tstring const & name)
+{
+    flush ();
+    releaseFile ();
+
+    int const oldFd = fd;
+    fd = newFd;
+    filename = name;
+    failed = false;
+    used = 0;
+    size = (std::max) (getFdSize (fd), static_cast<file_size_type>(0));
+    resetOffsets ();
+    return oldFd;
+}
+
+
+int
+FileOutput::openFile (tstring const & name, bool append, int & err) const
+{
+    return openFd (name, append, err);
+}
+
+
+int
+FileOutput::openFd (tstring const & name, bool append, int & err)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    int oflags = O_WRONLY | O_CREAT | O_APPEND;
+    if (! append)
+        oflags |= O_TRUNC;
+#if defined (O_CLOEXEC)
+    oflags |= O_CLOEXEC;
+#endif
+
+    std::string const fname (LOG4CPLUS_TSTRING_TO_STRING (name));
+    int ret;
+    do
+        ret = ::open (fname.c_str (), oflags, 0666);
+    while (ret == -1 && errno == EINTR);
+
+    err = ret == -1 ? errno : 0;
+    return ret;
+
+#else
+    // File descriptor output is not supported on this platform.
+    (void)name;
+    (void)append;
+    err = -1;
+    return -1;
+
+#endif
+}
+
+
+int
+FileOutput::closeFd (int fd_)
+{
+    if (fd_ == -1)
+        return 0;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    // Do not retry close() on EINTR, the descriptor is released
+    // anyway on Linux and retrying could close an unrelated one.
+    if (::close (fd_) != 0 && errno != EINTR)
+        return errno;
+#endif
+
+    return 0;
+}
+
+
+int
+FileOutput::syncFd (int fd_)
+{
+    if (fd_ == -1)
+        return 0;
+
+    int err = 0;
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#if defined (__linux__)
+    if (::fdatasync (fd_) != 0)
+#else
+    if (::fsync (fd_) != 0)
+#endif
+        err = errno;
+#endif
+
+    int const ret = closeFd (fd_);
+    return err != 0 ? err : ret;
+}
+
+
+file_size_type
+FileOutput::getFdSize (int fd_)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    struct stat st;
+    if (::fstat (fd_, &st) == 0)
+        return st.st_size;
+#else
+    (void)fd_;
+#endif
+
+    return -1;
+}
+
+
+bool
+FileOutput::isReplaced () const
+{
+    if (fd == -1)
+        return true;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    struct stat fdStat;
+    struct stat nameStat;
+    std::string const fname (LOG4CPLUS_TSTRING_TO_STRING (filename));
+    if (::fstat (fd, &fdStat) != 0 || ::stat (fname.c_str (), &nameStat) != 0)
+        return true;
+
+    return fdStat.st_ino != nameStat.st_ino
+        || fdStat.st_dev != nameStat.st_dev;
+
+#else
+    return false;
+
+#endif
+}
+
+
+bool
+FileOutput::good () const
+{
+    return fd != -1 && ! failed;
+}
+
+
+bool
+FileOutput::is_open () const
+{
+    return fd != -1;
+}
+
+
+void
+FileOutput::write (char const * data, std::size_t len)
+{
+    if (len == 0 || ! good ())
+        return;
+
+    if (used + len > capacity)
+    {
+        flush ();
+        if (len >= capacity)
+        {
+            // Too big for the buffer, write it directly.
+            if (writeOut (data, len))
+                size += len;
+            return;
+        }
+    }
+
+    std::memcpy (buffer + used, data, len);
+    used += len;
+    size += len;
+}
+
+
+void
+FileOutput::write (tstring const & text)
+{
+#if defined (UNICODE)
+    std::string const bytes (LOG4CPLUS_TSTRING_TO_STRING (text));
+    write (bytes.data (), bytes.size ());
+
+#else
+    write (text.data (), text.size ());
+
+#endif
+}
+
+
+void
+FileOutput::flush ()
+{
+    if (used == 0)
+        return;
+
+    std::size_t const len = used;
+    used = 0;
+    if (! writeOut (buffer, len))
+        // The buffered bytes are lost.
+        size -= len;
+}
+
+
+void
+FileOutput::sync ()
+{
+    flush ();
+    if (! good ())
+        return;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#if defined (__linux__)
+    int const ret = ::fdatasync (fd);
+#else
+    int const ret = ::fsync (fd);
+#endif
+    if (ret != 0)
+        reportError (LOG4CPLUS_TEXT ("fdatasync"), errno);
+#endif
+}
+
+
+int
+FileOutput::dupForSync ()
+{
+    flush ();
+    return dupFd ();
+}
+
+
+int
+FileOutput::dupFd ()
+{
+    if (fd == -1)
+        return -1;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#if defined (F_DUPFD_CLOEXEC)
+    int const ret = ::fcntl (fd, F_DUPFD_CLOEXEC, 0);
+#else
+    int const ret = ::dup (fd);
+#endif
+    if (ret == -1)
+        reportError (LOG4CPLUS_TEXT ("dup"), errno);
+    return ret;
+
+#else
+    return -1;
+
+#endif
+}
+
+
+void
+FileOutput::setBufferSize (std::size_t bufferSize)
+{
+    flush ();
+    delete[] buffer;
+    buffer = 0;
+    capacity = 0;
+    if (bufferSize != 0)
+    {
+        buffer = new char[bufferSize];
+        capacity = bufferSize;
+    }
+}
+
+
+bool
+FileOutput::writeOut (char const * data, std::size_t len)
+{
+    if (! good ())
+        return false;
+
+    preallocate (written + len);
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    std::size_t const total = len;
+    while (len != 0)
+    {
+        ssize_t ret = ::write (fd, data, len);
+        if (ret == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            reportError (LOG4CPLUS_TEXT ("write"), errno);
+            failed = true;
+            return false;
+        }
+
+        data += ret;
+        len -= ret;
+    }
+
+    written += total;
+    if (shared)
+    {
+        // Every append moves the offset to the end of the file first,
+        // so it is the end of the file right after this write. The
+        // difference is what other processes have appended meanwhile.
+        off_t const end = ::lseek (fd, 0, SEEK_CUR);
+        if (end != -1)
+        {
+            size += end - written;
+            written = end;
+        }
+    }
+    dropCacheBehind (written);
+    return true;
+
+#else
+    (void)data;
+    (void)len;
+    return false;
+
+#endif
+}
+
+
+void
+FileOutput::resetOffsets ()
+{
+    written = size;
+    preallocated = size;
+    writebackStarted = size;
+    cacheDropped = size;
+}
+
+
+void
+FileOutput::preallocate (file_size_type end)
+{
+    // Releasing the space of a shared file could truncate data of
+    // other processes.
+    if (preallocateSize == 0 || shared || end <= preallocated)
+        return;
+
+#if defined (__linux__) && defined (FALLOC_FL_KEEP_SIZE)
+    // Appends go past the end of the file, the size must not change.
+    file_size_type const target = end + preallocateSize;
+    if (::fallocate (fd, FALLOC_FL_KEEP_SIZE, preallocated,
+            target - preallocated) != 0)
+    {
+        // E.g. not supported by the file system; do not try again.
+        reportError (LOG4CPLUS_TEXT ("fallocate"), errno);
+        preallocateSize = 0;
+        return;
+    }
+    preallocated = target;
+
+#else
+    preallocateSize = 0;
+
+#endif
+}
+
+
+void
+FileOutput::dropCacheBehind (file_size_type end)
+{
+#if defined (__linux__)
+    if (! dropCache || end - writebackStarted < DROP_CACHE_STEP)
+        return;
+
+    // Only start the writeback, waiting for it would stall the logging
+    // thread. Dirty pages and pages under writeback are not dropped,
+    // so without the deferred dropping some of them stay cached. The
+    // calls are only advisory, their failures do not matter.
+    if (! dropDeferred && writebackStarted > cacheDropped)
+    {
+        ::posix_fadvise (fd, cacheDropped, writebackStarted - cacheDropped,
+            POSIX_FADV_DONTNEED);
+        cacheDropped = writebackStarted;
+    }
+
+    ::sync_file_range (fd, writebackStarted, end - writebackStarted,
+        SYNC_FILE_RANGE_WRITE);
+    writebackStarted = end;
+
+#else
+    (void)end;
+
+#endif
+}
+
+
+int
+FileOutput::dupForDropCache (file_size_type & offset, file_size_type & len)
+{
+    if (! dropCache || writebackStarted <= cacheDropped)
+        return -1;
+
+    int const ret = dupFd ();
+    if (ret != -1)
+    {
+        offset = cacheDropped;
+        len = writebackStarted - cacheDropped;
+        cacheDropped = writebackStarted;
+    }
+    return ret;
+}
+
+
+void
+FileOutput::dropCacheFd (int fd_, file_size_type offset, file_size_type len)
+{
+    if (fd_ == -1)
+        return;
+
+#if defined (__linux__)
+    ::sync_file_range (fd_, offset, len, SYNC_FILE_RANGE_WAIT_BEFORE
+        | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    ::posix_fadvise (fd_, offset, len, POSIX_FADV_DONTNEED);
+#else
+    (void)offset;
+    (void)len;
+#endif
+
+    closeFd (fd_);
+}
+
+
+void
+FileOutput::releaseFile ()
+{
+#if defined (__linux__)
+    if (preallocated > written)
+    {
+        // Truncating to the current size frees the blocks allocated
+        // beyond it. Shared files are not preallocated, no other
+        // process can append between the fstat() and the truncation.
+        file_size_type const end = getFdSize (fd);
+        if (end >= 0 && ::ftruncate (fd, end) != 0)
+            reportError (LOG4CPLUS_TEXT ("ftruncate"), errno);
+        preallocated = written;
+    }
+
+    if (dropCache)
+    {
+        // Pages that are still dirty stay in the page cache, waiting
+        // for them here would stall the rollover.
+        ::sync_file_range (fd, cacheDropped, 0, SYNC_FILE_RANGE_WRITE);
+        ::posix_fadvise (fd, cacheDropped, 0, POSIX_FADV_DONTNEED);
+    }
+#endif
+}
+
+
+void
+FileOutput::reportError (tchar const * func, int err)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT ("FileOutput: ") << func
+        << LOG4CPLUS_TEXT ("() failed for file ") << filename
+        << LOG4CPLUS_TEXT ("; error ") << err;
+    getLogLog ().error (oss.str ());
+}
+
+
+} } // namespace log4cplus { namespace helpers {
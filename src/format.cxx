@@ -0,0 +1,402 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/format.h>
+#include <log4cplus/loggingmacros.h>
+#include <algorithm>
+#include <cstdio>
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+
+static
+void
+append_ulong (tstring & out, unsigned long v)
+{
+    // Enough for 64 bit unsigned long.
+    tchar buf[24];
+    tchar * const end = buf + sizeof (buf) / sizeof (buf[0]);
+    tchar * p = end;
+
+    do
+    {
+        *--p = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + v % 10);
+        v /= 10;
+    }
+    while (v != 0);
+
+    out.append (p, end);
+}
+
+
+static
+void
+append_long (tstring & out, long v)
+{
+    if (v < 0)
+    {
+        out.push_back (LOG4CPLUS_TEXT ('-'));
+        // Negate in unsigned arithmetic so that LONG_MIN works, too.
+        append_ulong (out, 0ul - static_cast<unsigned long>(v));
+    }
+    else
+        append_ulong (out, static_cast<unsigned long>(v));
+}
+
+
+static
+void
+append_double (tstring & out, double v)
+{
+    // %g with the default stream precision is at most 13 characters
+    // long, including the sign and the exponent.
+    char buf[32];
+    int const len = std::sprintf (buf, "%.6g", v);
+    for (int i = 0; i < len; ++i)
+        out.push_back (static_cast<tchar>(buf[i]));
+}
+
+
+static
+void
+append_arg (tstring & out, FormatArg const & arg)
+{
+    switch (arg.type)
+    {
+    case FormatArg::LONG:
+        append_long (out, arg.value.l);
+        break;
+
+    case FormatArg::ULONG:
+        append_ulong (out, arg.value.ul);
+        break;
+
+    case FormatArg::DOUBLE:
+        append_double (out, arg.value.d);
+        break;
+
+    case FormatArg::BOOL:
+        out.append (arg.value.b
+            ? LOG4CPLUS_TEXT ("true") : LOG4CPLUS_TEXT ("false"));
+        break;
+
+    case FormatArg::CHAR:
+        out.push_back (arg.value.c);
+        break;
+
+    case FormatArg::CSTR:
+    case FormatArg::LITERAL:
+        if (arg.value.cstr)
+            out.append (arg.value.cstr);
+        else
+            out.append (LOG4CPLUS_TEXT ("(null)"));
+        break;
+
+    case FormatArg::STR:
+        out.append (*arg.value.str);
+        break;
+
+    case FormatArg::TEXT:
+        out.append (arg.value.text.ptr, arg.value.text.len);
+        break;
+
+    case FormatArg::STREAMABLE:
+    {
+        // The operator << might log, too. Take a stream of our own.
+        _macros_oss_holder buf;
+        arg.value.obj.write (buf.stream (), arg.value.obj.ptr);
+        out.append (buf.str ());
+        break;
+    }
+    }
+}
+
+
+//! Adapts an array of FormatArg pointers for format_impl().
+struct ArgArray
+{
+    FormatArg const * const * args;
+
+    void
+    append (tstring & out, std::size_t i) const
+    {
+        append_arg (out, *args[i]);
+    }
+};
+
+
+template <typename Args>
+static
+void
+format_impl (tstring & out, tchar const * fmt, Args const & args,
+    std::size_t count)
+{
+    std::size_t next_arg = 0;
+    tchar const * literal = fmt;
+    tchar const * p = fmt;
+
+    for (; *p; ++p)
+    {
+        if (*p == LOG4CPLUS_TEXT ('{'))
+        {
+            if (p[1] == LOG4CPLUS_TEXT ('}') && next_arg != count)
+            {
+                out.append (literal, p);
+                args.append (out, next_arg++);
+                literal = ++p + 1;
+            }
+            else if (p[1] == LOG4CPLUS_TEXT ('{'))
+            {
+                out.append (literal, p + 1);
+                literal = ++p + 1;
+            }
+        }
+        else if (*p == LOG4CPLUS_TEXT ('}') && p[1] == LOG4CPLUS_TEXT ('}'))
+        {
+            out.append (literal, p + 1);
+            literal = ++p + 1;
+        }
+    }
+
+    out.append (literal, p);
+}
+
+
+} // namespace
+
+
+void
+format_message (tstring & out, tchar const * fmt,
+    FormatArg const * const * args, std::size_t count)
+{
+    ArgArray const arr = { args };
+    format_impl (out, fmt, arr, count);
+}
+
+
+//
+// DeferredMessage
+//
+
+
+namespace
+{
+
+
+//! Adapts captured arguments of DeferredMessage for format_impl().
+template <typename Arg>
+struct CapturedArgs
+{
+    Arg const * args;
+    tchar const * text;
+
+    void
+    append (tstring & out, std::size_t i) const
+    {
+        Arg const & a = args[i];
+        switch (a.type)
+        {
+        case FormatArg::LONG:
+            append_long (out, a.value.l);
+            break;
+
+        case FormatArg::ULONG:
+            append_ulong (out, a.value.ul);
+            break;
+
+        case FormatArg::DOUBLE:
+            append_double (out, a.value.d);
+            break;
+
+        case FormatArg::BOOL:
+            append_arg (out, FormatArg (a.value.b));
+            break;
+
+        case FormatArg::CHAR:
+            out.push_back (a.value.c);
+            break;
+
+        case FormatArg::LITERAL:
+            append_arg (out, FormatArg (literal (a.value.cstr)));
+            break;
+
+        default:
+            out.append (text + a.value.text.off, a.value.text.len);
+            break;
+        }
+    }
+};
+
+
+} // namespace
+
+
+void
+DeferredMessage::init (tchar const * fmt_, FormatArg const * const * a,
+    std::size_t n)
+{
+    fmt = fmt_;
+    count = (std::min) (n, static_cast<std::size_t>(MAX_ARGS));
+    text = inline_text;
+    text_size = 0;
+
+    // Values of streamable types are written here first, the other
+    // strings are copied directly.
+    tstring streamed;
+    std::size_t streamed_off[MAX_ARGS];
+
+    // First pass captures scalars and sums lengths of the strings.
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        FormatArg const & arg = *a[i];
+        Arg & dst = args[i];
+        dst.type = arg.type;
+        switch (arg.type)
+        {
+        case FormatArg::LONG:
+            dst.value.l = arg.value.l;
+            continue;
+
+        case FormatArg::ULONG:
+            dst.value.ul = arg.value.ul;
+            continue;
+
+        case FormatArg::DOUBLE:
+            dst.value.d = arg.value.d;
+            continue;
+
+        case FormatArg::BOOL:
+            dst.value.b = arg.value.b;
+            continue;
+
+        case FormatArg::CHAR:
+            dst.value.c = arg.value.c;
+            continue;
+
+        case FormatArg::LITERAL:
+            dst.value.cstr = arg.value.cstr;
+            continue;
+
+        case FormatArg::CSTR:
+            if (! arg.value.cstr)
+            {
+                // Renders as "(null)".
+                dst.type = FormatArg::LITERAL;
+                dst.value.cstr = 0;
+                continue;
+            }
+            dst.value.text.len = tstring::traits_type::length (
+                arg.value.cstr);
+            break;
+
+        case FormatArg::STR:
+            dst.value.text.len = arg.value.str->size ();
+            break;
+
+        case FormatArg::TEXT:
+            dst.value.text.len = arg.value.text.len;
+            break;
+
+        case FormatArg::STREAMABLE:
+            streamed_off[i] = streamed.size ();
+            append_arg (streamed, arg);
+            dst.value.text.len = streamed.size () - streamed_off[i];
+            break;
+        }
+
+        dst.type = FormatArg::TEXT;
+        dst.value.text.off = text_size;
+        text_size += dst.value.text.len;
+    }
+
+    if (text_size > INLINE_TEXT)
+        text = new tchar[text_size];
+
+    // Second pass copies the strings.
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        Arg const & dst = args[i];
+        if (dst.type != FormatArg::TEXT)
+            continue;
+
+        FormatArg const & arg = *a[i];
+        tchar const * src;
+        switch (arg.type)
+        {
+        case FormatArg::CSTR:
+            src = arg.value.cstr;
+            break;
+
+        case FormatArg::STR:
+            src = arg.value.str->data ();
+            break;
+
+        case FormatArg::TEXT:
+            src = arg.value.text.ptr;
+            break;
+
+        default:
+            src = streamed.data () + streamed_off[i];
+            break;
+        }
+
+        std::copy (src, src + dst.value.text.len,
+            text + dst.value.text.off);
+    }
+}
+
+
+DeferredMessage::DeferredMessage (DeferredMessage const & other)
+    : fmt (other.fmt)
+    , count (other.count)
+    , text (inline_text)
+    , text_size (other.text_size)
+{
+    std::copy (other.args, other.args + count, args);
+    if (text_size > INLINE_TEXT)
+        text = new tchar[text_size];
+    std::copy (other.text, other.text + text_size, text);
+}
+
+
+DeferredMessage::~DeferredMessage ()
+{
+    if (text != inline_text)
+        delete[] text;
+}
+
+
+void
+DeferredMessage::render (tstring & out) const
+{
+    CapturedArgs<Arg> const captured = { args, text };
+    format_impl (out, fmt, captured, count);
+}
+
+
+} } // namespace log4cplus { namespace helpers {
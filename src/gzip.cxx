@@ -0,0 +1,732 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/gzip.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+
+std::size_t const WINDOW_SIZE = 32768;
+std::size_t const WINDOW_MASK = WINDOW_SIZE - 1;
+std::size_t const MIN_MATCH = 3;
+std::size_t const MAX_MATCH = 258;
+std::size_t const HASH_SIZE = 1 << 15;
+//! Symbols per block; pairs of distance and literal or length.
+std::size_t const BLOCK_SYMBOLS = 16384;
+int const NIL = -1;
+
+unsigned const LITERALS = 256;
+unsigned const END_OF_BLOCK = 256;
+unsigned const LENGTH_CODES = 29;
+unsigned const LITLEN_CODES = LITERALS + 1 + LENGTH_CODES;
+//! The fixed code has two more, unused, literal/length codes. They
+//! take part in the construction of the other codes.
+unsigned const FIXED_LITLEN_CODES = LITLEN_CODES + 2;
+unsigned const DIST_CODES = 30;
+unsigned const CODELEN_CODES = 19;
+unsigned const MAX_BITS = 15;
+unsigned const MAX_CODELEN_BITS = 7;
+
+
+unsigned short const length_base[LENGTH_CODES] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51,
+    59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+
+unsigned char const length_extra[LENGTH_CODES] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
+    4, 5, 5, 5, 5, 0 };
+
+unsigned short const dist_base[DIST_CODES] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+    513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385,
+    24577 };
+
+unsigned char const dist_extra[DIST_CODES] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10,
+    10, 11, 11, 12, 12, 13, 13 };
+
+//! Match search parameters for each compression level.
+struct LevelConfig
+{
+    //! Maximal number of hash chain entries tried for a match.
+    unsigned max_chain;
+    //! Match length that is good enough to stop searching.
+    unsigned short nice_match;
+    //! Positions inside longer matches are not inserted into the hash
+    //! chains.
+    unsigned short max_insert;
+};
+
+LevelConfig const level_config[9] = {
+    {    4,   8,       4 },
+    {    6,  16,       5 },
+    {    8,  32,       6 },
+    {   16,  32, MAX_MATCH },
+    {   32,  64, MAX_MATCH },
+    {   64, 128, MAX_MATCH },
+    {  128, 128, MAX_MATCH },
+    {  256, 258, MAX_MATCH },
+    { 1024, 258, MAX_MATCH } };
+
+
+LevelConfig const &
+get_level_config (int level)
+{
+    return level_config[(std::max) (1, (std::min) (level, 9)) - 1];
+}
+
+//! Order of code length code lengths in dynamic block header.
+unsigned char const codelen_order[CODELEN_CODES] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+//! Tables computed once at start up.
+struct Tables
+{
+    Tables ();
+
+    //! CRC-32 of each byte value followed by zero to three zero
+    //! bytes, for computing the CRC four bytes at a time.
+    unsigned long crc[4][256];
+    //! Length code index for match length minus MIN_MATCH.
+    unsigned char length_code[256];
+    //! Distance code index for distances 1 to 256, then for distances
+    //! above 256 in steps of 128; see dist_code().
+    unsigned char dist_code[512];
+    //! Code lengths of the fixed Huffman code.
+    unsigned char fixed_litlen[FIXED_LITLEN_CODES];
+    unsigned char fixed_dist[DIST_CODES];
+};
+
+
+Tables::Tables ()
+{
+    for (unsigned n = 0; n != 256; ++n)
+    {
+        unsigned long c = n;
+        for (int k = 0; k != 8; ++k)
+            c = (c & 1) ? 0xedb88320UL ^ (c >> 1) : c >> 1;
+        crc[0][n] = c;
+    }
+    for (unsigned n = 0; n != 256; ++n)
+        for (int k = 1; k != 4; ++k)
+            crc[k][n] = crc[0][crc[k - 1][n] & 0xff] ^ (crc[k - 1][n] >> 8);
+
+    for (unsigned code = 0; code != LENGTH_CODES - 1; ++code)
+        for (unsigned i = 0; i != (1u << length_extra[code]); ++i)
+            length_code[length_base[code] - MIN_MATCH + i]
+                = static_cast<unsigned char>(code);
+    // Length 258 has its own code.
+    length_code[MAX_MATCH - MIN_MATCH] = LENGTH_CODES - 1;
+
+    for (unsigned code = 0; code != DIST_CODES; ++code)
+        for (unsigned i = 0; i != (1u << dist_extra[code]); ++i)
+        {
+            unsigned const d = dist_base[code] - 1 + i;
+            if (d < 256)
+                dist_code[d] = static_cast<unsigned char>(code);
+            else if (d % 128 == 0)
+                dist_code[256 + (d >> 7)] = static_cast<unsigned char>(code);
+        }
+
+    for (unsigned i = 0; i != FIXED_LITLEN_CODES; ++i)
+        fixed_litlen[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    std::fill (fixed_dist, fixed_dist + DIST_CODES, 5);
+}
+
+
+Tables const tables;
+
+
+//! Codes of distances above 256 start at multiples of 128 plus one.
+inline
+unsigned
+dist_code (unsigned dist)
+{
+    unsigned const d = dist - 1;
+    return d < 256 ? tables.dist_code[d] : tables.dist_code[256 + (d >> 7)];
+}
+
+
+//! Computes Huffman code lengths limited to max_bits from symbol
+//! frequencies. Over-long codes are shortened the way miniz does it,
+//! by moving leaves up the tree until the Kraft sum is one again.
+static
+void
+build_lengths (unsigned const * freq, unsigned n, unsigned max_bits,
+    unsigned char * lens)
+{
+    std::fill (lens, lens + n, 0);
+
+    std::vector<std::pair<unsigned, unsigned> > leaves;
+    for (unsigned i = 0; i != n; ++i)
+        if (freq[i] != 0)
+            leaves.push_back (std::make_pair (freq[i], i));
+
+    // A code needs two symbols at least to be complete.
+    for (unsigned i = 0; leaves.size () < 2; ++i)
+        if (freq[i] == 0)
+            leaves.push_back (std::make_pair (1u, i));
+
+    std::sort (leaves.begin (), leaves.end ());
+
+    // Two queue Huffman construction: leaves are sorted and internal
+    // nodes are created in non-decreasing weight order.
+    std::size_t const count = leaves.size ();
+    std::vector<unsigned long> weight (2 * count - 1);
+    std::vector<std::size_t> parent (2 * count - 1);
+    for (std::size_t i = 0; i != count; ++i)
+        weight[i] = leaves[i].first;
+
+    std::size_t leaf = 0;
+    std::size_t node = count;
+    for (std::size_t next = count; next != 2 * count - 1; ++next)
+    {
+        std::size_t picked[2];
+        for (int k = 0; k != 2; ++k)
+        {
+            if (leaf != count && (node == next || weight[leaf] <= weight[node]))
+                picked[k] = leaf++;
+            else
+                picked[k] = node++;
+        }
+        weight[next] = weight[picked[0]] + weight[picked[1]];
+        parent[picked[0]] = parent[picked[1]] = next;
+    }
+
+    // Depths, the root is the last node.
+    std::vector<unsigned> depth (2 * count - 1);
+    unsigned bl_count[MAX_BITS + 1] = { 0 };
+    for (std::size_t i = 2 * count - 2; i-- != 0; )
+    {
+        depth[i] = depth[parent[i]] + 1;
+        if (i < count)
+            ++bl_count[(std::min) (depth[i], max_bits)];
+    }
+
+    unsigned long total = 0;
+    for (unsigned bits = 1; bits <= max_bits; ++bits)
+        total += static_cast<unsigned long>(bl_count[bits])
+            << (max_bits - bits);
+    while (total != (1UL << max_bits))
+    {
+        --bl_count[max_bits];
+        for (unsigned bits = max_bits - 1; bits != 0; --bits)
+            if (bl_count[bits] != 0)
+            {
+                --bl_count[bits];
+                bl_count[bits + 1] += 2;
+                break;
+            }
+        --total;
+    }
+
+    // The least frequent symbols get the longest codes.
+    std::size_t i = 0;
+    for (unsigned bits = max_bits; bits != 0; --bits)
+        for (unsigned k = bl_count[bits]; k != 0; --k)
+            lens[leaves[i++].second] = static_cast<unsigned char>(bits);
+}
+
+
+//! Computes canonical codes from code lengths. The codes are bit
+//! reversed because deflate packs them starting with the most
+//! significant bit into the least significant bits of bytes.
+static
+void
+build_codes (unsigned char const * lens, unsigned n, unsigned short * codes)
+{
+    unsigned bl_count[MAX_BITS + 1] = { 0 };
+    for (unsigned i = 0; i != n; ++i)
+        ++bl_count[lens[i]];
+    bl_count[0] = 0;
+
+    unsigned next_code[MAX_BITS + 1];
+    unsigned code = 0;
+    for (unsigned bits = 1; bits <= MAX_BITS; ++bits)
+    {
+        code = (code + bl_count[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+
+    for (unsigned i = 0; i != n; ++i)
+    {
+        unsigned const len = lens[i];
+        if (len == 0)
+            continue;
+
+        unsigned c = next_code[len]++;
+        unsigned reversed = 0;
+        for (unsigned k = 0; k != len; ++k, c >>= 1)
+            reversed = (reversed << 1) | (c & 1);
+        codes[i] = static_cast<unsigned short>(reversed);
+    }
+}
+
+
+//! Encodes the code lengths of a dynamic block header with the run
+//! length codes 16, 17 and 18.
+//! @param rle Receives pairs of code length code and its extra bits.
+static
+void
+encode_lengths (std::vector<unsigned char> const & lens,
+    std::vector<unsigned char> & rle)
+{
+    std::size_t i = 0;
+    while (i != lens.size ())
+    {
+        unsigned char const len = lens[i];
+        std::size_t run = 1;
+        while (i + run != lens.size () && lens[i + run] == len)
+            ++run;
+        i += run;
+
+        if (len == 0)
+        {
+            for (; run >= 11; run -= (std::min) (run, std::size_t (138)))
+            {
+                rle.push_back (18);
+                rle.push_back (static_cast<unsigned char>(
+                    (std::min) (run, std::size_t (138)) - 11));
+            }
+            if (run >= 3)
+            {
+                rle.push_back (17);
+                rle.push_back (static_cast<unsigned char>(run - 3));
+                run = 0;
+            }
+        }
+        else
+        {
+            rle.push_back (len);
+            rle.push_back (0);
+            --run;
+            for (; run >= 3; run -= (std::min) (run, std::size_t (6)))
+            {
+                rle.push_back (16);
+                rle.push_back (static_cast<unsigned char>(
+                    (std::min) (run, std::size_t (6)) - 3));
+            }
+        }
+
+        for (; run != 0; --run)
+        {
+            rle.push_back (len);
+            rle.push_back (0);
+        }
+    }
+}
+
+
+unsigned
+codelen_extra (unsigned code)
+{
+    return code == 16 ? 2 : code == 17 ? 3 : code == 18 ? 7 : 0;
+}
+
+
+} // namespace
+
+
+GzipCompressor::GzipCompressor (int level)
+    : maxChain (get_level_config (level).max_chain)
+    , niceMatch (get_level_config (level).nice_match)
+    , maxInsert (get_level_config (level).max_insert)
+    , window (2 * WINDOW_SIZE)
+    , head (HASH_SIZE, NIL)
+    , prev (WINDOW_SIZE, NIL)
+{
+    symbols.reserve (2 * BLOCK_SYMBOLS);
+    reset ();
+}
+
+
+GzipCompressor::~GzipCompressor ()
+{ }
+
+
+void
+GzipCompressor::write (char const * data, std::size_t len,
+    std::string & out)
+{
+    if (! started)
+        writeHeader (out);
+
+    unsigned char const * p = reinterpret_cast<unsigned char const *>(data);
+    std::size_t i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        unsigned long const c = crc ^ (p[i] | (p[i + 1] << 8)
+            | (p[i + 2] << 16) | (static_cast<unsigned long>(p[i + 3]) << 24));
+        crc = tables.crc[3][c & 0xff] ^ tables.crc[2][(c >> 8) & 0xff]
+            ^ tables.crc[1][(c >> 16) & 0xff] ^ tables.crc[0][(c >> 24) & 0xff];
+    }
+    for (; i != len; ++i)
+        crc = tables.crc[0][(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    inputSize = (inputSize + len) & 0xffffffffUL;
+    if (len != 0)
+        flushed = false;
+
+    while (len != 0)
+    {
+        if (end == window.size ())
+        {
+            deflate (false, out);
+            slide ();
+        }
+
+        std::size_t const n = (std::min) (len, window.size () - end);
+        std::memcpy (&window[end], p, n);
+        end += n;
+        p += n;
+        len -= n;
+    }
+
+    deflate (false, out);
+}
+
+
+void
+GzipCompressor::flush (std::string & out)
+{
+    if (flushed)
+        return;
+
+    deflate (true, out);
+    if (! symbols.empty ())
+        writeBlock (false, out);
+
+    // Empty stored block: BFINAL 0, BTYPE 00, LEN 0, NLEN 0xffff.
+    putBits (0, 3, out);
+    alignToByte (out);
+    out.append ("\0\0\xff\xff", 4);
+    flushed = true;
+}
+
+
+void
+GzipCompressor::finish (std::string & out)
+{
+    if (! started)
+        writeHeader (out);
+
+    deflate (true, out);
+    writeBlock (true, out);
+    alignToByte (out);
+
+    unsigned long const sum = crc ^ 0xffffffffUL;
+    for (int i = 0; i != 4; ++i)
+        out += static_cast<char>((sum >> (8 * i)) & 0xff);
+    for (int i = 0; i != 4; ++i)
+        out += static_cast<char>((inputSize >> (8 * i)) & 0xff);
+
+    reset ();
+}
+
+
+void
+GzipCompressor::deflate (bool all, std::string & out)
+{
+    while (pos != end)
+    {
+        std::size_t const avail = end - pos;
+        if (avail < MAX_MATCH && ! all)
+            break;
+
+        std::size_t best_len = 0;
+        std::size_t best_dist = 0;
+        if (avail >= MIN_MATCH)
+        {
+            std::size_t const max_len = (std::min) (avail, MAX_MATCH);
+            std::size_t const limit = pos > WINDOW_SIZE ? pos - WINDOW_SIZE : 0;
+            unsigned char const * const cur = &window[pos];
+            unsigned chain = maxChain;
+
+            int cand = head[((cur[0] << 10) ^ (cur[1] << 5) ^ cur[2])
+                & (HASH_SIZE - 1)];
+            while (cand != NIL && static_cast<std::size_t>(cand) >= limit
+                && chain-- != 0)
+            {
+                unsigned char const * const match = &window[cand];
+                if (match[best_len] == cur[best_len])
+                {
+                    std::size_t len = 0;
+                    while (len != max_len && match[len] == cur[len])
+                        ++len;
+                    if (len > best_len)
+                    {
+                        best_len = len;
+                        best_dist = pos - cand;
+                        if (len >= niceMatch || len == max_len)
+                            break;
+                    }
+                }
+
+                // Entries of the chain are older and older positions;
+                // anything else is a slot that has been reused.
+                int const next = prev[cand & WINDOW_MASK];
+                if (next >= cand)
+                    break;
+                cand = next;
+            }
+
+            insert (pos);
+        }
+
+        // Short matches far away do not pay off.
+        if (best_len >= MIN_MATCH && ! (best_len == MIN_MATCH
+                && best_dist > 4096))
+        {
+            symbols.push_back (static_cast<unsigned short>(best_dist));
+            symbols.push_back (static_cast<unsigned short>(best_len));
+            if (best_len <= maxInsert)
+                for (std::size_t k = 1; k != best_len; ++k)
+                    if (pos + k + MIN_MATCH <= end)
+                        insert (pos + k);
+            pos += best_len;
+        }
+        else
+        {
+            symbols.push_back (0);
+            symbols.push_back (window[pos]);
+            ++pos;
+        }
+
+        if (symbols.size () >= 2 * BLOCK_SYMBOLS)
+            writeBlock (false, out);
+    }
+}
+
+
+void
+GzipCompressor::slide ()
+{
+    std::memmove (&window[0], &window[WINDOW_SIZE], end - WINDOW_SIZE);
+    pos -= WINDOW_SIZE;
+    end -= WINDOW_SIZE;
+
+    // Positions below the window size, and NIL, all become NIL.
+    int const size = static_cast<int>(WINDOW_SIZE);
+    for (std::vector<int>::iterator it = head.begin (); it != head.end (); ++it)
+        *it = (std::max) (*it - size, NIL);
+    for (std::vector<int>::iterator it = prev.begin (); it != prev.end (); ++it)
+        *it = (std::max) (*it - size, NIL);
+}
+
+
+void
+GzipCompressor::insert (std::size_t p)
+{
+    unsigned const h = ((window[p] << 10) ^ (window[p + 1] << 5)
+        ^ window[p + 2]) & (HASH_SIZE - 1);
+    prev[p & WINDOW_MASK] = head[h];
+    head[h] = static_cast<int>(p);
+}
+
+
+void
+GzipCompressor::writeBlock (bool last, std::string & out)
+{
+    unsigned litlen_freq[LITLEN_CODES] = { 0 };
+    unsigned dist_freq[DIST_CODES] = { 0 };
+    for (std::size_t i = 0; i != symbols.size (); i += 2)
+    {
+        if (symbols[i] == 0)
+            ++litlen_freq[symbols[i + 1]];
+        else
+        {
+            ++litlen_freq[LITERALS + 1
+                + tables.length_code[symbols[i + 1] - MIN_MATCH]];
+            ++dist_freq[dist_code (symbols[i])];
+        }
+    }
+    litlen_freq[END_OF_BLOCK] = 1;
+
+    unsigned char litlen_lens[LITLEN_CODES];
+    unsigned char dist_lens[DIST_CODES];
+    build_lengths (litlen_freq, LITLEN_CODES, MAX_BITS, litlen_lens);
+    build_lengths (dist_freq, DIST_CODES, MAX_BITS, dist_lens);
+
+    unsigned hlit = LITLEN_CODES;
+    while (hlit > LITERALS + 1 && litlen_lens[hlit - 1] == 0)
+        --hlit;
+    unsigned hdist = DIST_CODES;
+    while (hdist > 1 && dist_lens[hdist - 1] == 0)
+        --hdist;
+
+    std::vector<unsigned char> lens (litlen_lens, litlen_lens + hlit);
+    lens.insert (lens.end (), dist_lens, dist_lens + hdist);
+    std::vector<unsigned char> rle;
+    encode_lengths (lens, rle);
+
+    unsigned codelen_freq[CODELEN_CODES] = { 0 };
+    for (std::size_t i = 0; i != rle.size (); i += 2)
+        ++codelen_freq[rle[i]];
+    unsigned char codelen_lens[CODELEN_CODES];
+    build_lengths (codelen_freq, CODELEN_CODES, MAX_CODELEN_BITS,
+        codelen_lens);
+
+    unsigned hclen = CODELEN_CODES;
+    while (hclen > 4 && codelen_lens[codelen_order[hclen - 1]] == 0)
+        --hclen;
+
+    // Compare sizes of the dynamic and the fixed code. Extra bits of
+    // lengths and distances are the same for both and are left out.
+    unsigned long dynamic_bits = 5 + 5 + 4 + 3 * hclen;
+    for (std::size_t i = 0; i != rle.size (); i += 2)
+        dynamic_bits += codelen_lens[rle[i]] + codelen_extra (rle[i]);
+    unsigned long fixed_bits = 0;
+    for (unsigned i = 0; i != LITLEN_CODES; ++i)
+    {
+        dynamic_bits += static_cast<unsigned long>(litlen_freq[i])
+            * litlen_lens[i];
+        fixed_bits += static_cast<unsigned long>(litlen_freq[i])
+            * tables.fixed_litlen[i];
+    }
+    for (unsigned i = 0; i != DIST_CODES; ++i)
+    {
+        dynamic_bits += static_cast<unsigned long>(dist_freq[i])
+            * dist_lens[i];
+        fixed_bits += static_cast<unsigned long>(dist_freq[i])
+            * tables.fixed_dist[i];
+    }
+
+    unsigned char const * litlen_used = litlen_lens;
+    unsigned litlen_count = LITLEN_CODES;
+    unsigned char const * dist_used = dist_lens;
+    putBits (last ? 1 : 0, 1, out);
+    if (fixed_bits <= dynamic_bits)
+    {
+        putBits (1, 2, out);
+        litlen_used = tables.fixed_litlen;
+        litlen_count = FIXED_LITLEN_CODES;
+        dist_used = tables.fixed_dist;
+    }
+    else
+    {
+        putBits (2, 2, out);
+        putBits (hlit - 257, 5, out);
+        putBits (hdist - 1, 5, out);
+        putBits (hclen - 4, 4, out);
+        for (unsigned i = 0; i != hclen; ++i)
+            putBits (codelen_lens[codelen_order[i]], 3, out);
+
+        unsigned short codelen_codes[CODELEN_CODES];
+        build_codes (codelen_lens, CODELEN_CODES, codelen_codes);
+        for (std::size_t i = 0; i != rle.size (); i += 2)
+        {
+            putBits (codelen_codes[rle[i]], codelen_lens[rle[i]], out);
+            putBits (rle[i + 1], codelen_extra (rle[i]), out);
+        }
+    }
+
+    unsigned short litlen_codes[FIXED_LITLEN_CODES];
+    unsigned short dist_codes[DIST_CODES];
+    build_codes (litlen_used, litlen_count, litlen_codes);
+    build_codes (dist_used, DIST_CODES, dist_codes);
+
+    for (std::size_t i = 0; i != symbols.size (); i += 2)
+    {
+        unsigned const dist = symbols[i];
+        unsigned const value = symbols[i + 1];
+        if (dist == 0)
+        {
+            putBits (litlen_codes[value], litlen_used[value], out);
+            continue;
+        }
+
+        unsigned const lc = tables.length_code[value - MIN_MATCH];
+        putBits (litlen_codes[LITERALS + 1 + lc],
+            litlen_used[LITERALS + 1 + lc], out);
+        putBits (value - length_base[lc], length_extra[lc], out);
+
+        unsigned const dc = dist_code (dist);
+        putBits (dist_codes[dc], dist_used[dc], out);
+        putBits (dist - dist_base[dc], dist_extra[dc], out);
+    }
+    putBits (litlen_codes[END_OF_BLOCK], litlen_used[END_OF_BLOCK], out);
+
+    symbols.clear ();
+}
+
+
+void
+GzipCompressor::writeHeader (std::string & out)
+{
+    // Magic, CM deflate, no flags, no time stamp, no extra flags and
+    // unknown OS.
+    out.append ("\x1f\x8b\x08\0\0\0\0\0\0\xff", 10);
+    started = true;
+}
+
+
+void
+GzipCompressor::putBits (unsigned long value, unsigned count,
+    std::string & out)
+{
+    bitBuffer |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8)
+    {
+        out += static_cast<char>(bitBuffer & 0xff);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+
+void
+GzipCompressor::alignToByte (std::string & out)
+{
+    if (bitCount != 0)
+        out += static_cast<char>(bitBuffer & 0xff);
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+
+void
+GzipCompressor::reset ()
+{
+    pos = 0;
+    end = 0;
+    std::fill (head.begin (), head.end (), NIL);
+    std::fill (prev.begin (), prev.end (), NIL);
+    symbols.clear ();
+    bitBuffer = 0;
+    bitCount = 0;
+    crc = 0xffffffffUL;
+    inputSize = 0;
+    started = false;
+    flushed = true;
+}
+
+
+} } // namespace log4cplus { namespace helpers {
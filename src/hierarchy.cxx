@@ -67,6 +67,7 @@ Hierarchy::Hierarchy()
     defaultFactory(new DefaultLoggerFactory()),
     root(NULL),
     disableValue(DISABLE_OFF),  // Don't disable any LogLevel level by default.
+    generation(1),
     emittedNoAppenderWarning(false),
     emittedNoResourceBundleWarning(false)
 {
@@ -92,6 +93,7 @@ Hierarchy::clear()
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( hashtable_mutex )
         provisionNodes.erase(provisionNodes.begin(), provisionNodes.end());
         loggerPtrs.erase(loggerPtrs.begin(), loggerPtrs.end());
+        bumpGeneration();
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
 }
 
@@ -111,6 +113,7 @@ Hierarchy::disable(const log4cplus::tstring& loglevelStr)
 {
     if(disableValue != DISABLE_OVERRIDE) {
         disableValue = getLogLevelManager().fromString(loglevelStr);
+        bumpGeneration();
     }
 }
 
@@ -120,6 +123,7 @@ Hierarchy::disable(LogLevel ll)
 {
     if(disableValue != DISABLE_OVERRIDE) {
         disableValue = ll;
+        bumpGeneration();
     }
 }
 
@@ -149,6 +153,7 @@ void
 Hierarchy::enableAll() 
 { 
     disableValue = DISABLE_OFF; 
+    bumpGeneration();
 }
 
 
@@ -200,6 +205,7 @@ Hierarchy::resetConfiguration()
 {
     getRoot().setLogLevel(DEBUG_LOG_LEVEL);
     disableValue = DISABLE_OFF;
+    bumpGeneration();
 
     shutdown();
 
@@ -332,6 +338,8 @@ Hierarchy::updateParents(Logger logger)
     if(!parentFound) {
         logger.value->parent = root.value;
     }
+
+    bumpGeneration();
 }
 
 
@@ -348,5 +356,18 @@ Hierarchy::updateChildren(ProvisionNode& pn, Logger logger)
             c.value->parent = logger.value;
         }
     }
+
+    bumpGeneration();
+}
+
+
+void 
+Hierarchy::bumpGeneration()
+{
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    LOG4CPLUS_ATOMIC_INCREMENT (generation);
+#else
+    generation = generation + 1;
+#endif
 }
 
@@ -19,10 +19,79 @@
 // limitations under the License.
 
 #include <log4cplus/layout.h>
+#include <log4cplus/loggingmacros.h>
 #include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/thread-config.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/spi/loggingevent.h>
-#include <iomanip>
+#include <typeinfo>
+
+
+namespace
+{
+
+//! Layouts format into a tostream through a buffer cached per thread.
+static
+void
+delete_output_buffer (void * p)
+{
+    delete static_cast<log4cplus::tstring *>(p);
+}
+
+
+static
+LOG4CPLUS_THREAD_LOCAL_TYPE &
+get_output_buffer_key ()
+{
+    static LOG4CPLUS_THREAD_LOCAL_TYPE key
+        = LOG4CPLUS_THREAD_LOCAL_INIT (delete_output_buffer);
+    return key;
+}
+
+
+//! Takes the buffer of this thread for the lifetime of the holder.
+class OutputBufferHolder
+{
+public:
+    OutputBufferHolder ()
+    {
+        LOG4CPLUS_THREAD_LOCAL_TYPE & key = get_output_buffer_key ();
+        buffer = static_cast<log4cplus::tstring *>(
+            LOG4CPLUS_GET_THREAD_LOCAL_VALUE (key));
+        if (buffer)
+            LOG4CPLUS_SET_THREAD_LOCAL_VALUE (key, 0);
+        else
+            buffer = new log4cplus::tstring;
+    }
+
+    ~OutputBufferHolder ()
+    {
+        if (buffer->capacity () > max_buffer_capacity)
+            log4cplus::tstring ().swap (*buffer);
+        else
+            buffer->clear ();
+
+        LOG4CPLUS_THREAD_LOCAL_TYPE & key = get_output_buffer_key ();
+        if (LOG4CPLUS_GET_THREAD_LOCAL_VALUE (key))
+            delete buffer;
+        else
+            LOG4CPLUS_SET_THREAD_LOCAL_VALUE (key, buffer);
+    }
+
+    log4cplus::tstring & get () { return *buffer; }
+
+private:
+    //! Larger buffers are not kept.
+    static std::size_t const max_buffer_capacity = 64 * 1024;
+
+    log4cplus::tstring * buffer;
+
+    OutputBufferHolder (OutputBufferHolder const &);
+    OutputBufferHolder & operator = (OutputBufferHolder const &);
+};
+
+
+} // namespace
 
 
 namespace log4cplus
@@ -39,6 +108,40 @@ initializeLayout ()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::Layout methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+Layout::formatAndAppend(log4cplus::tstring& output, 
+                        const log4cplus::spi::InternalLoggingEvent& event)
+{
+    _macros_oss_holder holder;
+    formatAndAppend(holder.stream(), event);
+    output += holder.str();
+}
+
+
+void
+Layout::formatAndWrite(log4cplus::tostream& output, 
+                       const log4cplus::spi::InternalLoggingEvent& event)
+{
+    OutputBufferHolder holder;
+    log4cplus::tstring& buffer = holder.get();
+    appendFormatted(buffer, event);
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+
+void
+Layout::appendFormatted(log4cplus::tstring& output, 
+                        const log4cplus::spi::InternalLoggingEvent& event)
+{
+    formatAndAppend(output, event);
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::SimpleLayout public methods
 ///////////////////////////////////////////////////////////////////////////////
@@ -47,10 +150,30 @@ void
 SimpleLayout::formatAndAppend(log4cplus::tostream& output, 
                               const log4cplus::spi::InternalLoggingEvent& event)
 {
-    output << llmCache.toString(event.getLogLevel()) 
-           << LOG4CPLUS_TEXT(" - ")
-           << event.getMessage() 
-           << LOG4CPLUS_TEXT("\n");
+    formatAndWrite(output, event);
+}
+
+
+void
+SimpleLayout::formatAndAppend(log4cplus::tstring& output, 
+                              const log4cplus::spi::InternalLoggingEvent& event)
+{
+    // Derived layouts may override only the stream overload.
+    if (typeid(*this) == typeid(SimpleLayout))
+        appendFormatted(output, event);
+    else
+        Layout::formatAndAppend(output, event);
+}
+
+
+void
+SimpleLayout::appendFormatted(log4cplus::tstring& output, 
+                              const log4cplus::spi::InternalLoggingEvent& event)
+{
+    output += llmCache.toString(event.getLogLevel());
+    output += LOG4CPLUS_TEXT(" - ");
+    output += event.getMessage();
+    output += LOG4CPLUS_TEXT('\n');
 }
 
 
@@ -93,34 +216,67 @@ TTCCLayout::~TTCCLayout()
 void
 TTCCLayout::formatAndAppend(log4cplus::tostream& output, 
                             const log4cplus::spi::InternalLoggingEvent& event)
+{
+    formatAndWrite(output, event);
+}
+
+
+void
+TTCCLayout::formatAndAppend(log4cplus::tstring& output, 
+                            const log4cplus::spi::InternalLoggingEvent& event)
+{
+    // Derived layouts may override only the stream overload.
+    if (typeid(*this) == typeid(TTCCLayout))
+        appendFormatted(output, event);
+    else
+        Layout::formatAndAppend(output, event);
+}
+
+
+void
+TTCCLayout::appendFormatted(log4cplus::tstring& output, 
+                            const log4cplus::spi::InternalLoggingEvent& event)
 {
     if (dateFormat.empty ())
     {
         helpers::Time const rel_time = event.getTimestamp () - TTCCLayout_time_base;
-        tchar const old_fill = output.fill ();
         helpers::time_t const sec = rel_time.sec ();
+        long const msec = rel_time.usec () / 1000;
 
         if (sec != 0)
-            output << sec << std::setfill (LOG4CPLUS_TEXT ('0'))
-                   << std::setw (3);
+        {
+            output += helpers::convertIntegerToString (sec);
+            if (msec < 100)
+                output += LOG4CPLUS_TEXT ('0');
+            if (msec < 10)
+                output += LOG4CPLUS_TEXT ('0');
+        }
 
-        output << rel_time.usec () / 1000;
-        output.fill (old_fill);
+        output += helpers::convertIntegerToString (msec);
     }
     else
-        output << event.getTimestamp().getFormattedTime(dateFormat, use_gmtime);
-
-    output << LOG4CPLUS_TEXT(" [")
-           << event.getThread()
-           << LOG4CPLUS_TEXT("] ")
-           << llmCache.toString(event.getLogLevel()) 
-           << LOG4CPLUS_TEXT(" ")
-           << event.getLoggerName()
-           << LOG4CPLUS_TEXT(" <")
-           << event.getNDC() 
-           << LOG4CPLUS_TEXT("> - ")
-           << event.getMessage()
-           << LOG4CPLUS_TEXT("\n");
+    {
+        // Subclasses may change the format after construction.
+        if (! formatter.get ()
+            || formatter->getFormat () != dateFormat
+            || formatter->getUseGMTime () != use_gmtime)
+            formatter.reset (new helpers::TimeFormatter (dateFormat,
+                use_gmtime));
+
+        formatter->appendFormattedTime (output, event.getTimestamp ());
+    }
+
+    output += LOG4CPLUS_TEXT(" [");
+    output += event.getThread();
+    output += LOG4CPLUS_TEXT("] ");
+    output += llmCache.toString(event.getLogLevel());
+    output += LOG4CPLUS_TEXT(' ');
+    output += event.getLoggerName();
+    output += LOG4CPLUS_TEXT(" <");
+    output += event.getNDC();
+    output += LOG4CPLUS_TEXT("> - ");
+    output += event.getMessage();
+    output += LOG4CPLUS_TEXT('\n');
 }
 
 
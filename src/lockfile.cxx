@@ -0,0 +1,114 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/lockfile.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/streams.h>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+LockFile::LockFile (tstring const & name)
+    : filename (name)
+    , fd (-1)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    int oflags = O_RDWR | O_CREAT;
+#if defined (O_CLOEXEC)
+    oflags |= O_CLOEXEC;
+#endif
+
+    std::string const fname (LOG4CPLUS_TSTRING_TO_STRING (name));
+    do
+        fd = ::open (fname.c_str (), oflags, 0666);
+    while (fd == -1 && errno == EINTR);
+
+    if (fd == -1)
+        reportError (LOG4CPLUS_TEXT ("open"), errno);
+
+#else
+    getLogLog ().error (
+        LOG4CPLUS_TEXT ("LockFile: lock files are not supported")
+        LOG4CPLUS_TEXT (" on this platform"));
+
+#endif
+}
+
+
+LockFile::~LockFile ()
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    if (fd != -1)
+        ::close (fd);
+#endif
+}
+
+
+void
+LockFile::lock ()
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    if (fd == -1)
+        return;
+
+    int ret;
+    do
+        ret = ::flock (fd, LOCK_EX);
+    while (ret == -1 && errno == EINTR);
+
+    if (ret == -1)
+        reportError (LOG4CPLUS_TEXT ("flock"), errno);
+#endif
+}
+
+
+void
+LockFile::unlock ()
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    if (fd != -1 && ::flock (fd, LOCK_UN) == -1)
+        reportError (LOG4CPLUS_TEXT ("flock"), errno);
+#endif
+}
+
+
+void
+LockFile::reportError (tchar const * func, int err)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT ("LockFile: ") << func
+        << LOG4CPLUS_TEXT ("() failed for file ") << filename
+        << LOG4CPLUS_TEXT ("; error ") << err;
+    getLogLog ().error (oss.str ());
+}
+
+
+} } // namespace log4cplus { namespace helpers {
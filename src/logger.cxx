@@ -22,7 +22,9 @@
 #include <log4cplus/appender.h>
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/spi/eventpool.h>
 #include <log4cplus/spi/loggerimpl.h>
+#include <log4cplus/spi/loggingevent.h>
 
 
 namespace log4cplus
@@ -216,13 +218,6 @@ Logger::closeNestedAppenders () const
 }
 
 
-bool
-Logger::isEnabledFor (LogLevel ll) const
-{
-    return value->isEnabledFor (ll);
-}
-
-
 void
 Logger::log (LogLevel ll, const log4cplus::tstring& message, const char* file,
     int line) const
@@ -239,6 +234,16 @@ Logger::forcedLog (LogLevel ll, const log4cplus::tstring& message,
 }
 
 
+void
+Logger::forcedLog (LogLevel ll, const helpers::DeferredMessage& message,
+    const char* file, int line) const
+{
+    spi::PooledEvent ev;
+    ev->setLoggingEvent (value->getName (), ll, message, file, line);
+    value->callAppenders (*ev);
+}
+
+
 void
 Logger::callAppenders (const spi::InternalLoggingEvent& event) const
 {
@@ -22,6 +22,7 @@
 #include <log4cplus/appender.h>
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/spi/eventpool.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/spi/rootlogger.h>
 #include <stdexcept>
@@ -40,7 +41,11 @@ LoggerImpl::LoggerImpl(const log4cplus::tstring& name_, Hierarchy& h)
     ll(NOT_SET_LOG_LEVEL),
     parent(NULL),
     additive(true), 
-    hierarchy(h)
+    hierarchy(h),
+    hierarchyGeneration(&h.generation),
+    cacheGeneration(h.generation - 1),
+    cachedLogLevel(NOT_SET_LOG_LEVEL),
+    cacheWriter(0)
 {
 }
 
@@ -90,10 +95,45 @@ LoggerImpl::closeNestedAppenders()
 bool 
 LoggerImpl::isEnabledFor(LogLevel ll_) const
 {
-    if(hierarchy.disableValue >= ll_) {
-        return false;
+    // Read the generation before the levels. Should the hierarchy change
+    // while we are computing, the cache is left invalid and the next
+    // check recomputes it.
+    unsigned const generation = *hierarchyGeneration;
+
+    LogLevel effective = getChainedLogLevel();
+    int const disableValue = hierarchy.disableValue;
+    if(disableValue >= effective) {
+        effective = disableValue + 1;
     }
-    return ll_ >= getChainedLogLevel();
+
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    if(generation == *hierarchyGeneration) {
+        cachedLogLevel = effective;
+        cacheGeneration = generation;
+    }
+
+#elif defined (LOG4CPLUS_HAVE_ATOMICS)
+    // The level and the generation are two stores. Invalidate the cache
+    // before the level is replaced and stamp it only if the hierarchy
+    // has not changed in the meantime. A thread that finds another one
+    // refilling the cache just returns its result.
+    if(LOG4CPLUS_ATOMIC_COMPARE_AND_SWAP(cacheWriter, 0, 1)) {
+        cacheGeneration = generation - 1;
+        LOG4CPLUS_MEMORY_BARRIER();
+        cachedLogLevel = effective;
+        LOG4CPLUS_MEMORY_BARRIER();
+        if(generation == *hierarchyGeneration) {
+            cacheGeneration = generation;
+        }
+        LOG4CPLUS_MEMORY_BARRIER();
+        cacheWriter = 0;
+    }
+
+#else
+    // Without atomic operations the cache is never filled and every
+    // check takes this path.
+#endif
+    return ll_ >= effective;
 }
 
 
@@ -124,6 +164,14 @@ LoggerImpl::getChainedLogLevel() const
 }
 
 
+void 
+LoggerImpl::setLogLevel(LogLevel _ll)
+{
+    this->ll = _ll;
+    hierarchy.bumpGeneration();
+}
+
+
 Hierarchy& 
 LoggerImpl::getHierarchy() const
 { 
@@ -151,7 +199,9 @@ LoggerImpl::forcedLog(LogLevel ll_,
                       const char* file,
                       int line)
 {
-    callAppenders(spi::InternalLoggingEvent(this->getName(), ll_, message, file, line));
+    spi::PooledEvent ev;
+    ev->setLoggingEvent(this->getName(), ll_, message, file, line);
+    callAppenders(*ev);
 }
 
 
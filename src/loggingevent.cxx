@@ -19,6 +19,7 @@
 // limitations under the License.
 
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/spi/eventpool.h>
 
 
 using namespace log4cplus;
@@ -34,6 +35,7 @@ using namespace log4cplus::spi;
 
 InternalLoggingEvent::~InternalLoggingEvent()
 {
+    releaseDeferred();
 }
 
 
@@ -57,6 +59,13 @@ InternalLoggingEvent::getDefaultType()
 const log4cplus::tstring& 
 InternalLoggingEvent::getMessage() const
 {
+    if(deferred) {
+        std::size_t const capacity = message.capacity();
+        deferred->render(message);
+        if(message.capacity() != capacity)
+            EventPool::noteBufferGrowth();
+        releaseDeferred();
+    }
     return message;
 }
 
@@ -83,18 +92,114 @@ InternalLoggingEvent::operator=(const log4cplus::spi::InternalLoggingEvent& rhs)
 {
     if(this == &rhs) return *this;
 
+    const log4cplus::helpers::DeferredMessage* tmp = rhs.deferred
+        ? new log4cplus::helpers::DeferredMessage(*rhs.deferred) : 0;
+    releaseDeferred();
+    deferred = tmp;
+    deferredOwned = true;
+
+    std::size_t const capacity = message.capacity();
     message = rhs.message;
-    loggerName = rhs.loggerName;
+    if(message.capacity() != capacity)
+        EventPool::noteBufferGrowth();
+    ownedLoggerName = rhs.getLoggerName();
+    loggerName = &ownedLoggerName;
     ll = rhs.ll;
     ndc = rhs.getNDC();
     thread = rhs.getThread();
     timestamp = rhs.timestamp;
-    file = rhs.file;
+    fileName = 0;
+    file = rhs.getFile();
     line = rhs.line;
     threadCached = true;
     ndcCached = true;
+    fileCached = true;
 
     return *this;
 }
 
 
+
+
+
+void
+InternalLoggingEvent::setLoggingEvent(const log4cplus::tstring& logger,
+                                      LogLevel ll_,
+                                      const log4cplus::tstring& message_,
+                                      const char* filename,
+                                      int line_)
+{
+    setEventData(logger, ll_, filename, line_);
+
+    std::size_t const capacity = message.capacity();
+    message.assign(message_);
+    if(message.capacity() != capacity)
+        EventPool::noteBufferGrowth();
+}
+
+
+void
+InternalLoggingEvent::setLoggingEvent(const log4cplus::tstring& logger,
+                                      LogLevel ll_,
+                                      const log4cplus::helpers::DeferredMessage& message_,
+                                      const char* filename,
+                                      int line_)
+{
+    setEventData(logger, ll_, filename, line_);
+
+    message.clear();
+    deferred = &message_;
+    deferredOwned = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// InternalLoggingEvent private methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+InternalLoggingEvent::setEventData(const log4cplus::tstring& logger,
+                                   LogLevel ll_,
+                                   const char* filename,
+                                   int line_)
+{
+    releaseDeferred();
+    loggerName = &logger;
+    ll = ll_;
+    threadCached = false;
+    ndcCached = false;
+    timestamp = log4cplus::helpers::Time::gettimeofday();
+    fileName = filename;
+    fileCached = false;
+    line = line_;
+}
+
+
+void
+InternalLoggingEvent::releaseDeferred() const
+{
+    if(deferredOwned)
+        delete deferred;
+    deferred = 0;
+    deferredOwned = false;
+}
+
+
+void
+InternalLoggingEvent::recycle()
+{
+    releaseDeferred();
+    message.clear();
+    ownedLoggerName.clear();
+    loggerName = &ownedLoggerName;
+    ll = NOT_SET_LOG_LEVEL;
+    ndc.clear();
+    thread.clear();
+    fileName = 0;
+    file.clear();
+    line = -1;
+    threadCached = true;
+    ndcCached = true;
+    fileCached = true;
+}
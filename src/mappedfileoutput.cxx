@@ -0,0 +1,371 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/mappedfileoutput.h>
+#include <log4cplus/helpers/loglog.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+//! @returns The size rounded up to a non-zero multiple of the page
+//! size.
+static
+std::size_t
+round_to_pages (std::size_t size)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    long const ret = ::sysconf (_SC_PAGESIZE);
+    std::size_t const page = ret > 0 ? static_cast<std::size_t>(ret) : 4096;
+#else
+    std::size_t const page = 4096;
+#endif
+
+    return (std::max) ((size + page - 1) / page, static_cast<std::size_t>(1))
+        * page;
+}
+
+} // namespace
+
+
+MappedFileOutput::MappedFileOutput (std::size_t windowSize_)
+    : FileOutput (0)
+    , windowSize (round_to_pages (windowSize_))
+    , window (0)
+    , windowOffset (0)
+    , allocated (0)
+    , synced (0)
+{ }
+
+
+MappedFileOutput::~MappedFileOutput ()
+{
+    close ();
+}
+
+
+bool
+MappedFileOutput::open (tstring const & name, bool append)
+{
+    close ();
+
+    filename = name;
+    failed = false;
+    size = 0;
+
+    int err = 0;
+    fd = openFile (name, append, err);
+    if (fd == -1)
+    {
+        reportError (LOG4CPLUS_TEXT ("open"), err);
+        return false;
+    }
+
+    allocated = (std::max) (getFdSize (fd), static_cast<file_size_type>(0));
+    size = findEnd ();
+    synced = size;
+    resetOffsets ();
+    return true;
+}
+
+
+void
+MappedFileOutput::close ()
+{
+    if (fd == -1)
+        return;
+
+    unmapWindow ();
+    truncate ();
+    releaseFile ();
+
+    int const ret = closeFd (fd);
+    if (ret != 0)
+        reportError (LOG4CPLUS_TEXT ("close"), ret);
+
+    fd = -1;
+}
+
+
+void
+MappedFileOutput::write (char const * data, std::size_t len)
+{
+    if (len == 0 || ! good ())
+        return;
+
+    while (len != 0)
+    {
+        if (! window || size >= windowOffset
+            + static_cast<file_size_type>(windowSize))
+        {
+            if (! mapWindow (size))
+                return;
+        }
+
+        std::size_t const offset = static_cast<std::size_t>(
+            size - windowOffset);
+        std::size_t const n = (std::min) (len, windowSize - offset);
+        std::memcpy (window + offset, data, n);
+        size += n;
+        data += n;
+        len -= n;
+    }
+}
+
+
+void
+MappedFileOutput::flush ()
+{
+    if (synced >= size || ! good ())
+        return;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    int ret;
+    if (window && synced >= windowOffset)
+    {
+        // Only pages of the current window are dirty. msync() needs
+        // a page aligned start.
+        std::size_t const page = round_to_pages (1);
+        std::size_t const start = static_cast<std::size_t>(
+            synced - windowOffset) / page * page;
+        ret = ::msync (window + start,
+            static_cast<std::size_t>(size - windowOffset) - start, MS_SYNC);
+    }
+    else
+#if defined (__linux__)
+        ret = ::fdatasync (fd);
+#else
+        ret = ::fsync (fd);
+#endif
+
+    if (ret != 0)
+        reportError (LOG4CPLUS_TEXT ("msync"), errno);
+#endif
+
+    synced = size;
+}
+
+
+int
+MappedFileOutput::dupForSync ()
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H) && ! defined (__linux__)
+    // Linux tracks pages dirtied through the mapping and fdatasync()
+    // writes them back. Elsewhere only msync() is sure to; MS_ASYNC
+    // merely starts the writeback and does not wait for it.
+    if (window && size > windowOffset && good ())
+        ::msync (window, static_cast<std::size_t>(size - windowOffset),
+            MS_ASYNC);
+#endif
+
+    return dupFd ();
+}
+
+
+int
+MappedFileOutput::exchange (int newFd, tstring const & name)
+{
+    unmapWindow ();
+    truncate ();
+    releaseFile ();
+
+    int const oldFd = fd;
+    fd = newFd;
+    filename = name;
+    failed = false;
+    allocated = (std::max) (getFdSize (fd), static_cast<file_size_type>(0));
+    size = findEnd ();
+    synced = size;
+    resetOffsets ();
+    return oldFd;
+}
+
+
+int
+MappedFileOutput::openFile (tstring const & name, bool append,
+    int & err) const
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    int oflags = O_RDWR | O_CREAT;
+    if (! append)
+        oflags |= O_TRUNC;
+#if defined (O_CLOEXEC)
+    oflags |= O_CLOEXEC;
+#endif
+
+    std::string const fname (LOG4CPLUS_TSTRING_TO_STRING (name));
+    int ret;
+    do
+        ret = ::open (fname.c_str (), oflags, 0666);
+    while (ret == -1 && errno == EINTR);
+
+    err = ret == -1 ? errno : 0;
+    return ret;
+
+#else
+    // Mapped output is not supported on this platform.
+    (void)name;
+    (void)append;
+    err = -1;
+    return -1;
+
+#endif
+}
+
+
+bool
+MappedFileOutput::mapWindow (file_size_type offset)
+{
+    unmapWindow ();
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    file_size_type const start = offset
+        - offset % static_cast<file_size_type>(windowSize);
+    if (allocated < start + static_cast<file_size_type>(windowSize))
+    {
+        // Whole windows keep the size a multiple of the window size,
+        // see findEnd().
+        file_size_type const step = windowSize;
+        file_size_type const end = start + (std::max) (step,
+            (preallocateSize + step - 1) / step * step);
+
+        // Reserve the blocks, writing into a hole of a sparse file
+        // raises SIGBUS when the disk is full.
+#if defined (__linux__)
+        int const ret = ::posix_fallocate (fd, allocated, end - allocated);
+#else
+        int const ret = ::ftruncate (fd, end) == 0 ? 0 : errno;
+#endif
+        if (ret != 0)
+        {
+            reportError (LOG4CPLUS_TEXT ("posix_fallocate"), ret);
+            failed = true;
+            return false;
+        }
+        allocated = end;
+    }
+
+    void * const addr = ::mmap (0, windowSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, start);
+    if (addr == MAP_FAILED)
+    {
+        reportError (LOG4CPLUS_TEXT ("mmap"), errno);
+        failed = true;
+        return false;
+    }
+
+    window = static_cast<char *>(addr);
+    windowOffset = start;
+
+    // Data before the window are not mapped anymore.
+    dropCacheBehind (start);
+    return true;
+
+#else
+    (void)offset;
+    failed = true;
+    return false;
+
+#endif
+}
+
+
+void
+MappedFileOutput::unmapWindow ()
+{
+    if (! window)
+        return;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    ::munmap (window, windowSize);
+#endif
+    window = 0;
+}
+
+
+void
+MappedFileOutput::truncate ()
+{
+    if (allocated == size)
+        return;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    if (::ftruncate (fd, size) != 0)
+    {
+        reportError (LOG4CPLUS_TEXT ("ftruncate"), errno);
+        return;
+    }
+#endif
+
+    allocated = size;
+}
+
+
+file_size_type
+MappedFileOutput::findEnd ()
+{
+    file_size_type end = allocated;
+    if (end == 0 || end % static_cast<file_size_type>(windowSize) != 0)
+        return end;
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    std::vector<char> buf (64 * 1024);
+    while (end != 0)
+    {
+        std::size_t const n = static_cast<std::size_t>(
+            (std::min) (end, static_cast<file_size_type>(buf.size ())));
+        ssize_t ret;
+        do
+            ret = ::pread (fd, &buf[0], n, end - n);
+        while (ret == -1 && errno == EINTR);
+        if (ret != static_cast<ssize_t>(n))
+            break;
+
+        std::size_t i = n;
+        while (i != 0 && buf[i - 1] == 0)
+            --i;
+        if (i != 0)
+            return end - n + i;
+
+        end -= n;
+    }
+#endif
+
+    return end;
+}
+
+
+} } // namespace log4cplus { namespace helpers {
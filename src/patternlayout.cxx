@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #endif
 #include <exception>
+#include <typeinfo>
 
 #ifdef LOG4CPLUS_HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -67,8 +68,9 @@ get_process_id ()
 
 
 static
-log4cplus::tstring
-get_basename (const log4cplus::tstring& filename)
+void
+append_basename (log4cplus::tstring& output,
+    const log4cplus::tstring& filename)
 {
 #if defined(_WIN32)
     log4cplus::tchar const dir_sep(LOG4CPLUS_TEXT('\\'));
@@ -78,9 +80,31 @@ get_basename (const log4cplus::tstring& filename)
 
     log4cplus::tstring::size_type pos = filename.rfind(dir_sep);
     if (pos != log4cplus::tstring::npos)
-        return filename.substr(pos+1);
+        output.append(filename, pos+1, log4cplus::tstring::npos);
     else
-        return filename;
+        output += filename;
+}
+
+
+static
+void
+append_integer (log4cplus::tstring& output, int value)
+{
+    log4cplus::tchar buf[16];
+    log4cplus::tchar * const end = buf + sizeof (buf) / sizeof (buf[0]);
+    log4cplus::tchar * p = end;
+    unsigned long v = value < 0
+        ? 0ul - static_cast<unsigned long>(value)
+        : static_cast<unsigned long>(value);
+    do
+    {
+        *--p = static_cast<log4cplus::tchar>(LOG4CPLUS_TEXT('0') + v % 10);
+        v /= 10;
+    }
+    while (v != 0);
+    if (value < 0)
+        *--p = LOG4CPLUS_TEXT('-');
+    output.append(p, end);
 }
 
 
@@ -100,8 +124,8 @@ namespace log4cplus {
     namespace pattern {
 
         /**
-         * This is used by PatternConverter class to inform them how to format
-         * their output.
+         * This is used by PatternParser to tell how the output of a
+         * conversion is formatted.
          */
         struct FormattingInfo {
             int minLen;
@@ -111,154 +135,94 @@ namespace log4cplus {
 
             void reset();
             void dump(log4cplus::helpers::LogLog&);
-        };
-
 
-
-        /**
-         * This is the base class of all "Converter" classes that format a
-         * field of InternalLoggingEvent objects.  In fact, the PatternLayout
-         * class simply uses an array of PatternConverter objects to format
-         * and append a logging event.
-         */
-        class PatternConverter : protected log4cplus::helpers::LogLogUser {
-        public:
-            PatternConverter(const FormattingInfo& info);
-            virtual ~PatternConverter() {}
-            void formatAndAppend(log4cplus::tostream& output, 
-                                 const InternalLoggingEvent& event);
-
-        protected:
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event) = 0;
-
-        private:
-            int minLen;
-            size_t maxLen;
-            bool leftAlign;
+            /**
+             * Pads or truncates the text appended to <code>output</code>
+             * at <code>start</code>.
+             */
+            void apply(log4cplus::tstring& output, size_t start) const;
         };
 
 
 
         /**
-         * This PatternConverter returns a constant string.
+         * This is a single instruction of a compiled conversion pattern.
+         * Each one appends one field of the InternalLoggingEvent object
+         * to the output.
          */
-        class LiteralPatternConverter : public PatternConverter {
-        public:
-            LiteralPatternConverter(const log4cplus::tstring& str);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent&) {
-                return str;
-            }
-
-        private:
-            log4cplus::tstring str;
-        };
-
-
-
-        /**
-         * This PatternConverter is used to format most of the "simple" fields
-         * found in the InternalLoggingEvent object.
-         */
-        class BasicPatternConverter : public PatternConverter {
-        public:
-            enum Type { THREAD_CONVERTER,
-                        PROCESS_CONVERTER,
-                        LOGLEVEL_CONVERTER,
-                        NDC_CONVERTER,
-                        MESSAGE_CONVERTER,
-                        NEWLINE_CONVERTER,
-                        BASENAME_CONVERTER,
-                        FILE_CONVERTER,
-                        LINE_CONVERTER,
-                        FULL_LOCATION_CONVERTER };
-            BasicPatternConverter(const FormattingInfo& info, Type type);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
-
-        private:
-          // Disable copy
-            BasicPatternConverter(const BasicPatternConverter&);
-            BasicPatternConverter& operator=(BasicPatternConverter&);
-            
-            LogLevelManager& llmCache;
-            Type type;
-        };
-
-
-
-        /**
-         * This PatternConverter is used to format the Logger field found in
-         * the InternalLoggingEvent object.
-         */
-        class LoggerPatternConverter : public PatternConverter {
-        public:
-            LoggerPatternConverter(const FormattingInfo& info, int precision);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
-
-        private:
+        struct Instruction {
+            enum Opcode { LITERAL,
+                          LOGLEVEL,
+                          NDC,
+                          MESSAGE,
+                          THREAD,
+                          BASENAME,
+                          FILE,
+                          LINE,
+                          PROCESS,
+                          FULL_LOCATION,
+                          LOGGER,
+                          DATE };
+
+            Opcode opcode;
+            FormattingInfo info;
+
+            /** %c and %x precision. */
             int precision;
-        };
-
 
+            /** Text of LITERAL instructions. */
+            log4cplus::tstring text;
 
-        /**
-         * This PatternConverter is used to format the timestamp field found in
-         * the InternalLoggingEvent object.  It will be formatted according to
-         * the specified "pattern".
-         */
-        class DatePatternConverter : public PatternConverter {
-        public:
-            DatePatternConverter(const FormattingInfo& info, 
-                                 const log4cplus::tstring& pattern, 
-                                 bool use_gmtime);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
-
-        private:
-            bool use_gmtime;
-            log4cplus::tstring format;
+            /** Formatter of DATE instructions, owned by PatternProgram. */
+            helpers::TimeFormatter* formatter;
         };
 
 
 
         /**
-         * This PatternConverter is used to format the hostname field.
+         * This is a conversion pattern compiled into a flat array of
+         * instructions. Adjacent literals, including conversions whose
+         * output never changes (%h, %H and %n), are merged into
+         * a single LITERAL instruction when the pattern is compiled.
          */
-        class HostnamePatternConverter : public PatternConverter {
+        class PatternProgram {
         public:
-            HostnamePatternConverter(const FormattingInfo& info, bool fqdn);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
-
-        private:
-            log4cplus::tstring hostname_;
-        };
+            PatternProgram() {}
+            ~PatternProgram();
 
+            /**
+             * Appends the instruction, merging it into the previous
+             * one if both are literals.
+             */
+            void append(const Instruction& instruction);
 
+            /**
+             * Appends the formatted event to <code>output</code>.
+             */
+            void execute(log4cplus::tstring& output,
+                         const InternalLoggingEvent& event) const;
 
-        /**
-         * This PatternConverter is used to format the NDC field found in
-         * the InternalLoggingEvent object, optionally limited to
-         * \c precision levels (using space to separate levels).
-         */
-        class NDCPatternConverter : public PatternConverter {
-        public:
-            NDCPatternConverter(const FormattingInfo& info, int precision);
-            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+            bool empty() const { return instructions.empty(); }
 
         private:
-            int precision;
+            std::vector<Instruction> instructions;
+
+          // Disable copy
+            PatternProgram(const PatternProgram&);
+            PatternProgram& operator=(const PatternProgram&);
         };
 
 
 
         /**
-         * This class parses a "pattern" string into an array of
-         * PatternConverter objects.
+         * This class parses a "pattern" string into a PatternProgram.
          * <p>
          * @see PatternLayout for the formatting of the "pattern" string.
          */
         class PatternParser : protected log4cplus::helpers::LogLogUser {
         public:
             PatternParser(const log4cplus::tstring& pattern, unsigned ndcMaxDepth);
-            std::vector<PatternConverter*> parse();
+            void parse(PatternProgram& program);
 
         private:
           // Types
@@ -272,11 +236,15 @@ namespace log4cplus {
             log4cplus::tstring extractOption();
             int extractPrecisionOption();
             void finalizeConverter(log4cplus::tchar c);
+            void appendLiteral(const log4cplus::tstring& str);
+            void appendConstant(const log4cplus::tstring& str);
+            void appendField(Instruction::Opcode opcode, int precision = 0,
+                             helpers::TimeFormatter* formatter = 0);
 
           // Data
             log4cplus::tstring pattern;
             FormattingInfo formattingInfo;
-            std::vector<PatternConverter*> list;
+            PatternProgram* program;
             ParserState state;
             tstring::size_type pos;
             log4cplus::tstring currentLiteral;
@@ -285,12 +253,11 @@ namespace log4cplus {
     }
 }
 using namespace log4cplus::pattern;
-typedef std::vector<log4cplus::pattern::PatternConverter*> PatternConverterList;
 
 
 
 ////////////////////////////////////////////////
-// PatternConverter methods:
+// FormattingInfo methods:
 ////////////////////////////////////////////////
 
 void 
@@ -312,231 +279,179 @@ log4cplus::pattern::FormattingInfo::dump(log4cplus::helpers::LogLog& loglog) {
 }
 
 
-
-
-////////////////////////////////////////////////
-// PatternConverter methods:
-////////////////////////////////////////////////
-
-log4cplus::pattern::PatternConverter::PatternConverter(const FormattingInfo& i)
-{
-    minLen = i.minLen;
-    maxLen = i.maxLen;
-    leftAlign = i.leftAlign;
-}
-
-
-
 void
-log4cplus::pattern::PatternConverter::formatAndAppend
-                     (log4cplus::tostream& output, const InternalLoggingEvent& event)
+log4cplus::pattern::FormattingInfo::apply(log4cplus::tstring& output,
+                                          size_t start) const
 {
-    log4cplus::tstring s = convert(event);
-    size_t len = s.length();
+    size_t len = output.length() - start;
 
     if(len > maxLen) {
-        output << s.substr(len - maxLen);
+        output.erase(start, len - maxLen);
     }
     else if(static_cast<int>(len) < minLen) {
         if(leftAlign) {
-            output << s;
-            output << log4cplus::tstring(minLen - len, LOG4CPLUS_TEXT(' '));
+            output.append(minLen - len, LOG4CPLUS_TEXT(' '));
         }
         else {
-            output << log4cplus::tstring(minLen - len, LOG4CPLUS_TEXT(' '));
-            output << s;
+            output.insert(start, minLen - len, LOG4CPLUS_TEXT(' '));
         }
     }
-    else {
-        output << s;
-    }
 }
 
 
 
 ////////////////////////////////////////////////
-// LiteralPatternConverter methods:
+// PatternProgram methods:
 ////////////////////////////////////////////////
 
-log4cplus::pattern::LiteralPatternConverter::LiteralPatternConverter
-                                                      (const log4cplus::tstring& str_)
-: PatternConverter(FormattingInfo()),
-  str(str_)
+log4cplus::pattern::PatternProgram::~PatternProgram()
 {
-}
-
-
-
-////////////////////////////////////////////////
-// BasicPatternConverter methods:
-////////////////////////////////////////////////
-
-log4cplus::pattern::BasicPatternConverter::BasicPatternConverter
-                                        (const FormattingInfo& info, Type type_)
-: PatternConverter(info),
-  llmCache(getLogLevelManager()),
-  type(type_)
-{
-}
-
-
-
-log4cplus::tstring
-log4cplus::pattern::BasicPatternConverter::convert
-                                            (const InternalLoggingEvent& event)
-{
-    switch(type) {
-    case LOGLEVEL_CONVERTER: return llmCache.toString(event.getLogLevel());
-    case NDC_CONVERTER:      return event.getNDC();
-    case MESSAGE_CONVERTER:  return event.getMessage();
-    case NEWLINE_CONVERTER:  return LOG4CPLUS_TEXT("\n");
-    case BASENAME_CONVERTER: return get_basename(event.getFile());
-    case FILE_CONVERTER:     return event.getFile();
-    case THREAD_CONVERTER:   return event.getThread(); 
-    case PROCESS_CONVERTER:  return convertIntegerToString(get_process_id ()); 
-
-    case LINE_CONVERTER:
-        {
-            int line = event.getLine();
-            if(line != -1) {
-                return convertIntegerToString(line);
-            }
-            else {
-                return log4cplus::tstring();
-            }
-        }
-
-    case FULL_LOCATION_CONVERTER:
-        {
-            tstring const & filename = event.getFile();
-            if(! filename.empty ()) {
-                return   filename 
-                       + LOG4CPLUS_TEXT(":") 
-                       + convertIntegerToString(event.getLine());
-            }
-            else {
-                return LOG4CPLUS_TEXT(":");
-            }
-        }
+    for(std::vector<Instruction>::iterator it=instructions.begin(); 
+        it!=instructions.end(); 
+        ++it)
+    {
+        delete it->formatter;
     }
-
-    return LOG4CPLUS_TEXT("INTERNAL LOG4CPLUS ERROR");
-}
-
-
-
-////////////////////////////////////////////////
-// LoggerPatternConverter methods:
-////////////////////////////////////////////////
-
-log4cplus::pattern::LoggerPatternConverter::LoggerPatternConverter
-                                    (const FormattingInfo& info, int precision_)
-: PatternConverter(info),
-  precision(precision_)
-{
 }
 
 
 
-log4cplus::tstring
-log4cplus::pattern::LoggerPatternConverter::convert
-                                            (const InternalLoggingEvent& event)
+void
+log4cplus::pattern::PatternProgram::append(const Instruction& instruction)
 {
-    const log4cplus::tstring& name = event.getLoggerName();
-    if (precision <= 0) {
-        return name;
+    if(   instruction.opcode == Instruction::LITERAL
+       && ! instructions.empty ()
+       && instructions.back().opcode == Instruction::LITERAL)
+    {
+        instructions.back().text += instruction.text;
     }
     else {
-        size_t len = name.length();
-
-        // We substract 1 from 'len' when assigning to 'end' to avoid out of
-        // bounds exception in return r.substring(end+1, len). This can happen
-        // if precision is 1 and the logger name ends with a dot. 
-        tstring::size_type end = len - 1;
-        for(int i=precision; i>0; --i) {
-            end = name.rfind(LOG4CPLUS_TEXT('.'), end - 1);
-            if(end == tstring::npos) {
-                return name;
-            }
-        }
-        return name.substr(end + 1);
+        instructions.push_back(instruction);
     }
 }
 
 
 
-////////////////////////////////////////////////
-// DatePatternConverter methods:
-////////////////////////////////////////////////
-
-
-log4cplus::pattern::DatePatternConverter::DatePatternConverter
-                                               (const FormattingInfo& info,
-                                                const log4cplus::tstring& pattern,
-                                                bool use_gmtime_)
-: PatternConverter(info),
-  use_gmtime(use_gmtime_),
-  format(pattern)
-{
-}
-
-
-
-log4cplus::tstring 
-log4cplus::pattern::DatePatternConverter::convert
-                                            (const InternalLoggingEvent& event)
+void
+log4cplus::pattern::PatternProgram::execute(log4cplus::tstring& output,
+                                            const InternalLoggingEvent& event) const
 {
-    return event.getTimestamp().getFormattedTime(format, use_gmtime);
-}
-
+    for(std::vector<Instruction>::const_iterator it=instructions.begin(); 
+        it!=instructions.end(); 
+        ++it)
+    {
+        const Instruction& ins = *it;
+        if(ins.opcode == Instruction::LITERAL) {
+            output += ins.text;
+            continue;
+        }
 
+        size_t start = output.length();
+        switch(ins.opcode) {
+        case Instruction::LITERAL:
+            break;
 
+        case Instruction::LOGLEVEL:
+            output += getLogLevelManager().toString(event.getLogLevel());
+            break;
 
-////////////////////////////////////////////////
-// HostnamePatternConverter methods:
-////////////////////////////////////////////////
+        case Instruction::NDC:
+            {
+                const log4cplus::tstring& text = event.getNDC();
+                if (ins.precision <= 0)
+                    output += text;
+                else
+                {
+                    tstring::size_type p = text.find(LOG4CPLUS_TEXT(' '));
+                    for (int i = 1; i < ins.precision && p != tstring::npos; ++i)
+                        p = text.find(LOG4CPLUS_TEXT(' '), p + 1);
+
+                    output.append(text, 0, p);
+                }
+            }
+            break;
 
-log4cplus::pattern::HostnamePatternConverter::HostnamePatternConverter (
-    const FormattingInfo& info, bool fqdn)
-    : PatternConverter(info)
-    , hostname_ (helpers::getHostname (fqdn))
-{ }
+        case Instruction::MESSAGE:
+            output += event.getMessage();
+            break;
 
+        case Instruction::THREAD:
+            output += event.getThread();
+            break;
 
-log4cplus::tstring
-log4cplus::pattern::HostnamePatternConverter::convert (
-    const InternalLoggingEvent &)
-{
-    return hostname_;
-}
+        case Instruction::BASENAME:
+            append_basename(output, event.getFile());
+            break;
 
+        case Instruction::FILE:
+            output += event.getFile();
+            break;
 
+        case Instruction::LINE:
+            {
+                int line = event.getLine();
+                if(line != -1) {
+                    append_integer(output, line);
+                }
+            }
+            break;
 
-////////////////////////////////////////////////
-// NDCPatternConverter methods:
-////////////////////////////////////////////////
+        case Instruction::PROCESS:
+            append_integer(output, static_cast<int>(get_process_id ()));
+            break;
 
-log4cplus::pattern::NDCPatternConverter::NDCPatternConverter (
-    const FormattingInfo& info, int precision_)
-    : PatternConverter(info)
-    , precision(precision_)
-{ }
+        case Instruction::FULL_LOCATION:
+            {
+                tstring const & filename = event.getFile();
+                if(! filename.empty ()) {
+                    output += filename;
+                    output += LOG4CPLUS_TEXT(':');
+                    append_integer(output, event.getLine());
+                }
+                else {
+                    output += LOG4CPLUS_TEXT(':');
+                }
+            }
+            break;
 
+        case Instruction::LOGGER:
+            {
+                const log4cplus::tstring& name = event.getLoggerName();
+                if (ins.precision <= 0) {
+                    output += name;
+                }
+                else {
+                    // The result is always a suffix of the name, so it
+                    // is appended straight from it.
+                    size_t len = name.length();
+
+                    // We substract 1 from 'len' when assigning to 'end' to
+                    // avoid out of bounds exception in the append() below.
+                    // This can happen if precision is 1 and the logger name
+                    // ends with a dot.
+                    tstring::size_type end = len - 1;
+                    for(int i=ins.precision; i>0; --i) {
+                        end = name.rfind(LOG4CPLUS_TEXT('.'), end - 1);
+                        if(end == tstring::npos) {
+                            break;
+                        }
+                    }
+                    if(end == tstring::npos) {
+                        output += name;
+                    }
+                    else {
+                        output.append(name, end + 1, tstring::npos);
+                    }
+                }
+            }
+            break;
 
-log4cplus::tstring
-log4cplus::pattern::NDCPatternConverter::convert (
-    const InternalLoggingEvent& event)
-{
-    const log4cplus::tstring& text = event.getNDC();
-    if (precision <= 0)
-        return text;
-    else
-    {
-        tstring::size_type p = text.find(LOG4CPLUS_TEXT(' '));
-        for (int i = 1; i < precision && p != tstring::npos; ++i)
-            p = text.find(LOG4CPLUS_TEXT(' '), p + 1);
+        case Instruction::DATE:
+            ins.formatter->appendFormattedTime(output, event.getTimestamp());
+            break;
+        }
 
-        return text.substr(0, p);
+        ins.info.apply(output, start);
     }
 }
 
@@ -549,6 +464,7 @@ log4cplus::pattern::NDCPatternConverter::convert (
 log4cplus::pattern::PatternParser::PatternParser(
     const log4cplus::tstring& pattern_, unsigned ndcMaxDepth_)
     : pattern(pattern_)
+    , program(0)
     , state(LITERAL_STATE)
     , pos(0)
     , ndcMaxDepth (ndcMaxDepth_)
@@ -596,9 +512,10 @@ log4cplus::pattern::PatternParser::extractPrecisionOption()
 
 
 
-PatternConverterList
-log4cplus::pattern::PatternParser::parse() 
+void
+log4cplus::pattern::PatternParser::parse(PatternProgram& program_) 
 {
+    program = &program_;
     tchar c;
     pos = 0;
     while(pos < pattern.length()) {
@@ -619,8 +536,7 @@ log4cplus::pattern::PatternParser::parse()
                     break;
                 default:
                     if(! currentLiteral.empty ()) {
-                        list.push_back
-                             (new LiteralPatternConverter(currentLiteral));
+                        appendLiteral(currentLiteral);
                         //getLogLog().debug("Parsed LITERAL converter: \"" 
                         //                  +currentLiteral+"\".");
                     }
@@ -699,11 +615,11 @@ log4cplus::pattern::PatternParser::parse()
     } // end while
 
     if(! currentLiteral.empty ()) {
-        list.push_back(new LiteralPatternConverter(currentLiteral));
+        appendLiteral(currentLiteral);
       //getLogLog().debug("Parsed LITERAL converter: \""+currentLiteral+"\".");
     }
 
-    return list;
+    program = 0;
 }
 
 
@@ -711,19 +627,15 @@ log4cplus::pattern::PatternParser::parse()
 void
 log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c) 
 {
-    PatternConverter* pc = 0;
     switch (c) {
         case LOG4CPLUS_TEXT('b'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::BASENAME_CONVERTER);
+            appendField(Instruction::BASENAME);
             //getLogLog().debug("BASENAME converter.");
             //formattingInfo.dump(getLogLog());      
             break;
             
         case LOG4CPLUS_TEXT('c'):
-            pc = new LoggerPatternConverter(formattingInfo, 
-                                            extractPrecisionOption());
+            appendField(Instruction::LOGGER, extractPrecisionOption());
             getLogLog().debug( LOG4CPLUS_TEXT("LOGGER converter.") );
             formattingInfo.dump(getLogLog());      
             break;
@@ -736,7 +648,8 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
                     dOpt = LOG4CPLUS_TEXT("%Y-%m-%d %H:%M:%S");
                 }
                 bool use_gmtime = c == LOG4CPLUS_TEXT('d');
-                pc = new DatePatternConverter(formattingInfo, dOpt, use_gmtime);
+                appendField(Instruction::DATE, 0,
+                            new helpers::TimeFormatter(dOpt, use_gmtime));
                 //if(use_gmtime) {
                 //    getLogLog().debug("GMT DATE converter.");
                 //}
@@ -748,9 +661,7 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
             break;
 
         case LOG4CPLUS_TEXT('F'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::FILE_CONVERTER);
+            appendField(Instruction::FILE);
             //getLogLog().debug("FILE NAME converter.");
             //formattingInfo.dump(getLogLog());      
             break;
@@ -759,40 +670,33 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
         case LOG4CPLUS_TEXT('H'):
             {
                 bool fqdn = (c == LOG4CPLUS_TEXT('H'));
-                pc = new HostnamePatternConverter(formattingInfo, fqdn);
+                appendConstant(helpers::getHostname (fqdn));
                 // getLogLog().debug( LOG4CPLUS_TEXT("HOSTNAME converter.") );
                 // formattingInfo.dump(getLogLog());
             }
             break;
 
         case LOG4CPLUS_TEXT('i'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::PROCESS_CONVERTER);
+            // Read when formatting, the process may have forked since.
+            appendField(Instruction::PROCESS);
             //getLogLog().debug("PROCESS_CONVERTER converter.");
             //formattingInfo.dump(getLogLog());      
             break;
 
         case LOG4CPLUS_TEXT('l'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::FULL_LOCATION_CONVERTER);
+            appendField(Instruction::FULL_LOCATION);
             //getLogLog().debug("FULL LOCATION converter.");
             //formattingInfo.dump(getLogLog());      
             break;
 
         case LOG4CPLUS_TEXT('L'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::LINE_CONVERTER);
+            appendField(Instruction::LINE);
             //getLogLog().debug("LINE NUMBER converter.");
             //formattingInfo.dump(getLogLog());      
             break;
 
         case LOG4CPLUS_TEXT('m'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::MESSAGE_CONVERTER);
+            appendField(Instruction::MESSAGE);
             //getLogLog().debug("MESSAGE converter.");
             //formattingInfo.dump(getLogLog());      
             break;
@@ -803,17 +707,13 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
             goto not_implemented;
 
         case LOG4CPLUS_TEXT('n'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::NEWLINE_CONVERTER);
+            appendConstant(LOG4CPLUS_TEXT("\n"));
             //getLogLog().debug("MESSAGE converter.");
             //formattingInfo.dump(getLogLog());      
             break;
 
         case LOG4CPLUS_TEXT('p'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::LOGLEVEL_CONVERTER);
+            appendField(Instruction::LOGLEVEL);
             //getLogLog().debug("LOGLEVEL converter.");
             //formattingInfo.dump(getLogLog());
             break;
@@ -824,15 +724,13 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
             goto not_implemented;
 
         case LOG4CPLUS_TEXT('t'):
-            pc = new BasicPatternConverter
-                          (formattingInfo, 
-                           BasicPatternConverter::THREAD_CONVERTER);
+            appendField(Instruction::THREAD);
             //getLogLog().debug("THREAD converter.");
             //formattingInfo.dump(getLogLog());      
             break;
 
         case LOG4CPLUS_TEXT('x'):
-            pc = new NDCPatternConverter (formattingInfo, ndcMaxDepth);
+            appendField(Instruction::NDC, ndcMaxDepth);
             //getLogLog().debug("NDC converter.");      
             break;
 
@@ -850,17 +748,55 @@ not_implemented:;
                 << pos
                 << LOG4CPLUS_TEXT(" in conversion patterrn.");
             getLogLog().error(buf.str());
-            pc = new LiteralPatternConverter(currentLiteral);
+            appendLiteral(currentLiteral);
     }
 
     currentLiteral.resize(0);
-    list.push_back(pc);
     state = LITERAL_STATE;
     formattingInfo.reset();
 }
 
 
 
+void
+log4cplus::pattern::PatternParser::appendLiteral(const log4cplus::tstring& str)
+{
+    Instruction ins;
+    ins.opcode = Instruction::LITERAL;
+    ins.precision = 0;
+    ins.text = str;
+    ins.formatter = 0;
+    program->append(ins);
+}
+
+
+
+void
+log4cplus::pattern::PatternParser::appendConstant(const log4cplus::tstring& str)
+{
+    // The output is known now, so it is formatted only once.
+    log4cplus::tstring text(str);
+    formattingInfo.apply(text, 0);
+    appendLiteral(text);
+}
+
+
+
+void
+log4cplus::pattern::PatternParser::appendField(Instruction::Opcode opcode,
+                                               int precision,
+                                               helpers::TimeFormatter* formatter)
+{
+    Instruction ins;
+    ins.opcode = opcode;
+    ins.info = formattingInfo;
+    ins.precision = precision;
+    ins.formatter = formatter;
+    program->append(ins);
+}
+
+
+
 
 
 ////////////////////////////////////////////////
@@ -868,12 +804,14 @@ not_implemented:;
 ////////////////////////////////////////////////
 
 PatternLayout::PatternLayout(const log4cplus::tstring& pattern_)
+    : program(0)
 {
     init(pattern_, 0);
 }
 
 
 PatternLayout::PatternLayout(const log4cplus::helpers::Properties& properties)
+    : program(0)
 {
     unsigned ndcMaxDepth
         = std::atoi (LOG4CPLUS_TSTRING_TO_STRING (
@@ -906,38 +844,28 @@ void
 PatternLayout::init(const log4cplus::tstring& pattern_, unsigned ndcMaxDepth)
 {
     this->pattern = pattern_;
-    this->parsedPattern = PatternParser(pattern, ndcMaxDepth).parse();
 
-    // Let's validate that our parser didn't give us any NULLs.  If it did,
-    // we will convert them to a valid PatternConverter that does nothing so
-    // at least we don't core.
-    for(PatternConverterList::iterator it=parsedPattern.begin(); 
-        it!=parsedPattern.end(); 
-        ++it)
-    {
-        if( (*it) == 0 ) {
-            getLogLog().error(LOG4CPLUS_TEXT("Parsed Pattern created a NULL PatternConverter"));
-            (*it) = new LiteralPatternConverter( LOG4CPLUS_TEXT("") );
-        }
-    }
-    if(parsedPattern.empty ()) {
+    std::auto_ptr<PatternProgram> newProgram(new PatternProgram);
+    PatternParser(pattern, ndcMaxDepth).parse(*newProgram);
+
+    if(newProgram->empty ()) {
         getLogLog().warn(LOG4CPLUS_TEXT("PatternLayout pattern is empty.  Using default..."));
-        parsedPattern.push_back
-           (new BasicPatternConverter(FormattingInfo(), 
-                                      BasicPatternConverter::MESSAGE_CONVERTER));
+        Instruction ins;
+        ins.opcode = Instruction::MESSAGE;
+        ins.precision = 0;
+        ins.formatter = 0;
+        newProgram->append(ins);
     }
+
+    delete program;
+    program = newProgram.release();
 }
 
 
 
 PatternLayout::~PatternLayout()
 {
-    for(PatternConverterList::iterator it=parsedPattern.begin(); 
-        it!=parsedPattern.end(); 
-        ++it)
-    {
-        delete (*it);
-    }
+    delete program;
 }
 
 
@@ -946,12 +874,27 @@ void
 PatternLayout::formatAndAppend(log4cplus::tostream& output, 
                                const InternalLoggingEvent& event)
 {
-    for(PatternConverterList::iterator it=parsedPattern.begin(); 
-        it!=parsedPattern.end(); 
-        ++it)
-    {
-        (*it)->formatAndAppend(output, event);
-    }
+    formatAndWrite(output, event);
 }
 
 
+
+void
+PatternLayout::formatAndAppend(log4cplus::tstring& output, 
+                               const InternalLoggingEvent& event)
+{
+    // Derived layouts may override only the stream overload.
+    if (typeid(*this) == typeid(PatternLayout))
+        appendFormatted(output, event);
+    else
+        Layout::formatAndAppend(output, event);
+}
+
+
+
+void
+PatternLayout::appendFormatted(log4cplus::tstring& output, 
+                               const InternalLoggingEvent& event)
+{
+    program->execute(output, event);
+}
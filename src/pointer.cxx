@@ -46,10 +46,17 @@ SharedObject::~SharedObject()
 void
 SharedObject::addReference() const
 {
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    assert (count >= 0);
+    LOG4CPLUS_ATOMIC_INCREMENT (count);
+
+#else
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex )
         assert (count >= 0);
         ++count;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+
+#endif
 }
 
 
@@ -57,11 +64,18 @@ void
 SharedObject::removeReference() const
 {
     bool destroy = false;
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    assert (count > 0);
+    destroy = LOG4CPLUS_ATOMIC_DECREMENT (count) == 0;
+
+#else
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( access_mutex );
         assert (count > 0);
         if (--count == 0)
             destroy = true;
     LOG4CPLUS_END_SYNCHRONIZE_ON_MUTEX;
+
+#endif
     if (destroy)
         delete this;
 }
@@ -0,0 +1,257 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/config.hxx>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <log4cplus/helpers/queue.h>
+#include <log4cplus/spi/eventpool.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <algorithm>
+
+
+namespace log4cplus { namespace thread {
+
+
+Queue::Queue (unsigned len, OverflowPolicy pol, LogLevel thr)
+    : ring ((std::max) (len, 1u), 0)
+    , head (0)
+    , count (0)
+    , dropped (0)
+    , policy (pol)
+    , threshold (thr)
+    , mutex (Mutex::DEFAULT)
+    , ev_consumer (false)
+    , ev_producers (false)
+    , flags (0)
+{
+    spare.reserve (ring.size ());
+}
+
+
+Queue::~Queue ()
+{
+    clear ();
+    for (queue_storage_type::iterator it = spare.begin ();
+        it != spare.end (); ++it)
+        spi::EventPool::release (*it);
+}
+
+
+unsigned
+Queue::put_event (spi::InternalLoggingEvent const & ev)
+{
+    // Copy the event outside of the critical section. The copy also
+    // captures the NDC and the thread name of the calling thread.
+    spi::InternalLoggingEvent * copy = spi::EventPool::copy (ev);
+    spi::InternalLoggingEvent * victim = 0;
+    spi::InternalLoggingEvent * recycled = 0;
+    bool wake_consumer = false;
+    unsigned ret_flags;
+
+    {
+        MutexGuard guard (mutex);
+
+        while (count == ring.size () && ! (flags & EXIT))
+        {
+            if (policy == DROP_NEWEST
+                || (policy == DROP_BELOW_THRESHOLD
+                    && ev.getLogLevel () < threshold))
+                break;
+            else if (policy == DROP_OLDEST)
+            {
+                victim = pop_front ();
+                ++dropped;
+            }
+            else
+            {
+                // Wait for the consumer. The event is reset only while
+                // the queue is full and the consumer signals it every
+                // time it takes events out of a full queue, so the
+                // wake up cannot be lost.
+                ev_producers.reset ();
+                guard.unlock ();
+                ev_producers.wait ();
+                guard.lock ();
+            }
+        }
+
+        if ((flags & EXIT) || count == ring.size ())
+        {
+            ++dropped;
+            ret_flags = flags | DROPPED;
+        }
+        else
+        {
+            ring[(head + count) % ring.size ()] = copy;
+            copy = 0;
+            ++count;
+            wake_consumer = count == 1;
+            ret_flags = flags | QUEUE;
+            if (victim)
+                ret_flags |= DROPPED;
+        }
+
+        // Give an event delivered by the consumer to this thread's
+        // pool, for the next put_event().
+        if (! spare.empty ())
+        {
+            recycled = spare.back ();
+            spare.pop_back ();
+        }
+    }
+
+    spi::EventPool::release (copy);
+    spi::EventPool::release (victim);
+    spi::EventPool::release (recycled);
+    if (wake_consumer)
+        ev_consumer.signal ();
+
+    return ret_flags;
+}
+
+
+unsigned
+Queue::signal_exit (bool drain)
+{
+    unsigned ret_flags;
+
+    {
+        MutexGuard guard (mutex);
+
+        if (! (flags & EXIT))
+        {
+            flags |= EXIT;
+            if (drain)
+                flags |= DRAIN;
+            else
+            {
+                dropped += count;
+                clear ();
+            }
+        }
+
+        ret_flags = flags;
+    }
+
+    ev_consumer.signal ();
+    ev_producers.signal ();
+
+    return ret_flags;
+}
+
+
+unsigned
+Queue::get_events (queue_storage_type * buf, unsigned long msec)
+{
+    MutexGuard guard (mutex);
+
+    if (count == 0 && ! (flags & EXIT))
+    {
+        // Producers signal the event only when they put the first
+        // event into an empty queue, so it has to be reset here,
+        // while the queue is known to be empty.
+        ev_consumer.reset ();
+        guard.unlock ();
+        if (msec == 0)
+            ev_consumer.wait ();
+        else
+            ev_consumer.timed_wait (msec);
+        guard.lock ();
+    }
+
+    unsigned ret_flags = flags;
+    if (count != 0)
+    {
+        bool const was_full = count == ring.size ();
+        buf->reserve (buf->size () + count);
+        while (count != 0)
+            buf->push_back (pop_front ());
+        ret_flags |= EVENT;
+
+        if (was_full)
+        {
+            guard.unlock ();
+            guard.detach ();
+            ev_producers.signal ();
+        }
+    }
+
+    return ret_flags;
+}
+
+
+void
+Queue::recycle_events (queue_storage_type * buf)
+{
+    queue_storage_type::iterator it = buf->begin ();
+
+    {
+        MutexGuard guard (mutex);
+
+        while (it != buf->end () && spare.size () < ring.size ())
+            spare.push_back (*it++);
+    }
+
+    for (; it != buf->end (); ++it)
+        spi::EventPool::release (*it);
+    buf->clear ();
+}
+
+
+unsigned long
+Queue::reset_dropped_count ()
+{
+    MutexGuard guard (mutex);
+
+    unsigned long const ret = dropped;
+    dropped = 0;
+    return ret;
+}
+
+
+spi::InternalLoggingEvent *
+Queue::pop_front ()
+{
+    spi::InternalLoggingEvent * const ev = ring[head];
+    ring[head] = 0;
+    head = (head + 1) % ring.size ();
+    --count;
+    return ev;
+}
+
+
+void
+Queue::clear ()
+{
+    while (count != 0)
+        spi::EventPool::release (pop_front ());
+    head = 0;
+}
+
+
+} } // namespace log4cplus { namespace thread {
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
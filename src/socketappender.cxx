@@ -129,7 +129,9 @@ SocketAppender::SocketAppender(const tstring& host_, int port_,
     const tstring& serverName_)
 : host(host_),
   port(port_),
-  serverName(serverName_)
+  serverName(serverName_),
+  eventBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE - sizeof(unsigned int)),
+  msgBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE)
 {
     openSocket();
     initConnector ();
@@ -139,7 +141,9 @@ SocketAppender::SocketAppender(const tstring& host_, int port_,
 
 SocketAppender::SocketAppender(const helpers::Properties & properties)
  : Appender(properties),
-   port(9998)
+   port(9998),
+   eventBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE - sizeof(unsigned int)),
+   msgBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE)
 {
     host = properties.getProperty( LOG4CPLUS_TEXT("host") );
     if(properties.exists( LOG4CPLUS_TEXT("port") )) {
@@ -229,11 +233,13 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
 
 #endif
 
-    helpers::SocketBuffer buffer = helpers::convertToBuffer(event, serverName);
-    helpers::SocketBuffer msgBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE);
-
-    msgBuffer.appendSize_t(buffer.getSize());
-    msgBuffer.appendBuffer(buffer);
+    // Appender::doAppend() serializes calls to append(), so the
+    // buffers can be reused for every event.
+    eventBuffer.clear();
+    helpers::convertToBuffer(eventBuffer, event, serverName);
+    msgBuffer.clear();
+    msgBuffer.appendSize_t(eventBuffer.getSize());
+    msgBuffer.appendBuffer(eventBuffer);
 
     bool ret = socket.write(msgBuffer);
     if (! ret)
@@ -258,7 +264,15 @@ convertToBuffer(const spi::InternalLoggingEvent& event,
     const tstring& serverName)
 {
     SocketBuffer buffer(LOG4CPLUS_MAX_MESSAGE_SIZE - sizeof(unsigned int));
+    convertToBuffer(buffer, event, serverName);
+    return buffer;
+}
 
+
+void
+convertToBuffer(SocketBuffer& buffer, const spi::InternalLoggingEvent& event,
+    const tstring& serverName)
+{
     buffer.appendByte(LOG4CPLUS_MESSAGE_VERSION);
 #ifndef UNICODE
     buffer.appendByte(1);
@@ -276,8 +290,6 @@ convertToBuffer(const spi::InternalLoggingEvent& event,
     buffer.appendInt( static_cast<unsigned int>(event.getTimestamp().usec()) );
     buffer.appendString(event.getFile());
     buffer.appendInt(event.getLine());
-
-    return buffer;
 }
 
 
@@ -36,39 +36,116 @@
 
 using namespace log4cplus;
 
-#if defined (LOG4CPLUS_SINGLE_THREADED)
-
 namespace log4cplus
 {
 
-tostringstream _macros_oss;
-
 namespace
 {
 
-static tostringstream const _macros_oss_defaults;
-static tstring const _empty_str;
+//! Messages longer than this do not keep their buffers in the cache.
+static std::size_t const _macros_oss_max_capacity = 64 * 1024;
+
+
+static
+void
+_delete_macros_oss_cache (void * p)
+{
+    _macros_oss_entry * entry = static_cast<_macros_oss_entry *>(p);
+    while (entry)
+    {
+        _macros_oss_entry * next = entry->next;
+        delete entry;
+        entry = next;
+    }
+}
+
+
+//! The key is created on first use so that the macros work even in
+//! static constructors which run before this file's initializers.
+static
+LOG4CPLUS_THREAD_LOCAL_TYPE &
+_get_macros_oss_cache ()
+{
+    static LOG4CPLUS_THREAD_LOCAL_TYPE key
+        = LOG4CPLUS_THREAD_LOCAL_INIT (_delete_macros_oss_cache);
+    return key;
+}
+
 
 } // namespace
 
-void _clear_tostringstream (tostringstream & os)
+
+_tstring_streambuf::int_type
+_tstring_streambuf::overflow (int_type c)
+{
+    if (! traits_type::eq_int_type (c, traits_type::eof ()))
+        str.push_back (traits_type::to_char_type (c));
+
+    return traits_type::not_eof (c);
+}
+
+
+std::streamsize
+_tstring_streambuf::xsputn (tchar const * s, std::streamsize n)
+{
+    str.append (s, static_cast<std::size_t>(n));
+    return n;
+}
+
+
+_macros_oss_entry::_macros_oss_entry ()
+    : stream (&buf)
+    , next (0)
+{ }
+
+
+_macros_oss_entry *
+_get_macros_oss ()
 {
-    os.clear ();
-    os.str (_empty_str);
-    os.setf (_macros_oss_defaults.flags ());
-    os.fill (_macros_oss_defaults.fill ());
-    os.precision (_macros_oss_defaults.precision ());
-    os.width (_macros_oss_defaults.width ());
+    LOG4CPLUS_THREAD_LOCAL_TYPE & cache = _get_macros_oss_cache ();
+    _macros_oss_entry * entry = static_cast<_macros_oss_entry *>(
+        LOG4CPLUS_GET_THREAD_LOCAL_VALUE (cache));
+    if (entry)
+    {
+        LOG4CPLUS_SET_THREAD_LOCAL_VALUE (cache, entry->next);
+        entry->next = 0;
+
+        // Restore the state a freshly constructed stream would have.
+        tostream & os = entry->stream;
+        os.clear ();
+        os.flags (std::ios_base::skipws | std::ios_base::dec);
+        os.fill (os.widen (' '));
+        os.precision (6);
+        os.width (0);
 #if defined (LOG4CPLUS_WORKING_LOCALE)
-    std::locale glocale = std::locale ();
-    if (os.getloc () != glocale)
-        os.imbue (glocale);
+        std::locale glocale = std::locale ();
+        if (os.getloc () != glocale)
+            os.imbue (glocale);
 #endif // defined (LOG4CPLUS_WORKING_LOCALE)
+    }
+    else
+        entry = new _macros_oss_entry;
+
+    return entry;
 }
 
-} // namespace log4cplus
 
-#endif
+void
+_put_macros_oss (_macros_oss_entry * entry)
+{
+    tstring & str = entry->buf.str;
+    if (str.capacity () > _macros_oss_max_capacity)
+        tstring ().swap (str);
+    else
+        str.clear ();
+
+    LOG4CPLUS_THREAD_LOCAL_TYPE & cache = _get_macros_oss_cache ();
+    entry->next = static_cast<_macros_oss_entry *>(
+        LOG4CPLUS_GET_THREAD_LOCAL_VALUE (cache));
+    LOG4CPLUS_SET_THREAD_LOCAL_VALUE (cache, entry);
+}
+
+} // namespace log4cplus
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -233,10 +233,9 @@ log4cplus::SysLogAppender::append(const spi::InternalLoggingEvent& event)
 {
     int level = getSysLogLevel(event.getLogLevel());
     if(level != -1) {
-        log4cplus::tostringstream buf;
-        layout->formatAndAppend(buf, event);
+        const log4cplus::tstring& text = formatEvent(event);
         ::syslog(facility | level, "%s",
-            LOG4CPLUS_TSTRING_TO_STRING(buf.str()).c_str());
+            LOG4CPLUS_TSTRING_TO_STRING(text).c_str());
     }
 }
 
@@ -22,6 +22,9 @@
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/streams.h>
 #include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/thread-config.h>
+#include <log4cplus/helpers/syncprims.h>
 
 #include <algorithm>
 #include <stdexcept>
@@ -55,6 +58,15 @@
 #define LOG4CPLUS_NEED_LOCALTIME_R
 #endif
 
+// The TSC clock needs the x86 time stamp counter and, unless there is
+// just one thread, atomic operations to publish its calibration.
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__)) \
+    && defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) \
+    && (defined (LOG4CPLUS_HAVE_ATOMICS) || defined (LOG4CPLUS_SINGLE_THREADED))
+#define LOG4CPLUS_HAVE_TSC_CLOCK
+#include <cpuid.h>
+#endif
+
 
 namespace log4cplus { namespace helpers {
 
@@ -89,39 +101,62 @@ using std::strftime;
 // Time ctors
 //////////////////////////////////////////////////////////////////////////////
 
-Time::Time()
-: tv_sec(0),
-  tv_usec(0)
-{
-}
-
-
 Time::Time(time_t tv_sec_, long tv_usec_)
-: tv_sec(tv_sec_),
-  tv_usec(tv_usec_)
+: ns(static_cast<time_ns_type>(tv_sec_) * NSEC_PER_SEC
+     + static_cast<time_ns_type>(tv_usec_) * NSEC_PER_USEC)
 {
-    assert (tv_usec < ONE_SEC_IN_USEC);
+    assert (tv_usec_ < ONE_SEC_IN_USEC);
 }
 
 
 Time::Time(time_t time)
-: tv_sec(time),
-  tv_usec(0)
+: ns(static_cast<time_ns_type>(time) * NSEC_PER_SEC)
 {
 }
 
 
-Time
-Time::gettimeofday()
+
+//////////////////////////////////////////////////////////////////////////////
+// Clock sources
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
 {
+
+ClockSource volatile clock_source = REALTIME_CLOCK;
+
+
 #if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME)
+static
+time_ns_type
+read_clock (clockid_t id)
+{
     struct timespec ts;
-    int res = clock_gettime (CLOCK_REALTIME, &ts);
+    int res = clock_gettime (id, &ts);
     assert (res == 0);
     if (res != 0)
         throw std::runtime_error ("clock_gettime() has failed");
 
-    return Time (ts.tv_sec, ts.tv_nsec / 1000);
+    return static_cast<time_ns_type>(ts.tv_sec) * Time::NSEC_PER_SEC
+        + ts.tv_nsec;
+}
+
+
+#if defined (CLOCK_MONOTONIC)
+//! Difference between CLOCK_REALTIME and CLOCK_MONOTONIC when
+//! MONOTONIC_CLOCK has been selected.
+time_ns_type monotonic_offset;
+#endif
+
+#endif // defined (LOG4CPLUS_HAVE_CLOCK_GETTIME)
+
+
+static
+Time
+read_realtime ()
+{
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME)
+    return Time::fromNanoseconds (read_clock (CLOCK_REALTIME));
 #elif defined(LOG4CPLUS_HAVE_GETTIMEOFDAY)
     timeval tp;
     ::gettimeofday(&tp, 0);
@@ -139,6 +174,259 @@ Time::gettimeofday()
 }
 
 
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+
+__extension__ typedef unsigned long long tsc_type;
+
+
+static inline
+tsc_type
+read_tsc ()
+{
+    unsigned lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return (static_cast<tsc_type>(hi) << 32) | lo;
+}
+
+
+//! Linear mapping of TSC ticks to wall time.
+struct TscCalibration
+{
+    tsc_type base_tsc;
+    time_ns_type base_ns;
+    //! Nanoseconds per tick, 32.32 fixed point.
+    tsc_type mult;
+    //! Ticks after base_tsc past which the mapping is renewed.
+    tsc_type limit;
+};
+
+
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+#define LOG4CPLUS_TSC_BARRIER() do { } while (0)
+#else
+#define LOG4CPLUS_TSC_BARRIER() LOG4CPLUS_MEMORY_BARRIER ()
+#endif
+
+//! The calibration is published as a sequence lock: writers make
+//! tsc_seq odd while they update tsc_cal.
+unsigned volatile tsc_seq;
+TscCalibration tsc_cal;
+//! Non-zero while a thread is renewing the calibration.
+unsigned volatile tsc_updating;
+
+
+static
+bool
+tsc_is_invariant ()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (! __get_cpuid (0x80000007u, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    return (edx & (1u << 8)) != 0;
+}
+
+
+static
+void
+publish_tsc_calibration (TscCalibration const & cal)
+{
+    ++tsc_seq;
+    LOG4CPLUS_TSC_BARRIER ();
+    tsc_cal = cal;
+    LOG4CPLUS_TSC_BARRIER ();
+    ++tsc_seq;
+}
+
+
+//! Reads CLOCK_REALTIME and the TSC value at the same moment, as
+//! closely as possible.
+static
+time_ns_type
+read_realtime_and_tsc (tsc_type & tsc)
+{
+    tsc_type const before = read_tsc ();
+    time_ns_type const ns = read_clock (CLOCK_REALTIME);
+    tsc_type const after = read_tsc ();
+    tsc = before + (after - before) / 2;
+    return ns;
+}
+
+
+static
+TscCalibration
+make_tsc_calibration (tsc_type tsc0, time_ns_type ns0, tsc_type tsc1,
+    time_ns_type ns1)
+{
+    TscCalibration cal;
+    cal.base_tsc = tsc1;
+    cal.base_ns = ns1;
+    double const ns_per_tick = static_cast<double>(ns1 - ns0)
+        / static_cast<double>(tsc1 - tsc0);
+    cal.mult = static_cast<tsc_type>(ns_per_tick * 4294967296.0);
+    // Renew the calibration after a second, which also keeps
+    // the product in tsc_to_ns() from overflowing.
+    cal.limit = static_cast<tsc_type>(Time::NSEC_PER_SEC / ns_per_tick);
+    return cal;
+}
+
+
+static
+bool
+calibrate_tsc ()
+{
+    if (! tsc_is_invariant ())
+        return false;
+
+    tsc_type tsc0, tsc1;
+    time_ns_type const ns0 = read_realtime_and_tsc (tsc0);
+    sleepmillis (10);
+    time_ns_type const ns1 = read_realtime_and_tsc (tsc1);
+    if (tsc1 <= tsc0 || ns1 <= ns0)
+        return false;
+
+    publish_tsc_calibration (make_tsc_calibration (tsc0, ns0, tsc1, ns1));
+    return true;
+}
+
+
+static
+time_ns_type
+read_tsc_clock ()
+{
+    tsc_type const now = read_tsc ();
+    TscCalibration cal;
+    unsigned seq;
+    do
+    {
+        seq = tsc_seq;
+        LOG4CPLUS_TSC_BARRIER ();
+        cal = tsc_cal;
+        LOG4CPLUS_TSC_BARRIER ();
+    }
+    while ((seq & 1) || seq != tsc_seq);
+
+    tsc_type const delta = now - cal.base_tsc;
+    if (now >= cal.base_tsc && delta < cal.limit)
+        return cal.base_ns + static_cast<time_ns_type>((delta * cal.mult) >> 32);
+
+    // The calibration is too old. Read the wall clock and let one of
+    // the threads that got here renew the calibration.
+    tsc_type tsc;
+    time_ns_type const ns = read_realtime_and_tsc (tsc);
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    if (tsc > cal.base_tsc && ns > cal.base_ns)
+        publish_tsc_calibration (
+            make_tsc_calibration (cal.base_tsc, cal.base_ns, tsc, ns));
+#else
+    if (LOG4CPLUS_ATOMIC_INCREMENT (tsc_updating) == 1
+        && tsc > cal.base_tsc && ns > cal.base_ns)
+        publish_tsc_calibration (
+            make_tsc_calibration (cal.base_tsc, cal.base_ns, tsc, ns));
+    LOG4CPLUS_ATOMIC_DECREMENT (tsc_updating);
+#endif
+
+    return ns;
+}
+
+#endif // defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+
+} // namespace
+
+
+ClockSource
+setClockSource (ClockSource source)
+{
+    switch (source)
+    {
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_REALTIME_COARSE)
+    case COARSE_CLOCK:
+    {
+        struct timespec ts;
+        if (clock_gettime (CLOCK_REALTIME_COARSE, &ts) != 0)
+            source = REALTIME_CLOCK;
+        break;
+    }
+#endif
+
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_MONOTONIC)
+    case MONOTONIC_CLOCK:
+    {
+        struct timespec ts;
+        if (clock_gettime (CLOCK_MONOTONIC, &ts) != 0)
+            source = REALTIME_CLOCK;
+        else
+            monotonic_offset = read_clock (CLOCK_REALTIME)
+                - read_clock (CLOCK_MONOTONIC);
+        break;
+    }
+#endif
+
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+    case TSC_CLOCK:
+        if (! calibrate_tsc ())
+            source = REALTIME_CLOCK;
+        break;
+#endif
+
+    case REALTIME_CLOCK:
+        break;
+
+    default:
+        source = REALTIME_CLOCK;
+    }
+
+    clock_source = source;
+    return source;
+}
+
+
+ClockSource
+getClockSource ()
+{
+    return clock_source;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// Time static methods
+//////////////////////////////////////////////////////////////////////////////
+
+Time
+Time::gettimeofday()
+{
+    switch (clock_source)
+    {
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+    case TSC_CLOCK:
+        return fromNanoseconds (read_tsc_clock ());
+#endif
+
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_REALTIME_COARSE)
+    case COARSE_CLOCK:
+        return fromNanoseconds (read_clock (CLOCK_REALTIME_COARSE));
+#endif
+
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_MONOTONIC)
+    case MONOTONIC_CLOCK:
+        return fromNanoseconds (read_clock (CLOCK_MONOTONIC)
+            + monotonic_offset);
+#endif
+
+    default:
+        return read_realtime ();
+    }
+}
+
+
+Time
+Time::realtime()
+{
+    return read_realtime ();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Time methods
 //////////////////////////////////////////////////////////////////////////////
@@ -148,7 +436,7 @@ Time::setTime(tm* t)
 {
     time_t time = helpers::mktime(t);
     if (time != -1)
-        tv_sec = time;
+        sec(time);
 
     return time;
 }
@@ -157,14 +445,14 @@ Time::setTime(tm* t)
 time_t
 Time::getTime() const
 {
-    return tv_sec;
+    return sec();
 }
 
 
 void
 Time::gmtime(tm* t) const
 {
-    time_t clock = tv_sec;
+    time_t clock = sec();
 #ifdef LOG4CPLUS_NEED_GMTIME_R
     ::gmtime_r(&clock, t);
 #else
@@ -177,7 +465,7 @@ Time::gmtime(tm* t) const
 void
 Time::localtime(tm* t) const
 {
-    time_t clock = tv_sec;
+    time_t clock = sec();
 #ifdef LOG4CPLUS_NEED_LOCALTIME_R
     ::localtime_r(&clock, t);
 #else
@@ -212,7 +500,7 @@ static log4cplus::tstring const uc_q_padding_zeros[4] =
 void
 Time::build_q_value (log4cplus::tstring & q_str) const
 {
-    q_str = convertIntegerToString(tv_usec / 1000);
+    q_str = convertIntegerToString(usec() / 1000);
     size_t const len = q_str.length();
     if (len <= 2)
         q_str.insert (0, padding_zeros[q_str.length()]);
@@ -224,7 +512,7 @@ Time::build_uc_q_value (log4cplus::tstring & uc_q_str) const
 {
     build_q_value (uc_q_str);
 
-    log4cplus::tstring usecs (convertIntegerToString(tv_usec % 1000));
+    log4cplus::tstring usecs (convertIntegerToString(usec() % 1000));
     size_t usecs_len = usecs.length();
     usecs.insert (0, usecs_len <= 3 
                   ? uc_q_padding_zeros[usecs_len] : uc_q_padding_zeros[3]);
@@ -315,7 +603,7 @@ Time::getFormattedTime(const log4cplus::tstring& fmt_orig, bool use_gmtime) cons
             {
                 if (! s_str_valid)
                 {
-                    convertIntegerToString (s_str, tv_sec);
+                    convertIntegerToString (s_str, sec());
                     s_str_valid = true;
                 }
                 ret.append (s_str);
@@ -379,60 +667,580 @@ Time::getFormattedTime(const log4cplus::tstring& fmt_orig, bool use_gmtime) cons
 }
 
 
-Time&
-Time::operator+=(const Time& rhs)
+//////////////////////////////////////////////////////////////////////////////
+// TimeFormatter
+//////////////////////////////////////////////////////////////////////////////
+
+//! Rendered text of one second for one formatter.
+struct TimeFormatter::CacheEntry
+{
+    //! Id of the formatter, zero when the entry is not valid.
+    unsigned long id;
+    //! The second the text was rendered for.
+    time_t second;
+    //! Rendered text with zeros in place of the %q and %Q fields.
+    log4cplus::tstring text;
+    //! Offsets of the %q and %Q fields in the text.
+    std::vector<std::size_t> offsets;
+};
+
+
+namespace
 {
-    tv_sec += rhs.tv_sec;
-    tv_usec += rhs.tv_usec;
 
-    if(tv_usec > ONE_SEC_IN_USEC) {
-        ++tv_sec;
-        tv_usec -= ONE_SEC_IN_USEC;
+//! Number of formatters one thread can use without evicting each
+//! other's entries.
+static std::size_t const time_format_cache_size = 8;
+
+
+struct TimeFormatCache
+{
+    TimeFormatter::CacheEntry entries[time_format_cache_size];
+
+    //! Local time UTC offset in seconds, valid for times in the
+    //! interval [offset_from, offset_to).
+    long offset;
+    time_t offset_from;
+    time_t offset_to;
+};
+
+
+static
+void
+delete_time_format_cache (void * p)
+{
+    delete static_cast<TimeFormatCache *>(p);
+}
+
+
+static
+LOG4CPLUS_THREAD_LOCAL_TYPE &
+get_time_format_cache_key ()
+{
+    static LOG4CPLUS_THREAD_LOCAL_TYPE key
+        = LOG4CPLUS_THREAD_LOCAL_INIT (delete_time_format_cache);
+    return key;
+}
+
+
+static
+TimeFormatCache *
+get_time_format_cache ()
+{
+    LOG4CPLUS_THREAD_LOCAL_TYPE & key = get_time_format_cache_key ();
+    TimeFormatCache * cache = static_cast<TimeFormatCache *>(
+        LOG4CPLUS_GET_THREAD_LOCAL_VALUE (key));
+    if (! cache)
+    {
+        cache = new TimeFormatCache;
+        for (std::size_t i = 0; i != time_format_cache_size; ++i)
+            cache->entries[i].id = 0;
+        cache->offset = 0;
+        cache->offset_from = 0;
+        cache->offset_to = 0;
+        LOG4CPLUS_SET_THREAD_LOCAL_VALUE (key, cache);
     }
 
-    return *this;
+    return cache;
+}
+
+
+//! Returns a new formatter id. Ids are never reused, so that entries
+//! of a destroyed formatter cannot be mistaken for those of a new
+//! one at the same address.
+static
+unsigned long
+next_time_formatter_id ()
+{
+    static unsigned long volatile last_id = 0;
+    unsigned long id;
+
+#if defined (LOG4CPLUS_HAVE_ATOMICS)
+    id = LOG4CPLUS_ATOMIC_INCREMENT (last_id);
+#elif defined (LOG4CPLUS_SINGLE_THREADED)
+    id = ++last_id;
+#else
+    static thread::Mutex mutex (thread::Mutex::DEFAULT);
+    thread::MutexGuard guard (mutex);
+    id = ++last_id;
+#endif
+
+    // Zero marks unused cache entries.
+    return id != 0 ? id : next_time_formatter_id ();
 }
 
 
-Time&
-Time::operator-=(const Time& rhs)
+//! Writes three decimal digits of value.
+static inline
+void
+put_three_digits (tchar * p, long value)
 {
-    tv_sec -= rhs.tv_sec;
-    tv_usec -= rhs.tv_usec;
+    p[0] = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value / 100);
+    p[1] = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value / 10 % 10);
+    p[2] = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value % 10);
+}
 
-    if(tv_usec < 0) {
-        --tv_sec;
-        tv_usec += ONE_SEC_IN_USEC;
+
+//! Returns the number of days from 1970-01-01 to the given date of
+//! the proleptic Gregorian calendar.
+static
+long
+days_from_civil (long y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    long const era = (y >= 0 ? y : y - 399) / 400;
+    unsigned const yoe = static_cast<unsigned>(y - era * 400);
+    unsigned const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+
+//! Inverse of days_from_civil().
+static
+void
+civil_from_days (long z, long & y, unsigned & m, unsigned & d)
+{
+    z += 719468;
+    long const era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned const doe = static_cast<unsigned>(z - era * 146097);
+    unsigned const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096)
+        / 365;
+    unsigned const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned const mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<long>(yoe) + era * 400 + (m <= 2);
+}
+
+
+//! Returns the UTC offset of local time at the given time using
+//! localtime().
+static
+long
+compute_utc_offset (time_t s)
+{
+    tm lt;
+    Time (s).localtime (&lt);
+    time_t const local
+        = static_cast<time_t>(days_from_civil (lt.tm_year + 1900,
+            lt.tm_mon + 1, lt.tm_mday)) * 86400
+        + lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec;
+    return static_cast<long>(local - s);
+}
+
+
+//! Returns the UTC offset of local time at the given time. The offset
+//! is looked up only when the time is outside of the interval the
+//! cached offset is valid for. The new interval spans an hour back
+//! and a day ahead, up to the nearest offset change, which is found
+//! by bisection. Offsets are assumed not to change more than once
+//! within a day.
+static
+long
+get_utc_offset (time_t s)
+{
+    TimeFormatCache * const cache = get_time_format_cache ();
+    if (cache->offset_from <= s && s < cache->offset_to)
+        return cache->offset;
+
+    long const offset = compute_utc_offset (s);
+
+    time_t from = s - 3600;
+    if (compute_utc_offset (from) != offset)
+        from = s;
+
+    time_t to = s + 86400;
+    if (compute_utc_offset (to) != offset)
+    {
+        // Find the first second with a different offset.
+        time_t same = s;
+        while (to - same > 1)
+        {
+            time_t const mid = same + (to - same) / 2;
+            if (compute_utc_offset (mid) == offset)
+                same = mid;
+            else
+                to = mid;
+        }
     }
 
-    return *this;
+    cache->offset = offset;
+    cache->offset_from = from;
+    cache->offset_to = to;
+    return offset;
 }
 
 
-Time&
-Time::operator/=(long rhs)
+//! Appends value as a decimal number padded to width with pad
+//! characters.
+static
+void
+append_padded (log4cplus::tstring & str, long value, std::size_t width,
+    tchar pad = LOG4CPLUS_TEXT ('0'))
 {
-    long rem_secs = static_cast<long>(tv_sec % rhs);
-    tv_sec /= rhs;
-    
-    tv_usec /= rhs;
-    tv_usec += static_cast<long>((rem_secs * ONE_SEC_IN_USEC) / rhs);
+    tchar buf[16];
+    tchar * const end = buf + sizeof (buf) / sizeof (buf[0]);
+    tchar * p = end;
+    do
+    {
+        *--p = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    while (static_cast<std::size_t>(end - p) < width)
+        *--p = pad;
+    str.append (p, end);
+}
+
+
+//! Appended to every piece passed to strftime() so that it never
+//! produces empty output, which it cannot tell from an error.
+static tchar const piece_terminator = LOG4CPLUS_TEXT ('.');
+
+} // namespace
+
+
+TimeFormatter::TimeFormatter (const log4cplus::tstring& fmt,
+    bool use_gmtime_)
+    : format (fmt)
+    , use_gmtime (use_gmtime_)
+    , cacheable (true)
+    , compiled (false)
+    , id (next_time_formatter_id ())
+{
+    // Split the format at %q and %Q the same way
+    // Time::getFormattedTime() walks it. strftime() stops at NUL
+    // character, which would cut the pieces differently from the
+    // whole format, so such formats are not cached.
+    if (format.find (LOG4CPLUS_TEXT ('\0')) != log4cplus::tstring::npos)
+    {
+        cacheable = false;
+        return;
+    }
+
+    log4cplus::tstring piece;
+    bool percent = false;
+    for (log4cplus::tstring::const_iterator it = format.begin ();
+         it != format.end (); ++it)
+    {
+        if (! percent)
+        {
+            if (*it == LOG4CPLUS_TEXT ('%'))
+                percent = true;
+            else
+                piece.push_back (*it);
+        }
+        else
+        {
+            if (*it == LOG4CPLUS_TEXT ('q') || *it == LOG4CPLUS_TEXT ('Q'))
+            {
+                pieces.push_back (piece);
+                piece.clear ();
+                fields.push_back (*it);
+            }
+            else
+            {
+                piece.push_back (LOG4CPLUS_TEXT ('%'));
+                piece.push_back (*it);
+            }
+            percent = false;
+        }
+    }
+    // A trailing lone % sign is dropped, like getFormattedTime() does.
+    pieces.push_back (piece);
 
-    return *this;
+    compile ();
 }
 
 
-Time&
-Time::operator*=(long rhs)
+TimeFormatter::~TimeFormatter ()
+{ }
+
+
+void
+TimeFormatter::compile ()
 {
-    long new_usec = tv_usec * rhs;
-    long overflow_sec = new_usec / ONE_SEC_IN_USEC;
-    tv_usec = new_usec % ONE_SEC_IN_USEC;
+    Directive literal;
+    literal.spec = 0;
+    Directive field;
+
+    bool percent = false;
+    for (log4cplus::tstring::const_iterator it = format.begin ();
+         it != format.end (); ++it)
+    {
+        tchar const c = *it;
+        if (! percent)
+        {
+            if (c == LOG4CPLUS_TEXT ('%'))
+                percent = true;
+            else
+                literal.text.push_back (c);
+            continue;
+        }
+
+        percent = false;
+        tchar const * expansion = 0;
+        switch (c)
+        {
+        case LOG4CPLUS_TEXT ('%'):
+            literal.text.push_back (LOG4CPLUS_TEXT ('%'));
+            continue;
+
+        case LOG4CPLUS_TEXT ('n'):
+            literal.text.push_back (LOG4CPLUS_TEXT ('\n'));
+            continue;
+
+        case LOG4CPLUS_TEXT ('t'):
+            literal.text.push_back (LOG4CPLUS_TEXT ('\t'));
+            continue;
+
+        case LOG4CPLUS_TEXT ('F'):
+            expansion = LOG4CPLUS_TEXT ("Y-m-d");
+            break;
+
+        case LOG4CPLUS_TEXT ('T'):
+            expansion = LOG4CPLUS_TEXT ("H:M:S");
+            break;
+
+        case LOG4CPLUS_TEXT ('Y'):
+        case LOG4CPLUS_TEXT ('y'):
+        case LOG4CPLUS_TEXT ('m'):
+        case LOG4CPLUS_TEXT ('d'):
+        case LOG4CPLUS_TEXT ('e'):
+        case LOG4CPLUS_TEXT ('j'):
+        case LOG4CPLUS_TEXT ('H'):
+        case LOG4CPLUS_TEXT ('M'):
+        case LOG4CPLUS_TEXT ('S'):
+        case LOG4CPLUS_TEXT ('s'):
+        case LOG4CPLUS_TEXT ('z'):
+        case LOG4CPLUS_TEXT ('q'):
+        case LOG4CPLUS_TEXT ('Q'):
+            break;
+
+        default:
+            // Anything else is left to strftime().
+            program.clear ();
+            return;
+        }
+
+        if (! literal.text.empty ())
+        {
+            program.push_back (literal);
+            literal.text.clear ();
+        }
+
+        if (expansion)
+        {
+            // Expansions are specifiers separated by one literal
+            // character each.
+            for (; *expansion; ++expansion)
+            {
+                if (*expansion == LOG4CPLUS_TEXT ('-')
+                    || *expansion == LOG4CPLUS_TEXT (':'))
+                {
+                    literal.text.assign (1, *expansion);
+                    program.push_back (literal);
+                    literal.text.clear ();
+                }
+                else
+                {
+                    field.spec = *expansion;
+                    program.push_back (field);
+                }
+            }
+        }
+        else
+        {
+            field.spec = c;
+            program.push_back (field);
+        }
+    }
 
-    tv_sec *= rhs;
-    tv_sec += overflow_sec;
+    if (! literal.text.empty ())
+        program.push_back (literal);
 
-    return *this;
+    compiled = true;
+}
+
+
+bool
+TimeFormatter::renderCompiled (CacheEntry & entry, const Time & t) const
+{
+    time_t const secs = t.sec ();
+    long const offset = use_gmtime ? 0 : get_utc_offset (secs);
+    time_t const local = secs + offset;
+
+    long days = static_cast<long>(local / 86400);
+    long sod = static_cast<long>(local % 86400);
+    if (sod < 0)
+    {
+        sod += 86400;
+        days -= 1;
+    }
+
+    long year;
+    unsigned month, day;
+    civil_from_days (days, year, month, day);
+
+    // strftime() pads years differently across platforms.
+    if (year < 1000 || year > 9999)
+        return false;
+
+    for (std::vector<Directive>::const_iterator it = program.begin ();
+         it != program.end (); ++it)
+    {
+        switch (it->spec)
+        {
+        case 0:
+            entry.text += it->text;
+            break;
+
+        case LOG4CPLUS_TEXT ('Y'):
+            append_padded (entry.text, year, 4);
+            break;
+
+        case LOG4CPLUS_TEXT ('y'):
+            append_padded (entry.text, year % 100, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('m'):
+            append_padded (entry.text, month, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('d'):
+            append_padded (entry.text, day, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('e'):
+            append_padded (entry.text, day, 2, LOG4CPLUS_TEXT (' '));
+            break;
+
+        case LOG4CPLUS_TEXT ('j'):
+            append_padded (entry.text,
+                days - days_from_civil (year, 1, 1) + 1, 3);
+            break;
+
+        case LOG4CPLUS_TEXT ('H'):
+            append_padded (entry.text, sod / 3600, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('M'):
+            append_padded (entry.text, sod / 60 % 60, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('S'):
+            append_padded (entry.text, sod % 60, 2);
+            break;
+
+        case LOG4CPLUS_TEXT ('s'):
+            entry.text += convertIntegerToString (secs);
+            break;
+
+        case LOG4CPLUS_TEXT ('z'):
+        {
+            long const minutes = (offset < 0 ? -offset : offset) / 60;
+            entry.text.push_back (offset < 0
+                ? LOG4CPLUS_TEXT ('-') : LOG4CPLUS_TEXT ('+'));
+            append_padded (entry.text, minutes / 60 * 100 + minutes % 60,
+                4);
+            break;
+        }
+
+        case LOG4CPLUS_TEXT ('q'):
+        case LOG4CPLUS_TEXT ('Q'):
+            entry.offsets.push_back (entry.text.size ());
+            entry.text.append (it->spec == LOG4CPLUS_TEXT ('q') ? 3 : 7,
+                LOG4CPLUS_TEXT ('0'));
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+void
+TimeFormatter::render (CacheEntry & entry, const Time & t) const
+{
+    entry.id = 0;
+    entry.text.clear ();
+    entry.offsets.clear ();
+
+    if (compiled && renderCompiled (entry, t))
+    {
+        entry.second = t.sec ();
+        entry.id = id;
+        return;
+    }
+
+    entry.text.clear ();
+    entry.offsets.clear ();
+    log4cplus::tstring piece_fmt;
+    for (std::size_t i = 0; i != pieces.size (); ++i)
+    {
+        if (! pieces[i].empty ())
+        {
+            piece_fmt = pieces[i];
+            piece_fmt.push_back (piece_terminator);
+            entry.text += t.getFormattedTime (piece_fmt, use_gmtime);
+            entry.text.resize (entry.text.size () - 1);
+        }
+
+        if (i != fields.size ())
+        {
+            entry.offsets.push_back (entry.text.size ());
+            entry.text.append (fields[i] == LOG4CPLUS_TEXT ('q') ? 3 : 7,
+                LOG4CPLUS_TEXT ('0'));
+        }
+    }
+
+    entry.second = t.sec ();
+    entry.id = id;
+}
+
+
+void
+TimeFormatter::appendFormattedTime (log4cplus::tstring & str,
+    const Time & t) const
+{
+    if (! cacheable)
+    {
+        str += t.getFormattedTime (format, use_gmtime);
+        return;
+    }
+
+    CacheEntry & entry
+        = get_time_format_cache ()->entries[id % time_format_cache_size];
+    if (entry.id != id || entry.second != t.sec ())
+        render (entry, t);
+
+    std::size_t const base = str.size ();
+    str += entry.text;
+    if (fields.empty ())
+        return;
+
+    long const usecs = t.usec ();
+    tchar * const p = &str[base];
+    for (std::size_t i = 0; i != fields.size (); ++i)
+    {
+        tchar * const q = p + entry.offsets[i];
+        put_three_digits (q, usecs / 1000);
+        if (fields[i] == LOG4CPLUS_TEXT ('Q'))
+        {
+            q[3] = LOG4CPLUS_TEXT ('.');
+            put_three_digits (q + 4, usecs % 1000);
+        }
+    }
+}
+
+
+log4cplus::tstring
+TimeFormatter::getFormattedTime (const Time & t) const
+{
+    log4cplus::tstring ret;
+    appendFormattedTime (ret, t);
+    return ret;
 }
 
 
@@ -472,40 +1280,35 @@ operator*(const Time& lhs, long rhs)
 bool
 operator<(const Time& lhs, const Time& rhs)
 {
-    return (   (lhs.sec() < rhs.sec())
-            || (   (lhs.sec() == rhs.sec()) 
-                && (lhs.usec() < rhs.usec())) );
+    return lhs.nanoseconds() < rhs.nanoseconds();
 }
 
 
 bool
 operator<=(const Time& lhs, const Time& rhs)
 {
-    return ((lhs < rhs) || (lhs == rhs));
+    return lhs.nanoseconds() <= rhs.nanoseconds();
 }
 
 
 bool
 operator>(const Time& lhs, const Time& rhs)
 {
-    return (   (lhs.sec() > rhs.sec())
-            || (   (lhs.sec() == rhs.sec()) 
-                && (lhs.usec() > rhs.usec())) );
+    return lhs.nanoseconds() > rhs.nanoseconds();
 }
 
 
 bool
 operator>=(const Time& lhs, const Time& rhs)
 {
-    return ((lhs > rhs) || (lhs == rhs));
+    return lhs.nanoseconds() >= rhs.nanoseconds();
 }
 
 
 bool
 operator==(const Time& lhs, const Time& rhs)
 {
-    return (   lhs.sec() == rhs.sec()
-            && lhs.usec() == rhs.usec());
+    return lhs.nanoseconds() == rhs.nanoseconds();
 }
 
 
@@ -0,0 +1,784 @@
+//   Copyright (C) 2026, agent. All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without modifica-
+//   tion, are permitted provided that the following conditions are met:
+//
+//   1. Redistributions of  source code must  retain the above copyright  notice,
+//      this list of conditions and the following disclaimer.
+//
+//   2. Redistributions in binary form must reproduce the above copyright notice,
+//      this list of conditions and the following disclaimer in the documentation
+//      and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//   FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//   APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//   INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//   DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//   OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//   ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//   (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//   THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/config.hxx>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <log4cplus/helpers/uringfileoutput.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/threads.h>
+#include <log4cplus/streams.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined (__linux__) && defined (__has_include)
+#  if __has_include (<linux/io_uring.h>)
+#    include <linux/io_uring.h>
+#    include <sys/syscall.h>
+#    if defined (__NR_io_uring_setup) && defined (__NR_io_uring_enter) \
+        && defined (__NR_io_uring_register)
+#      define LOG4CPLUS_HAVE_IO_URING
+#    endif
+#  endif
+#endif
+
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+//! Value of <code>current</code> when no buffer is being filled.
+unsigned const NO_SLOT = static_cast<unsigned>(-1);
+
+//! User data of the sync operation.
+unsigned const SYNC_OP = static_cast<unsigned>(-2);
+
+//! User data of the operation that stops the reaper thread.
+unsigned const EXIT_OP = static_cast<unsigned>(-1);
+
+
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+
+static
+int
+sys_io_uring_setup (unsigned entries, io_uring_params * params)
+{
+    return static_cast<int>(::syscall (__NR_io_uring_setup, entries, params));
+}
+
+
+static
+int
+sys_io_uring_enter (int fd, unsigned toSubmit, unsigned minComplete,
+    unsigned flags)
+{
+    return static_cast<int>(::syscall (__NR_io_uring_enter, fd, toSubmit,
+        minComplete, flags, static_cast<void *>(0), 0));
+}
+
+
+static
+int
+sys_io_uring_register (int fd, unsigned opcode, void const * arg,
+    unsigned count)
+{
+    return static_cast<int>(::syscall (__NR_io_uring_register, fd, opcode,
+        arg, count));
+}
+
+
+//! Reads index of the ring written by the kernel.
+static inline
+unsigned
+load_acquire (unsigned const * p)
+{
+    return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+
+//! Publishes index of the ring to the kernel.
+static inline
+void
+store_release (unsigned * p, unsigned value)
+{
+    __atomic_store_n (p, value, __ATOMIC_RELEASE);
+}
+
+#endif // LOG4CPLUS_HAVE_IO_URING
+
+} // namespace
+
+
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+
+//! Ring file descriptor and the mapped queues.
+struct UringFileOutput::Ring
+{
+    int fd;
+
+    void * sqMap;
+    std::size_t sqMapSize;
+    unsigned * sqHead;
+    unsigned * sqTail;
+    unsigned sqMask;
+    unsigned * sqArray;
+    io_uring_sqe * sqes;
+    std::size_t sqesSize;
+    //! Operations queued but not passed to the kernel yet.
+    unsigned unsubmitted;
+
+    void * cqMap;
+    std::size_t cqMapSize;
+    unsigned * cqHead;
+    unsigned * cqTail;
+    unsigned cqMask;
+    io_uring_cqe * cqes;
+};
+
+#else
+
+struct UringFileOutput::Ring
+{ };
+
+#endif
+
+
+class UringFileOutput::Reaper
+    : public thread::AbstractThread
+{
+public:
+    Reaper (UringFileOutput & out)
+        : output (out)
+    { }
+
+    virtual void run ()
+    {
+        output.reap ();
+    }
+
+private:
+    UringFileOutput & output;
+};
+
+
+UringFileOutput::UringFileOutput (std::size_t bufferSize, unsigned depth)
+    : FileOutput (0)
+    , ring (0)
+    , queueDepth ((std::max) (depth, 1u))
+    , slotSize (0)
+    , current (NO_SLOT)
+    , mutex (thread::Mutex::DEFAULT)
+    , completed_ev (false)
+    , inFlight (0)
+    , ioError (0)
+    , syncResult (0)
+    , syncDone (false)
+    , ringFailed (false)
+{
+    setupRing ();
+    allocSlots (bufferSize);
+}
+
+
+UringFileOutput::~UringFileOutput ()
+{
+    close ();
+    closeRing ();
+    freeSlots ();
+}
+
+
+void
+UringFileOutput::close ()
+{
+    if (fd == -1)
+        return;
+
+    waitIdle ();
+    FileOutput::close ();
+}
+
+
+void
+UringFileOutput::write (char const * data, std::size_t len)
+{
+    if (len == 0 || ! good ())
+        return;
+
+    size += len;
+    while (len != 0)
+    {
+        if (current == NO_SLOT)
+            acquireSlot ();
+
+        // A buffer can end in the middle of an event, every buffer is
+        // written at its own offset.
+        Slot & slot = slots[current];
+        std::size_t const n = (std::min) (len, slotSize - slot.len);
+        std::memcpy (slot.data + slot.len, data, n);
+        slot.len += n;
+        used += n;
+        data += n;
+        len -= n;
+
+        if (slot.len == slotSize)
+            flush ();
+    }
+}
+
+
+void
+UringFileOutput::flush ()
+{
+    if (current != NO_SLOT && slots[current].len != 0)
+    {
+        Slot & slot = slots[current];
+        if (good ())
+        {
+            slot.fd = fd;
+            slot.offset = written;
+            slot.done = 0;
+            preallocate (written + slot.len);
+            written += slot.len;
+
+            thread::MutexGuard guard (mutex);
+            if (ringFailed)
+            {
+                // The error is reported by checkError() below.
+                slot.len = 0;
+                freeList.push_back (current);
+            }
+            else
+            {
+                ++inFlight;
+                slot.queued = true;
+                queueWrite (current);
+                submitQueued ();
+            }
+            current = NO_SLOT;
+        }
+        else
+            // The buffered bytes are lost.
+            slot.len = 0;
+
+        used = 0;
+        dropCacheBehind (written);
+    }
+
+    checkError ();
+}
+
+
+void
+UringFileOutput::sync ()
+{
+    waitIdle ();
+    if (! good ())
+        return;
+
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    int result;
+    {
+        thread::MutexGuard guard (mutex);
+        syncDone = ringFailed;
+        syncResult = -EIO;
+        if (! ringFailed)
+        {
+            ++inFlight;
+            queueOp (IORING_OP_FSYNC, fd, SYNC_OP);
+            submitQueued ();
+        }
+        while (! syncDone)
+        {
+            completed_ev.reset ();
+            guard.unlock ();
+            completed_ev.wait ();
+            guard.lock ();
+        }
+        result = syncResult;
+    }
+
+    if (result < 0)
+        reportError (LOG4CPLUS_TEXT ("fdatasync"), -result);
+#endif
+}
+
+
+int
+UringFileOutput::dupForSync ()
+{
+    int const ret = FileOutput::dupForSync ();
+    waitIdle ();
+    return ret;
+}
+
+
+int
+UringFileOutput::exchange (int newFd, tstring const & name)
+{
+    // The previous file is closed and renamed by the caller.
+    waitIdle ();
+    return FileOutput::exchange (newFd, name);
+}
+
+
+void
+UringFileOutput::setBufferSize (std::size_t bufferSize)
+{
+    if (bufferSize == slotSize || ! ring)
+        return;
+
+    waitIdle ();
+    freeSlots ();
+    allocSlots (bufferSize);
+}
+
+
+int
+UringFileOutput::openFile (tstring const & name, bool append, int & err) const
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    int oflags = O_WRONLY | O_CREAT;
+    if (! append)
+        oflags |= O_TRUNC;
+#if defined (O_CLOEXEC)
+    oflags |= O_CLOEXEC;
+#endif
+
+    std::string const fname (LOG4CPLUS_TSTRING_TO_STRING (name));
+    int ret;
+    do
+        ret = ::open (fname.c_str (), oflags, 0666);
+    while (ret == -1 && errno == EINTR);
+
+    err = ret == -1 ? errno : 0;
+    return ret;
+
+#else
+    return FileOutput::openFile (name, append, err);
+
+#endif
+}
+
+
+void
+UringFileOutput::setupRing ()
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    // Room for a write per buffer, the sync and the exit operation.
+    io_uring_params params;
+    std::memset (&params, 0, sizeof (params));
+    int const ringFd = sys_io_uring_setup (queueDepth + 2, &params);
+    if (ringFd < 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("UringFileOutput: io_uring_setup() failed")
+            LOG4CPLUS_TEXT ("; error ") << errno;
+        getLogLog ().warn (oss.str ());
+        return;
+    }
+
+    std::auto_ptr<Ring> r (new Ring);
+    std::memset (r.get (), 0, sizeof (Ring));
+    r->fd = ringFd;
+    r->sqMapSize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+    r->cqMapSize = params.cq_off.cqes
+        + params.cq_entries * sizeof (io_uring_cqe);
+    r->sqesSize = params.sq_entries * sizeof (io_uring_sqe);
+
+    // Since Linux 5.4 both rings share a single mapping.
+    bool const single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+        r->sqMapSize = r->cqMapSize = (std::max) (r->sqMapSize, r->cqMapSize);
+
+    r->sqMap = ::mmap (0, r->sqMapSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    r->cqMap = single ? r->sqMap : ::mmap (0, r->cqMapSize,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+        IORING_OFF_CQ_RING);
+    void * const sqes = ::mmap (0, r->sqesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (r->sqMap == MAP_FAILED || r->cqMap == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("UringFileOutput: mmap() failed")
+            LOG4CPLUS_TEXT ("; error ") << errno;
+        getLogLog ().warn (oss.str ());
+
+        if (sqes != MAP_FAILED)
+            ::munmap (sqes, r->sqesSize);
+        if (! single && r->cqMap != MAP_FAILED)
+            ::munmap (r->cqMap, r->cqMapSize);
+        if (r->sqMap != MAP_FAILED)
+            ::munmap (r->sqMap, r->sqMapSize);
+        ::close (ringFd);
+        return;
+    }
+
+    char * const sq = static_cast<char *>(r->sqMap);
+    r->sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    r->sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    r->sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    r->sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    r->sqes = static_cast<io_uring_sqe *>(sqes);
+
+    char * const cq = static_cast<char *>(r->cqMap);
+    r->cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    r->cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    r->cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    r->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    ring = r.release ();
+    reaper = new Reaper (*this);
+    reaper->start ();
+#endif
+}
+
+
+void
+UringFileOutput::closeRing ()
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    if (! ring)
+        return;
+
+    {
+        thread::MutexGuard guard (mutex);
+        queueOp (IORING_OP_NOP, -1, EXIT_OP);
+        submitQueued ();
+    }
+    reaper->join ();
+    reaper = 0;
+
+    // Closing the ring unregisters the buffers as well.
+    ::munmap (ring->sqes, ring->sqesSize);
+    if (ring->cqMap != ring->sqMap)
+        ::munmap (ring->cqMap, ring->cqMapSize);
+    ::munmap (ring->sqMap, ring->sqMapSize);
+    ::close (ring->fd);
+    delete ring;
+    ring = 0;
+#endif
+}
+
+
+void
+UringFileOutput::allocSlots (std::size_t bufferSize)
+{
+    slotSize = (std::max) (bufferSize, static_cast<std::size_t>(4096));
+    slots.resize (queueDepth);
+    freeList.clear ();
+    for (unsigned i = queueDepth; i-- != 0; )
+    {
+        Slot & slot = slots[i];
+        slot.data = new char[slotSize];
+        slot.len = 0;
+        slot.done = 0;
+        slot.offset = 0;
+        slot.fd = -1;
+        slot.queued = false;
+        freeList.push_back (i);
+    }
+    current = NO_SLOT;
+
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    if (! ring)
+        return;
+
+    // Registered buffers are pinned once instead of for every write.
+    std::vector<iovec> iovecs (queueDepth);
+    for (unsigned i = 0; i != queueDepth; ++i)
+    {
+        iovecs[i].iov_base = slots[i].data;
+        iovecs[i].iov_len = slotSize;
+    }
+    if (sys_io_uring_register (ring->fd, IORING_REGISTER_BUFFERS,
+            &iovecs[0], queueDepth) < 0)
+    {
+        // E.g. over RLIMIT_MEMLOCK of kernels before 5.12.
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("UringFileOutput: io_uring_register() failed")
+            LOG4CPLUS_TEXT ("; error ") << errno;
+        getLogLog ().warn (oss.str ());
+        closeRing ();
+    }
+#endif
+}
+
+
+void
+UringFileOutput::freeSlots ()
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    if (ring)
+        sys_io_uring_register (ring->fd, IORING_UNREGISTER_BUFFERS, 0, 0);
+#endif
+
+    for (std::vector<Slot>::iterator it = slots.begin (); it != slots.end ();
+        ++it)
+        delete[] it->data;
+    slots.clear ();
+    freeList.clear ();
+    current = NO_SLOT;
+    used = 0;
+}
+
+
+void
+UringFileOutput::acquireSlot ()
+{
+    thread::MutexGuard guard (mutex);
+
+    // Producers reset the event only while no buffer is free and the
+    // reaper signals it after returning one, so the wake up cannot be
+    // lost.
+    while (freeList.empty ())
+    {
+        completed_ev.reset ();
+        guard.unlock ();
+        completed_ev.wait ();
+        guard.lock ();
+    }
+
+    current = freeList.back ();
+    freeList.pop_back ();
+}
+
+
+void
+UringFileOutput::waitIdle ()
+{
+    flush ();
+
+    {
+        thread::MutexGuard guard (mutex);
+        while (inFlight != 0)
+        {
+            completed_ev.reset ();
+            guard.unlock ();
+            completed_ev.wait ();
+            guard.lock ();
+        }
+    }
+
+    checkError ();
+}
+
+
+void
+UringFileOutput::queueWrite (unsigned index)
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    Slot const & slot = slots[index];
+    unsigned const tail = *ring->sqTail;
+    unsigned const pos = tail & ring->sqMask;
+    io_uring_sqe & sqe = ring->sqes[pos];
+    std::memset (&sqe, 0, sizeof (sqe));
+    sqe.opcode = IORING_OP_WRITE_FIXED;
+    sqe.fd = slot.fd;
+    sqe.off = slot.offset + slot.done;
+    sqe.addr = reinterpret_cast<std::size_t>(slot.data + slot.done);
+    sqe.len = static_cast<unsigned>(slot.len - slot.done);
+    sqe.buf_index = static_cast<unsigned short>(index);
+    sqe.user_data = index;
+    ring->sqArray[pos] = pos;
+    store_release (ring->sqTail, tail + 1);
+    ++ring->unsubmitted;
+
+#else
+    (void)index;
+
+#endif
+}
+
+
+void
+UringFileOutput::queueOp (unsigned char opcode, int fd_, unsigned userData)
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    unsigned const tail = *ring->sqTail;
+    unsigned const pos = tail & ring->sqMask;
+    io_uring_sqe & sqe = ring->sqes[pos];
+    std::memset (&sqe, 0, sizeof (sqe));
+    sqe.opcode = opcode;
+    sqe.fd = fd_;
+    if (opcode == IORING_OP_FSYNC)
+        sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe.user_data = userData;
+    ring->sqArray[pos] = pos;
+    store_release (ring->sqTail, tail + 1);
+    ++ring->unsubmitted;
+
+#else
+    (void)opcode;
+    (void)fd_;
+    (void)userData;
+
+#endif
+}
+
+
+void
+UringFileOutput::submitQueued ()
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    while (ring->unsubmitted != 0)
+    {
+        // Writes to the page cache are usually done right here,
+        // writes that would block are handed over to kernel workers.
+        int const ret = sys_io_uring_enter (ring->fd, ring->unsubmitted,
+            0, 0);
+        if (ret > 0)
+            ring->unsubmitted -= (std::min) (static_cast<unsigned>(ret),
+                ring->unsubmitted);
+        else if (ret < 0 && errno == EINTR)
+            continue;
+        else
+            // Out of kernel resources; the operations stay queued and
+            // go with the next submission.
+            break;
+    }
+#endif
+}
+
+
+void
+UringFileOutput::reap ()
+{
+#if defined (LOG4CPLUS_HAVE_IO_URING)
+    bool exit_flag = false;
+    while (! exit_flag)
+    {
+        // Interrupted waits and a full completion queue, EBUSY, are
+        // resolved by reaping what has completed so far. Other errors
+        // mean the ring cannot be used anymore.
+        int err = 0;
+        if (sys_io_uring_enter (ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0
+            && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            err = errno;
+
+        bool completed = false;
+        {
+            thread::MutexGuard guard (mutex);
+
+            unsigned head = *ring->cqHead;
+            unsigned const tail = load_acquire (ring->cqTail);
+            for (; head != tail; ++head)
+            {
+                io_uring_cqe const & cqe = ring->cqes[head & ring->cqMask];
+                if (cqe.user_data == EXIT_OP)
+                {
+                    exit_flag = true;
+                    continue;
+                }
+                else if (cqe.user_data == SYNC_OP)
+                {
+                    syncResult = cqe.res;
+                    syncDone = true;
+                }
+                else
+                {
+                    unsigned const index = static_cast<unsigned>(cqe.user_data);
+                    Slot & slot = slots[index];
+                    if (cqe.res > 0)
+                        slot.done += cqe.res;
+                    if ((cqe.res > 0 && slot.done < slot.len)
+                        || cqe.res == -EAGAIN || cqe.res == -EINTR)
+                    {
+                        // Write the rest.
+                        queueWrite (index);
+                        continue;
+                    }
+                    else if (cqe.res < 0)
+                        ioError = -cqe.res;
+                    else if (cqe.res == 0)
+                        ioError = EIO;
+
+                    slot.len = 0;
+                    slot.queued = false;
+                    freeList.push_back (index);
+                }
+
+                --inFlight;
+                completed = true;
+            }
+            store_release (ring->cqHead, head);
+
+            if (err != 0)
+            {
+                failRing (err);
+                exit_flag = true;
+                completed = true;
+            }
+            else
+                submitQueued ();
+        }
+
+        if (completed)
+            completed_ev.signal ();
+    }
+#endif
+}
+
+
+void
+UringFileOutput::failRing (int err)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT ("UringFileOutput: io_uring_enter() failed")
+        LOG4CPLUS_TEXT ("; error ") << err;
+    getLogLog ().error (oss.str ());
+
+    // Writes still in flight are lost, their buffers are given back
+    // so that no producer waits for them forever.
+    ringFailed = true;
+    ioError = err;
+    syncResult = -err;
+    syncDone = true;
+    inFlight = 0;
+    for (unsigned i = 0; i != queueDepth; ++i)
+    {
+        if (slots[i].queued)
+        {
+            slots[i].len = 0;
+            slots[i].queued = false;
+            freeList.push_back (i);
+        }
+    }
+}
+
+
+void
+UringFileOutput::checkError ()
+{
+    int err;
+    {
+        thread::MutexGuard guard (mutex);
+        err = ioError;
+        ioError = 0;
+    }
+
+    if (err != 0)
+    {
+        reportError (LOG4CPLUS_TEXT ("write"), err);
+        failed = true;
+    }
+}
+
+
+} } // namespace log4cplus { namespace helpers {
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
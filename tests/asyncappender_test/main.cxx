@@ -0,0 +1,143 @@
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/consoleappender.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/threads.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/streams.h>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+using namespace std;
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+using namespace log4cplus::thread;
+
+
+#define MILLIS_TO_NANOS 1000000
+#define NUM_THREADS 4
+#define NUM_LOOPS 50
+
+
+// Appender that is much slower than the threads logging into it.
+class SlowAppender : public ConsoleAppender {
+public:
+    SlowAppender() { }
+
+protected:
+    virtual void append(const spi::InternalLoggingEvent& event)
+    {
+        log4cplus::helpers::sleep(0, 2 * MILLIS_TO_NANOS);
+        ConsoleAppender::append(event);
+    }
+};
+
+
+class TestThread : public AbstractThread {
+public:
+    TestThread(tstring n)
+        : name(n), logger(Logger::getInstance(LOG4CPLUS_TEXT("test.TestThread")))
+     {
+     }
+
+    virtual void run();
+
+private:
+    tstring name;
+    Logger logger;
+};
+
+
+static void
+runThreads()
+{
+    log4cplus::helpers::SharedObjectPtr<TestThread> threads[NUM_THREADS];
+    int i = 0;
+    for(i=0; i<NUM_THREADS; ++i) {
+        tostringstream s;
+        s << "Thread-" << i;
+        threads[i] = new TestThread(s.str());
+    }
+
+    for(i=0; i<NUM_THREADS; ++i) {
+        threads[i]->start();
+    }
+
+    for(i=0; i<NUM_THREADS; ++i) {
+        threads[i]->join();
+    }
+}
+
+
+static void
+testPolicy(Logger & logger, Queue::OverflowPolicy policy,
+    tstring const & name)
+{
+    SharedAppenderPtr slow(new SlowAppender());
+    slow->setLayout( std::auto_ptr<Layout>(new log4cplus::TTCCLayout()) );
+
+    SharedAppenderPtr async(new AsyncAppender(slow, 10, policy));
+    async->setName(name);
+    Logger::getRoot().addAppender(async);
+
+    LOG4CPLUS_WARN(logger, "Testing " << name << "...");
+    runThreads();
+    LOG4CPLUS_WARN(logger, "Testing " << name << "...DONE");
+
+    Logger::getRoot().removeAppender(async);
+    async->close();
+}
+
+
+int
+main()
+{
+    try {
+        log4cplus::helpers::LogLog::getLogLog()->setInternalDebugging(true);
+        Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("main"));
+        Logger::getRoot().setLogLevel(INFO_LOG_LEVEL);
+
+        testPolicy(logger, Queue::BLOCK, LOG4CPLUS_TEXT("BLOCK"));
+        testPolicy(logger, Queue::DROP_NEWEST, LOG4CPLUS_TEXT("DROP_NEWEST"));
+        testPolicy(logger, Queue::DROP_OLDEST, LOG4CPLUS_TEXT("DROP_OLDEST"));
+        testPolicy(logger, Queue::DROP_BELOW_THRESHOLD,
+            LOG4CPLUS_TEXT("DROP_BELOW_THRESHOLD"));
+    }
+    catch(std::exception &e) {
+        tcout << "main()- Exception occured: " << e.what() << endl;
+    }
+    catch(...) {
+        tcout << "main()- Exception occured" << endl;
+    }
+
+    log4cplus::Logger::shutdown();
+    return 0;
+}
+
+
+void
+TestThread::run()
+{
+    try {
+        for(int i=0; i<NUM_LOOPS; ++i) {
+            if(i % 10 == 0)
+                LOG4CPLUS_WARN(logger, name << " loop " << i);
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+            else if(i % 10 == 5)
+                LOG4CPLUS_INFO_DEFERRED(logger, LOG4CPLUS_TEXT("{} loop {}"),
+                    name, i);
+#endif
+            else
+                LOG4CPLUS_INFO(logger, name << " loop " << i);
+        }
+    }
+    catch(exception& e) {
+        LOG4CPLUS_FATAL(logger, "TestThread.run()- Exception occurred: " << e.what());
+    }
+    catch(...) {
+        LOG4CPLUS_FATAL(logger, "TestThread.run()- Exception occurred!!");
+    }
+} // end "run"
@@ -3,12 +3,1161 @@
 #include <log4cplus/layout.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
 
 
 using namespace log4cplus;
 
 const int LOOP_COUNT = 20000;
 
+static int failures = 0;
+
+
+static void
+check(bool condition, std::string const & what)
+{
+    if(!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+static bool
+readFile(std::string const & name, std::string & data)
+{
+    std::ifstream in(name.c_str(), std::ios::binary);
+    if(!in)
+        return false;
+
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    data = oss.str();
+    return true;
+}
+
+
+// Appends the numbers of the lines of the form "<text> #<number>" to
+// numbers.
+// @returns false when a line has another form, e.g. it is torn, or
+// the data do not end with a whole line.
+static bool
+parseLines(std::string const & data, std::string const & text,
+    std::vector<int> & numbers)
+{
+    std::string const prefix = text + " #";
+    std::string::size_type pos = 0;
+    while(pos != data.size()) {
+        std::string::size_type const eol = data.find('\n', pos);
+        if(eol == std::string::npos
+           || data.compare(pos, prefix.size(), prefix) != 0)
+            return false;
+
+        std::string const digits(data, pos + prefix.size(),
+            eol - pos - prefix.size());
+        if(digits.empty()
+           || digits.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+
+        numbers.push_back(std::atoi(digits.c_str()));
+        pos = eol + 1;
+    }
+
+    return true;
+}
+
+
+// Checks that the numbers are the last ones below count, each of them
+// the given number of times. Only whole oldest files may have been
+// dropped by the retention of backups.
+static void
+checkSequence(std::vector<int> numbers, int count, int copies,
+    std::string const & what)
+{
+    check(!numbers.empty(), what + ": no lines");
+    if(numbers.empty())
+        return;
+
+    std::sort(numbers.begin(), numbers.end());
+    int const first = numbers.front();
+    check(numbers.size() == static_cast<std::size_t>((count - first) * copies),
+        what + ": lines lost or duplicated");
+    for(std::size_t i = 0; i != numbers.size(); ++i) {
+        if(numbers[i] != first + static_cast<int>(i) / copies) {
+            check(false, what + ": lines lost or duplicated");
+            break;
+        }
+    }
+}
+
+
+// Minimal gzip decoder, after zlib's puff.c, so that the test does not
+// depend on zlib to check the output of the library's own compressor.
+
+namespace {
+
+struct Inflater
+{
+    Inflater(std::string const & in_, std::size_t pos_, std::string & out_)
+        : in(in_), pos(pos_), out(out_), start(out_.size()), bitBuf(0),
+          bitCnt(0), error(false)
+    { }
+
+    struct Huffman
+    {
+        unsigned short count[16];
+        unsigned short symbol[288];
+    };
+
+    unsigned bits(unsigned need);
+    void construct(Huffman & h, unsigned char const * lengths, unsigned n);
+    int decode(Huffman const & h);
+    void stored();
+    void codes(Huffman const & lencode, Huffman const & distcode);
+    void fixed();
+    void dynamic();
+    bool inflate();
+
+    std::string const & in;
+    std::size_t pos;
+    std::string & out;
+    std::size_t const start;
+    unsigned long bitBuf;
+    unsigned bitCnt;
+    bool error;
+};
+
+
+unsigned
+Inflater::bits(unsigned need)
+{
+    unsigned long val = bitBuf;
+    while(bitCnt < need) {
+        if(pos == in.size()) {
+            error = true;
+            return 0;
+        }
+        val |= static_cast<unsigned long>(
+            static_cast<unsigned char>(in[pos++])) << bitCnt;
+        bitCnt += 8;
+    }
+    bitBuf = val >> need;
+    bitCnt -= need;
+    return static_cast<unsigned>(val & ((1UL << need) - 1));
+}
+
+
+void
+Inflater::construct(Huffman & h, unsigned char const * lengths, unsigned n)
+{
+    std::fill(h.count, h.count + 16, 0);
+    for(unsigned sym = 0; sym != n; ++sym)
+        ++h.count[lengths[sym]];
+
+    unsigned short offs[16];
+    offs[1] = 0;
+    for(unsigned len = 1; len != 15; ++len)
+        offs[len + 1] = offs[len] + h.count[len];
+    for(unsigned sym = 0; sym != n; ++sym)
+        if(lengths[sym] != 0)
+            h.symbol[offs[lengths[sym]]++] = sym;
+}
+
+
+int
+Inflater::decode(Huffman const & h)
+{
+    int code = 0, first = 0, index = 0;
+    for(unsigned len = 1; len != 16; ++len) {
+        code |= bits(1);
+        int const count = h.count[len];
+        if(code - count < first)
+            return h.symbol[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+
+void
+Inflater::stored()
+{
+    bitBuf = 0;
+    bitCnt = 0;
+    if(in.size() - pos < 4) {
+        error = true;
+        return;
+    }
+
+    unsigned char const * p
+        = reinterpret_cast<unsigned char const *>(in.data() + pos);
+    std::size_t const len = p[0] | (p[1] << 8);
+    if(p[2] != (~p[0] & 0xff) || p[3] != (~p[1] & 0xff)
+       || in.size() - pos - 4 < len) {
+        error = true;
+        return;
+    }
+
+    out.append(in, pos + 4, len);
+    pos += 4 + len;
+}
+
+
+void
+Inflater::codes(Huffman const & lencode, Huffman const & distcode)
+{
+    static unsigned short const lbase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static unsigned char const lext[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static unsigned short const dbase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+        8193, 12289, 16385, 24577 };
+    static unsigned char const dext[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    while(!error) {
+        int sym = decode(lencode);
+        if(sym < 0 || sym > 285) {
+            error = true;
+            return;
+        }
+        if(sym < 256) {
+            out += static_cast<char>(sym);
+            continue;
+        }
+        if(sym == 256)
+            return;
+
+        sym -= 257;
+        std::size_t const len = lbase[sym] + bits(lext[sym]);
+        int const dsym = decode(distcode);
+        if(dsym < 0 || dsym > 29) {
+            error = true;
+            return;
+        }
+        std::size_t const dist = dbase[dsym] + bits(dext[dsym]);
+        if(dist > out.size() - start) {
+            error = true;
+            return;
+        }
+        for(std::size_t i = 0; i != len; ++i)
+            out += out[out.size() - dist];
+    }
+}
+
+
+void
+Inflater::fixed()
+{
+    unsigned char lengths[288];
+    std::fill(lengths, lengths + 144, 8);
+    std::fill(lengths + 144, lengths + 256, 9);
+    std::fill(lengths + 256, lengths + 280, 7);
+    std::fill(lengths + 280, lengths + 288, 8);
+    Huffman lencode, distcode;
+    construct(lencode, lengths, 288);
+    std::fill(lengths, lengths + 30, 5);
+    construct(distcode, lengths, 30);
+    codes(lencode, distcode);
+}
+
+
+void
+Inflater::dynamic()
+{
+    static unsigned char const order[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    unsigned const nlen = bits(5) + 257;
+    unsigned const ndist = bits(5) + 1;
+    unsigned const ncode = bits(4) + 4;
+    if(nlen > 286 || ndist > 30) {
+        error = true;
+        return;
+    }
+
+    unsigned char lengths[320] = { 0 };
+    for(unsigned i = 0; i != ncode; ++i)
+        lengths[order[i]] = bits(3);
+    Huffman lencode, distcode;
+    construct(lencode, lengths, 19);
+
+    unsigned index = 0;
+    while(index < nlen + ndist && !error) {
+        int const sym = decode(lencode);
+        if(sym < 0) {
+            error = true;
+            return;
+        }
+        if(sym < 16) {
+            lengths[index++] = sym;
+            continue;
+        }
+
+        unsigned char len = 0;
+        unsigned repeat;
+        if(sym == 16) {
+            if(index == 0) {
+                error = true;
+                return;
+            }
+            len = lengths[index - 1];
+            repeat = 3 + bits(2);
+        }
+        else if(sym == 17)
+            repeat = 3 + bits(3);
+        else
+            repeat = 11 + bits(7);
+        if(index + repeat > nlen + ndist) {
+            error = true;
+            return;
+        }
+        while(repeat--)
+            lengths[index++] = len;
+    }
+    if(error || lengths[256] == 0) {
+        error = true;
+        return;
+    }
+
+    construct(lencode, lengths, nlen);
+    construct(distcode, lengths + nlen, ndist);
+    codes(lencode, distcode);
+}
+
+
+bool
+Inflater::inflate()
+{
+    bool last;
+    do {
+        last = bits(1) != 0;
+        switch(bits(2)) {
+        case 0: stored(); break;
+        case 1: fixed(); break;
+        case 2: dynamic(); break;
+        default: error = true;
+        }
+    } while(!last && !error);
+    return !error;
+}
+
+
+unsigned long
+crc32(char const * data, std::size_t len)
+{
+    unsigned long crc = 0xffffffffUL;
+    for(std::size_t i = 0; i != len; ++i) {
+        crc ^= static_cast<unsigned char>(data[i]);
+        for(int k = 0; k != 8; ++k)
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320UL : crc >> 1;
+    }
+    return crc ^ 0xffffffffUL;
+}
+
+
+unsigned long
+readLe32(std::string const & in, std::size_t pos)
+{
+    unsigned long val = 0;
+    for(int i = 3; i >= 0; --i)
+        val = (val << 8) | static_cast<unsigned char>(in[pos + i]);
+    return val;
+}
+
+} // namespace
+
+
+// Decodes all members of gzip data and checks their CRC-32 and
+// length.
+// @returns false when the data are not valid gzip data.
+static bool
+gunzip(std::string const & in, std::string & out)
+{
+    out.clear();
+    std::size_t pos = 0;
+    while(pos != in.size()) {
+        if(in.size() - pos < 18 || in.compare(pos, 3, "\x1f\x8b\x08") != 0)
+            return false;
+
+        unsigned const flags = static_cast<unsigned char>(in[pos + 3]);
+        pos += 10;
+        if(flags & 4) {
+            if(in.size() - pos < 2)
+                return false;
+            pos += 2 + (static_cast<unsigned char>(in[pos])
+                | (static_cast<unsigned char>(in[pos + 1]) << 8));
+        }
+        for(unsigned flag = 8; flag != 32; flag <<= 1) {
+            if(flags & flag) {
+                pos = in.find('\0', std::min(pos, in.size()));
+                if(pos == std::string::npos)
+                    return false;
+                ++pos;
+            }
+        }
+        if(flags & 2)
+            pos += 2;
+        if(pos > in.size())
+            return false;
+
+        std::size_t const start = out.size();
+        Inflater inflater(in, pos, out);
+        if(!inflater.inflate() || in.size() - inflater.pos < 8)
+            return false;
+
+        pos = inflater.pos;
+        std::size_t const len = out.size() - start;
+        if(readLe32(in, pos) != crc32(out.data() + start, len)
+           || readLe32(in, pos + 4) != (len & 0xffffffffUL))
+            return false;
+        pos += 8;
+    }
+
+    return true;
+}
+
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+// @returns Sorted names of the files in the current directory that
+// start with the prefix.
+static std::vector<std::string>
+listFiles(std::string const & prefix)
+{
+    std::vector<std::string> names;
+    DIR * dir = opendir(".");
+    if(!dir)
+        return names;
+
+    while(struct dirent * entry = readdir(dir)) {
+        std::string const name(entry->d_name);
+        if(name.compare(0, prefix.size(), prefix) == 0)
+            names.push_back(name);
+    }
+    closedir(dir);
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+
+// Removes files left behind by previous runs.
+static void
+removeFiles(std::string const & prefix)
+{
+    std::vector<std::string> const names = listFiles(prefix);
+    for(std::size_t i = 0; i != names.size(); ++i)
+        std::remove(names[i].c_str());
+}
+
+
+// @returns Ascending indexes of the backups named
+// <prefix><index><suffix>.
+static std::vector<int>
+listBackups(std::string const & prefix, std::string const & suffix)
+{
+    std::vector<int> indexes;
+    std::vector<std::string> const names = listFiles(prefix);
+    for(std::size_t i = 0; i != names.size(); ++i) {
+        std::string const & name = names[i];
+        if(name.size() <= prefix.size() + suffix.size()
+           || name.compare(name.size() - suffix.size(), suffix.size(),
+               suffix) != 0)
+            continue;
+
+        std::string const digits(name, prefix.size(),
+            name.size() - prefix.size() - suffix.size());
+        if(digits.find_first_not_of("0123456789") == std::string::npos)
+            indexes.push_back(std::atoi(digits.c_str()));
+    }
+
+    std::sort(indexes.begin(), indexes.end());
+    return indexes;
+}
+#endif
+
+
+// Checks that a file is the same, byte for byte, as the file written
+// by a reference appender.
+static void
+checkSameFile(std::string const & name, std::string const & refName,
+    std::string const & what)
+{
+    std::string data, refData;
+    check(readFile(name, data) && readFile(refName, refData)
+          && !data.empty() && data == refData,
+        what + ": different content of " + name);
+}
+
+
+// Attaches FileAppender writing through the stream as a reference for
+// the output of the tested one.
+static SharedAppenderPtr
+addReference(helpers::Properties props, tstring const & filename)
+{
+    props.setProperty(LOG4CPLUS_TEXT("File"), filename);
+    props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("stream"));
+
+    SharedAppenderPtr append_ref(new FileAppender(props));
+    append_ref->setName(LOG4CPLUS_TEXT("Reference"));
+    append_ref->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_ref);
+    return append_ref;
+}
+
+
+static void
+removeAppender(SharedAppenderPtr const & appender)
+{
+    Logger::getRoot().removeAppender(appender);
+    appender->close();
+}
+
+namespace {
+
+// Files written by a tested rolling file appender and the lines that
+// it logs into them.
+struct RollingFiles
+{
+    RollingFiles(std::string const & file_, int backups_, char const * text_,
+        int count_, std::string const & what_)
+        : file(file_), backups(backups_), minFiles(backups_ + 1),
+          text(text_), count(count_), what(what_), warnEvery(0),
+          gzip(false), plain(false)
+    { }
+
+    // The current file. Its backups are <file>.<backups> down to
+    // <file>.1, or all files that start with its name when backups is 0.
+    std::string file;
+    int backups;
+    // Number of files that have to be there.
+    int minFiles;
+    // The lines are "<text> #<number>", numbered from 0 up to count.
+    char const * text;
+    int count;
+    // Name of the test in the messages.
+    std::string what;
+    // Every warnEvery-th line is a warning, when it is not 0.
+    int warnEvery;
+    // The files are gzip streams.
+    bool gzip;
+    // FileAppender with the same properties writes <stem>Plain.log next
+    // to the reference writing <stem>Ref.log.
+    bool plain;
+};
+
+} // namespace
+
+
+// Logs the lines through an appender made from the properties, with
+// File, MaxFileSize 200KB and MaxBackupIndex set from the files. Every
+// file has to hold whole lines, there must be no more backups and the
+// lines of all of them together have to make one sequence.
+template <typename AppenderT>
+static void
+checkRollingFile(Logger const & logger, helpers::Properties props,
+    RollingFiles const & files)
+{
+    std::string const stem = files.file.substr(0, files.file.find('.'));
+    std::string const plainName = stem + "Plain.log";
+    std::string const refName = stem + "Ref.log";
+
+    std::vector<std::string> names;
+    std::ostringstream next;
+    next << files.file << '.' << files.backups + 1;
+    for(int i=files.backups; i>0; --i) {
+        std::ostringstream name;
+        name << files.file << '.' << i;
+        names.push_back(name.str());
+    }
+    names.push_back(files.file);
+
+    if(files.backups != 0) {
+        for(std::size_t i = 0; i != names.size(); ++i)
+            std::remove(names[i].c_str());
+        std::remove(next.str().c_str());
+    }
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    else
+        removeFiles(files.file);
+#endif
+    std::remove(plainName.c_str());
+    std::remove(refName.c_str());
+
+    props.setProperty(LOG4CPLUS_TEXT("File"),
+        LOG4CPLUS_STRING_TO_TSTRING(files.file));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    if(files.backups != 0) {
+        std::ostringstream backups;
+        backups << files.backups;
+        props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"),
+            LOG4CPLUS_STRING_TO_TSTRING(backups.str()));
+    }
+
+    SharedAppenderPtr append_tested(new AppenderT(props));
+    append_tested->setName(LOG4CPLUS_TEXT("Tested"));
+    append_tested->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_tested);
+
+    SharedAppenderPtr append_plain, append_ref;
+    if(files.plain) {
+        props.setProperty(LOG4CPLUS_TEXT("File"),
+            LOG4CPLUS_STRING_TO_TSTRING(plainName));
+        append_plain = new FileAppender(props);
+        append_plain->setName(LOG4CPLUS_TEXT("Plain"));
+        append_plain->setLayout(
+            std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+        Logger::getRoot().addAppender(append_plain);
+        append_ref = addReference(props, LOG4CPLUS_STRING_TO_TSTRING(refName));
+    }
+
+    for(int i=0; i<files.count; ++i) {
+        if(files.warnEvery != 0 && i % files.warnEvery == 0)
+            LOG4CPLUS_WARN(logger, files.text << " #" << i);
+        else
+            LOG4CPLUS_DEBUG(logger, files.text << " #" << i);
+    }
+
+    removeAppender(append_tested);
+    if(files.plain) {
+        removeAppender(append_plain);
+        removeAppender(append_ref);
+        checkSameFile(plainName, refName, files.what);
+    }
+
+    if(files.backups == 0) {
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+        names = listFiles(files.file);
+#else
+        return;
+#endif
+    }
+
+    // Every file, the oldest backup first, holds whole lines, so no
+    // preallocated or mapped tail is left at its end.
+    std::vector<int> numbers;
+    int found = 0;
+    for(std::size_t i = 0; i != names.size(); ++i) {
+        std::string data;
+        if(!readFile(names[i], data))
+            continue;
+
+        ++found;
+        std::string text;
+        if(!files.gzip)
+            text.swap(data);
+        check((!files.gzip || gunzip(data, text))
+              && parseLines(text, files.text, numbers),
+            files.what + ": content of " + names[i]);
+    }
+    check(found >= files.minFiles, files.what + ": number of files");
+    if(files.backups != 0)
+        check(!std::ifstream(next.str().c_str()),
+            files.what + ": number of backups");
+    checkSequence(numbers, files.count, 1, files.what);
+}
+
+
+// File written through the raw file descriptor backend with buffered
+// output flushed by time and by log level. It has to be the same as
+// the file written through the stream.
+static void
+testFdBackend(Logger const & logger)
+{
+    std::remove("TestFdPlain.log");
+    std::remove("TestFdRef.log");
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("TestFdPlain.log"));
+    props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("fd"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushLevel"), LOG4CPLUS_TEXT("ERROR"));
+
+    SharedAppenderPtr append_fd(new FileAppender(props));
+    append_fd->setName(LOG4CPLUS_TEXT("Fd"));
+    append_fd->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_fd);
+    SharedAppenderPtr append_ref
+        = addReference(props, LOG4CPLUS_TEXT("TestFdRef.log"));
+
+    for(int i=0; i<LOOP_COUNT; ++i) {
+        if(i % 1000 == 0)
+            LOG4CPLUS_ERROR(logger, "Flushing loop #" << i);
+        else
+            LOG4CPLUS_DEBUG(logger, "Buffered loop #" << i);
+    }
+
+    removeAppender(append_fd);
+    removeAppender(append_ref);
+
+    checkSameFile("TestFdPlain.log", "TestFdRef.log", "fd backend");
+}
+
+
+// Rolling file written through the raw file descriptor backend with
+// buffered output flushed by time and by log level and with backups
+// compressed in the background.
+static void
+testRolledBackups(Logger const & logger)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    removeFiles("TestFd.log");
+#endif
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("TestFd.log"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("3"));
+    props.setProperty(LOG4CPLUS_TEXT("BackupNaming"), LOG4CPLUS_TEXT("sequence"));
+    props.setProperty(LOG4CPLUS_TEXT("CompressBackups"), LOG4CPLUS_TEXT("gzip"));
+    props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("fd"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushLevel"), LOG4CPLUS_TEXT("ERROR"));
+
+    SharedAppenderPtr append_fd(new RollingFileAppender(props));
+    append_fd->setName(LOG4CPLUS_TEXT("Fd"));
+    append_fd->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_fd);
+
+    for(int i=0; i<4 * LOOP_COUNT; ++i) {
+        if(i % 1000 == 0)
+            LOG4CPLUS_ERROR(logger, "Rolled loop #" << i);
+        else
+            LOG4CPLUS_DEBUG(logger, "Rolled loop #" << i);
+    }
+
+    removeAppender(append_fd);
+
+    std::vector<int> numbers;
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    // The file has rolled over more often than MaxBackupIndex; only
+    // the newest backups are kept.
+    std::vector<int> const indexes = listBackups("TestFd.log.", ".gz");
+    check(!indexes.empty() && indexes.size() <= 3,
+        "rolled backups: number of backups");
+    for(std::size_t i = 1; i < indexes.size(); ++i)
+        check(indexes[i] == indexes[i - 1] + 1,
+            "rolled backups: backup indexes");
+    check(!indexes.empty() && indexes.front() > 1,
+        "rolled backups: oldest backups removed");
+    check(listFiles("TestFd.log.").size() == indexes.size(),
+        "rolled backups: files left behind");
+
+    // The backups decode to the lines logged before the current file.
+    for(std::size_t i = 0; i != indexes.size(); ++i) {
+        std::ostringstream name;
+        name << "TestFd.log." << indexes[i] << ".gz";
+        std::string data, text;
+        check(readFile(name.str(), data) && gunzip(data, text)
+              && parseLines(text, "Rolled loop", numbers),
+            "rolled backups: content of " + name.str());
+    }
+#endif
+
+    std::string data;
+    check(readFile("TestFd.log", data) && parseLines(data, "Rolled loop", numbers)
+          && !numbers.empty() && numbers.back() == 4 * LOOP_COUNT - 1,
+        "rolled backups: last lines");
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    checkSequence(numbers, 4 * LOOP_COUNT, 1, "rolled backups");
+#endif
+}
+
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+// Backups left behind by a crash while they were being compressed:
+// a partial compressed file, a backup next to its complete compressed
+// file and a backup that has not been compressed yet. A new appender
+// has to clean them up and count every backup once.
+static void
+testCompressRecovery(Logger const & logger)
+{
+    removeFiles("TestRecovery.log");
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("TestRecovery.log"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("10"));
+    props.setProperty(LOG4CPLUS_TEXT("BackupNaming"), LOG4CPLUS_TEXT("sequence"));
+    props.setProperty(LOG4CPLUS_TEXT("CompressBackups"), LOG4CPLUS_TEXT("gzip"));
+
+    SharedAppenderPtr append_gz(new RollingFileAppender(props));
+    append_gz->setName(LOG4CPLUS_TEXT("Recovery"));
+    append_gz->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_gz);
+
+    for(int i=0; i<2 * LOOP_COUNT; ++i)
+        LOG4CPLUS_DEBUG(logger, "Recovery loop #" << i);
+
+    removeAppender(append_gz);
+
+    std::vector<int> const before = listBackups("TestRecovery.log.", ".gz");
+    check(before.size() >= 3, "compress recovery: no rollover");
+    if(before.size() < 3)
+        return;
+
+    std::ostringstream oldest, previous, newest;
+    oldest << "TestRecovery.log." << before.front();
+    previous << "TestRecovery.log." << before[before.size() - 2];
+    newest << "TestRecovery.log." << before.back();
+
+    // Interrupted compression of the oldest backup.
+    std::ofstream(std::string(oldest.str() + ".gz.tmp").c_str())
+        << "partial";
+
+    // Crash before the backup was removed and before it was compressed.
+    std::string data, text;
+    check(readFile(previous.str() + ".gz", data) && gunzip(data, text),
+        "compress recovery: content of " + previous.str() + ".gz");
+    std::ofstream(previous.str().c_str(), std::ios::binary) << text;
+
+    data.clear();
+    text.clear();
+    check(readFile(newest.str() + ".gz", data) && gunzip(data, text),
+        "compress recovery: content of " + newest.str() + ".gz");
+    std::ofstream(newest.str().c_str(), std::ios::binary) << text;
+    std::remove(std::string(newest.str() + ".gz").c_str());
+
+    // Each backup counts once, so the next rollovers fill the limit
+    // that is one above the number of backups.
+    std::ostringstream maxBackups;
+    maxBackups << before.size() + 1;
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"),
+        LOG4CPLUS_STRING_TO_TSTRING(maxBackups.str()));
+
+    append_gz = new RollingFileAppender(props);
+    append_gz->setName(LOG4CPLUS_TEXT("Recovery"));
+    append_gz->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_gz);
+
+    for(int i=2 * LOOP_COUNT; i<4 * LOOP_COUNT; ++i)
+        LOG4CPLUS_DEBUG(logger, "Recovery loop #" << i);
+
+    removeAppender(append_gz);
+
+    std::vector<int> const indexes = listBackups("TestRecovery.log.", ".gz");
+    check(indexes.size() == before.size() + 1,
+        "compress recovery: number of backups");
+    check(listFiles("TestRecovery.log.").size() == indexes.size(),
+        "compress recovery: files left behind");
+
+    std::vector<int> numbers;
+    for(std::size_t i = 0; i != indexes.size(); ++i) {
+        std::ostringstream name;
+        name << "TestRecovery.log." << indexes[i] << ".gz";
+        data.clear();
+        text.clear();
+        check(readFile(name.str(), data) && gunzip(data, text)
+              && parseLines(text, "Recovery loop", numbers),
+            "compress recovery: content of " + name.str());
+    }
+    data.clear();
+    check(readFile("TestRecovery.log", data)
+          && parseLines(data, "Recovery loop", numbers),
+        "compress recovery: content of TestRecovery.log");
+    checkSequence(numbers, 4 * LOOP_COUNT, 1, "compress recovery");
+}
+#endif
+
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+// Rolling file written through the file descriptor backend with space
+// preallocated ahead of the writes and the page cache dropped behind
+// them. Closed files must not keep the preallocated space.
+static void
+testPreallocatedRollover(Logger const & logger)
+{
+    removeFiles("TestPrealloc.log");
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("TestPrealloc.log"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("10"));
+    props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("fd"));
+    props.setProperty(LOG4CPLUS_TEXT("Preallocate"), LOG4CPLUS_TEXT("1MB"));
+    props.setProperty(LOG4CPLUS_TEXT("DropCacheBehind"), LOG4CPLUS_TEXT("true"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+
+    SharedAppenderPtr append_fd(new RollingFileAppender(props));
+    append_fd->setName(LOG4CPLUS_TEXT("Prealloc"));
+    append_fd->setLayout(
+        std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+    Logger::getRoot().addAppender(append_fd);
+
+    for(int i=0; i<2 * LOOP_COUNT; ++i)
+        LOG4CPLUS_DEBUG(logger, "Prealloc loop #" << i);
+
+    removeAppender(append_fd);
+
+    // Every file holds whole lines only, no zeroes past them, and the
+    // blocks allocated beyond its size have been freed.
+    std::vector<std::string> const names = listFiles("TestPrealloc.log");
+    std::vector<int> numbers;
+    for(std::size_t i = 0; i != names.size(); ++i) {
+        std::string data;
+        struct stat st;
+        check(readFile(names[i], data)
+              && parseLines(data, "Prealloc loop", numbers),
+            "preallocated rollover: content of " + names[i]);
+        check(stat(names[i].c_str(), &st) == 0
+              && static_cast<std::size_t>(st.st_size) == data.size()
+              && st.st_blocks * 512 < st.st_size + 64 * 1024,
+            "preallocated rollover: preallocated tail of " + names[i]);
+    }
+    check(names.size() >= 3, "preallocated rollover: no rollover");
+    checkSequence(numbers, 2 * LOOP_COUNT, 1, "preallocated rollover");
+}
+#endif
+
+
+// Rolling file written as a gzip stream with sync flush points.
+static void
+testCompressedOutput(Logger const & logger)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("CompressOutput"), LOG4CPLUS_TEXT("gzip"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+
+    // The compressed files roll over less often, the older backups may
+    // be missing.
+    RollingFiles files("TestGz.log.gz", 3, "Compressed loop", 20 * LOOP_COUNT,
+        "compressed output");
+    files.minFiles = 2;
+    files.gzip = true;
+    checkRollingFile<RollingFileAppender>(logger, props, files);
+}
+
+
+// Rolling file written through a memory mapping with msync() every
+// 100 ms.
+static void
+testMappedFile(Logger const & logger)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("MapSize"), LOG4CPLUS_TEXT("64KB"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+
+    checkRollingFile<MappedFileAppender>(logger, props,
+        RollingFiles("TestMapped.log", 3, "Mapped loop", 4 * LOOP_COUNT,
+            "mapped file"));
+}
+
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+// Rolling file shared through the lock file by writer processes that
+// log at the same time, each of them every other line number, so that
+// the lines of all of them make one sequence.
+static void
+testSharedFile(Logger const & logger, bool preallocate)
+{
+    std::string const what = preallocate ? "shared preallocated file"
+        : "shared file";
+    int const WRITERS = 2;
+
+    removeFiles("TestShared.log");
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("TestShared.log"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("20"));
+    props.setProperty(LOG4CPLUS_TEXT("UseLockFile"), LOG4CPLUS_TEXT("true"));
+    if(preallocate) {
+        props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("fd"));
+        props.setProperty(LOG4CPLUS_TEXT("Preallocate"), LOG4CPLUS_TEXT("1MB"));
+    }
+
+    // The writers start when the pipe is closed.
+    int start[2];
+    if(pipe(start) != 0) {
+        check(false, what + ": pipe");
+        return;
+    }
+
+    std::vector<pid_t> writers;
+    for(int k=0; k<WRITERS; ++k) {
+        pid_t const pid = fork();
+        if(pid == 0) {
+            close(start[1]);
+            char c;
+            while(read(start[0], &c, 1) > 0)
+                ;
+
+            SharedAppenderPtr append_shared(new RollingFileAppender(props));
+            append_shared->setName(LOG4CPLUS_TEXT("Shared"));
+            append_shared->setLayout(
+                std::auto_ptr<Layout>(new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+            Logger::getRoot().addAppender(append_shared);
+
+            for(int i=k; i<WRITERS * LOOP_COUNT; i+=WRITERS)
+                LOG4CPLUS_DEBUG(logger, "Shared loop #" << i);
+
+            removeAppender(append_shared);
+            _exit(0);
+        }
+        check(pid > 0, what + ": fork");
+        if(pid > 0)
+            writers.push_back(pid);
+    }
+    close(start[0]);
+    close(start[1]);
+
+    for(std::size_t i = 0; i != writers.size(); ++i) {
+        int status = 0;
+        check(waitpid(writers[i], &status, 0) == writers[i]
+              && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+            what + ": writer failed");
+    }
+
+    // MaxBackupIndex keeps all the backups. Every line of every writer
+    // is there whole, none of them is lost, torn or overwritten, and
+    // there is no preallocated tail.
+    std::vector<std::string> const names = listFiles("TestShared.log");
+    std::vector<int> numbers;
+    int files = 0;
+    for(std::size_t i = 0; i != names.size(); ++i) {
+        if(names[i] == "TestShared.log.lock")
+            continue;
+
+        std::string data;
+        check(readFile(names[i], data)
+              && parseLines(data, "Shared loop", numbers),
+            what + ": content of " + names[i]);
+        ++files;
+    }
+    check(files >= 3, what + ": no rollover");
+    check(!numbers.empty()
+          && *std::min_element(numbers.begin(), numbers.end()) == 0,
+        what + ": oldest lines lost");
+    checkSequence(numbers, WRITERS * LOOP_COUNT, 1, what);
+}
+#endif
+
+
+// Rolling file written through io_uring, or through the file
+// descriptor backend when the kernel does not support it, next to a
+// plain file written the same way that has to be the same as the file
+// written through the stream.
+static void
+testUringBackend(Logger const & logger)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Backend"), LOG4CPLUS_TEXT("uring"));
+    props.setProperty(LOG4CPLUS_TEXT("BufferSize"), LOG4CPLUS_TEXT("16384"));
+    props.setProperty(LOG4CPLUS_TEXT("UringQueueDepth"), LOG4CPLUS_TEXT("4"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("FlushInterval"), LOG4CPLUS_TEXT("100"));
+
+    RollingFiles files("TestUring.log", 3, "Uring loop", 4 * LOOP_COUNT,
+        "uring backend");
+    files.plain = true;
+    checkRollingFile<RollingFileAppender>(logger, props, files);
+}
+
+
+// Rolling file synced by group commit for warnings and by the
+// rollovers, next to a plain file synced the same way that has to be
+// the same as the file written through the stream.
+static void
+testGroupCommit(Logger const & logger)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+    props.setProperty(LOG4CPLUS_TEXT("Durability"), LOG4CPLUS_TEXT("group"));
+    props.setProperty(LOG4CPLUS_TEXT("SyncLevel"), LOG4CPLUS_TEXT("WARN"));
+
+    RollingFiles files("TestDurable.log", 3, "Durable loop", 4 * LOOP_COUNT,
+        "group commit");
+    files.warnEvery = 100;
+    files.plain = true;
+    checkRollingFile<RollingFileAppender>(logger, props, files);
+}
+
+
+// File rolled over by time and by size with the total size and the
+// age of the backups limited.
+static void
+testTimeBased(Logger const & logger)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Schedule"), LOG4CPLUS_TEXT("HOURLY"));
+    props.setProperty(LOG4CPLUS_TEXT("TotalSizeCap"), LOG4CPLUS_TEXT("600KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupAge"), LOG4CPLUS_TEXT("1d"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"), LOG4CPLUS_TEXT("false"));
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    // Backup left by a run long ago, it is over MaxBackupAge. Only its
+    // age, not the total size, gets it deleted.
+    removeFiles("TestTimeBased.log");
+    {
+        std::ofstream old("TestTimeBased.log.2000-01-01-00");
+        old << "Time based loop #0\n";
+    }
+    struct utimbuf const times = { 946684800, 946684800 };
+    utime("TestTimeBased.log.2000-01-01-00", &times);
+
+    helpers::Properties oldProps(props);
+    oldProps.setProperty(LOG4CPLUS_TEXT("File"),
+        LOG4CPLUS_TEXT("TestTimeBased.log"));
+    SharedAppenderPtr(new TimeBasedRollingFileAppender(oldProps))->close();
+    check(!std::ifstream("TestTimeBased.log.2000-01-01-00"),
+        "time based: old backup kept");
+#endif
+
+    RollingFiles files("TestTimeBased.log", 0, "Time based loop",
+        4 * LOOP_COUNT, "time based");
+    files.minFiles = 3;
+    checkRollingFile<TimeBasedRollingFileAppender>(logger, props, files);
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    // The oldest backups over TotalSizeCap have been deleted.
+    std::vector<std::string> const names = listFiles("TestTimeBased.log");
+    std::string::size_type total = 0;
+    for(std::size_t i = 0; i != names.size(); ++i) {
+        std::string data;
+        if(names[i] == "TestTimeBased.log" || !readFile(names[i], data))
+            continue;
+
+        check(data.size() <= 200 * 1024 + 64,
+            "time based: size of " + names[i]);
+        total += data.size();
+    }
+    check(total <= 600 * 1024, "time based: total size of backups");
+#endif
+}
+
 
 int
 main()
@@ -29,6 +1178,22 @@ main()
         LOG4CPLUS_DEBUG(subTest, "Entering loop #" << i);
     }
 
+    Logger::getRoot().removeAppender(append_1);
+    testFdBackend(subTest);
+    testRolledBackups(subTest);
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    testCompressRecovery(subTest);
+    testPreallocatedRollover(subTest);
+#endif
+    testCompressedOutput(subTest);
+    testMappedFile(subTest);
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    testSharedFile(subTest, false);
+    testSharedFile(subTest, true);
+#endif
+    testUringBackend(subTest);
+    testGroupCommit(subTest);
+    testTimeBased(subTest);
 
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
@@ -2,11 +2,94 @@
 #include "log4cplus/logger.h"
 #include "log4cplus/consoleappender.h"
 #include "log4cplus/loglevel.h"
+#include "log4cplus/helpers/format.h"
+#include <climits>
 #include <iomanip>
+#include <iostream>
 
 using namespace std;
 using namespace log4cplus;
 
+
+namespace {
+
+struct Point
+{
+    int x, y;
+};
+
+tostream &
+operator << (tostream & os, Point const & p)
+{
+    return os << LOG4CPLUS_TEXT("(") << p.x << LOG4CPLUS_TEXT(", ") << p.y
+              << LOG4CPLUS_TEXT(")");
+}
+
+int failures = 0;
+
+void
+check(tstring const & result, tstring const & expected)
+{
+    if(result != expected) {
+        tcout << LOG4CPLUS_TEXT("FAILED: \"") << result
+              << LOG4CPLUS_TEXT("\" instead of \"") << expected
+              << LOG4CPLUS_TEXT("\"") << endl;
+        ++failures;
+    }
+}
+
+template <typename T>
+tstring
+streamed(T const & v)
+{
+    tostringstream oss;
+    oss << v;
+    return oss.str();
+}
+
+// helpers::format() has to write what a default constructed stream
+// would, in the C locale.
+void
+testFormat()
+{
+    tstring out;
+    helpers::format(out, LOG4CPLUS_TEXT("{{}} {{{}}} }}"), 1);
+    check(out, LOG4CPLUS_TEXT("{} {1} }"));
+
+    out.clear();
+    helpers::format(out, LOG4CPLUS_TEXT("{} {}"), LONG_MIN, LONG_MAX);
+    check(out, streamed(LONG_MIN) + LOG4CPLUS_TEXT(" ") + streamed(LONG_MAX));
+
+    out.clear();
+    helpers::format(out, LOG4CPLUS_TEXT("{}"), ULONG_MAX);
+    check(out, streamed(ULONG_MAX));
+
+    out.clear();
+    helpers::format(out, LOG4CPLUS_TEXT("a {} b {} c"), 1);
+    check(out, LOG4CPLUS_TEXT("a 1 b {} c"));
+
+    out.clear();
+    helpers::format(out, LOG4CPLUS_TEXT("a {}"), 1, 2, 3);
+    check(out, LOG4CPLUS_TEXT("a 1"));
+
+    double const doubles[] = { 0.0, 1.5, -0.1, 1.0 / 3, 123456789.0, 1e20,
+        1e-5, 2.5e-300 };
+    for(std::size_t i = 0; i != sizeof(doubles) / sizeof(doubles[0]); ++i) {
+        out.clear();
+        helpers::format(out, LOG4CPLUS_TEXT("{}"), doubles[i]);
+        check(out, streamed(doubles[i]));
+    }
+
+    Point const point = { 1, -2 };
+    out.clear();
+    helpers::format(out, LOG4CPLUS_TEXT("{} {} {} {}"), true, LOG4CPLUS_TEXT('x'),
+        static_cast<tchar const *>(0), point);
+    check(out, LOG4CPLUS_TEXT("true x (null) (1, -2)"));
+}
+
+} // namespace
+
+
 int
 main()
 {
@@ -44,7 +127,9 @@ main()
     LOG4CPLUS_WARN(test, "The following message is empty:");
     LOG4CPLUS_WARN(test, "");
 
-    return 0;
+    testFormat();
+
+    return failures == 0 ? 0 : 1;
 }
 
 
@@ -6,18 +6,251 @@
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/threads.h>
 #include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
 #include <iostream>
+#include <sstream>
 #include <string>
 
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 using namespace log4cplus;
 using namespace log4cplus::helpers;
 
+
+// Patterns and events formatted by the previous, converter based
+// implementation of PatternLayout into the expected strings below.
+static log4cplus::tchar const * const patterns[] = {
+    LOG4CPLUS_TEXT("%m%n"),
+    LOG4CPLUS_TEXT("%-5p [%t] %c - %m%n"),
+    LOG4CPLUS_TEXT("%d{%Y-%m-%d %H:%M:%S,%q} %p %c{2} %x - %m [%l]%n"),
+    LOG4CPLUS_TEXT("%d"),
+    LOG4CPLUS_TEXT("%d{%a %b %d %j %y %%}"),
+    LOG4CPLUS_TEXT("%d{%Q}|%d{%q}"),
+    LOG4CPLUS_TEXT("%10.3m|%-10.3m|%.3m|%3m|"),
+    LOG4CPLUS_TEXT("%c{1}|%c{2}|%c{3}|%c{0}|%.4c|"),
+    LOG4CPLUS_TEXT("%F:%L %b"),
+    LOG4CPLUS_TEXT("%l"),
+    LOG4CPLUS_TEXT("%x|%.3x|%5x|%-5x|"),
+    LOG4CPLUS_TEXT("%%|%%%%"),
+    LOG4CPLUS_TEXT("%-20c|%20c|%-3c|"),
+    LOG4CPLUS_TEXT("%.3p|%3p|%-7p|"),
+    LOG4CPLUS_TEXT("%t%t|%-12t|"),
+    LOG4CPLUS_TEXT("literal only"),
+    LOG4CPLUS_TEXT(""),
+    LOG4CPLUS_TEXT("%"),
+    LOG4CPLUS_TEXT("%z unknown"),
+    LOG4CPLUS_TEXT("%d{"),
+    LOG4CPLUS_TEXT("%c{x"),
+    LOG4CPLUS_TEXT("%5"),
+    LOG4CPLUS_TEXT("%-"),
+    LOG4CPLUS_TEXT("%5.2"),
+    LOG4CPLUS_TEXT("%M %r %X"),
+    LOG4CPLUS_TEXT("trailing %"),
+    LOG4CPLUS_TEXT("%10.2F|%-8L|%8L|"),
+    LOG4CPLUS_TEXT("%-6b|%20.10l|"),
+    LOG4CPLUS_TEXT("%n%n%m"),
+};
+
+
+struct EventData {
+    log4cplus::tchar const * logger;
+    LogLevel ll;
+    log4cplus::tchar const * ndc;
+    log4cplus::tchar const * message;
+    log4cplus::tchar const * thread;
+    log4cplus::tchar const * file;
+    int line;
+};
+
+
+static EventData const events[] = {
+    { LOG4CPLUS_TEXT("test.a.long_logger_name.c.logger"), WARN_LOG_LEVEL,
+      LOG4CPLUS_TEXT("outer inner"), LOG4CPLUS_TEXT("This is a message"),
+      LOG4CPLUS_TEXT("12345"), LOG4CPLUS_TEXT("/src/dir/file.cxx"), 42 },
+    { LOG4CPLUS_TEXT("root"), TRACE_LOG_LEVEL, LOG4CPLUS_TEXT(""),
+      LOG4CPLUS_TEXT(""), LOG4CPLUS_TEXT("main"), LOG4CPLUS_TEXT(""), -1 },
+    { LOG4CPLUS_TEXT("a.b"), FATAL_LOG_LEVEL,
+      LOG4CPLUS_TEXT("one two three four"),
+      LOG4CPLUS_TEXT("Message with % and {}"), LOG4CPLUS_TEXT("t"),
+      LOG4CPLUS_TEXT("name.cxx"), 0 },
+};
+
+
+// One string per pattern and event, events varying fastest.
+static log4cplus::tchar const * const expected[] = {
+    LOG4CPLUS_TEXT("This is a message\n"),
+    LOG4CPLUS_TEXT("\n"),
+    LOG4CPLUS_TEXT("Message with % and {}\n"),
+    LOG4CPLUS_TEXT("WARN  [12345] test.a.long_logger_name.c.logger - This is a message\n"),
+    LOG4CPLUS_TEXT("TRACE [main] root - \n"),
+    LOG4CPLUS_TEXT("FATAL [t] a.b - Message with % and {}\n"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30,123 WARN c.logger outer inner - This is a message [/src/dir/file.cxx:42]\n"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30,123 TRACE root  -  [:]\n"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30,123 FATAL a.b one two three four - Message with % and {} [name.cxx:0]\n"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("Fri Feb 13 044 09 %"),
+    LOG4CPLUS_TEXT("Fri Feb 13 044 09 %"),
+    LOG4CPLUS_TEXT("Fri Feb 13 044 09 %"),
+    LOG4CPLUS_TEXT("123.456|123"),
+    LOG4CPLUS_TEXT("123.456|123"),
+    LOG4CPLUS_TEXT("123.456|123"),
+    LOG4CPLUS_TEXT("age|age|age|This is a message|"),
+    LOG4CPLUS_TEXT("          |          ||   |"),
+    LOG4CPLUS_TEXT(" {}| {}| {}|Message with % and {}|"),
+    LOG4CPLUS_TEXT("logger|c.logger|long_logger_name.c.logger|test.a.long_logger_name.c.logger|gger|"),
+    LOG4CPLUS_TEXT("root|root|root|root|root|"),
+    LOG4CPLUS_TEXT("b|a.b|a.b|a.b|a.b|"),
+    LOG4CPLUS_TEXT("/src/dir/file.cxx:42 file.cxx"),
+    LOG4CPLUS_TEXT(": "),
+    LOG4CPLUS_TEXT("name.cxx:0 name.cxx"),
+    LOG4CPLUS_TEXT("/src/dir/file.cxx:42"),
+    LOG4CPLUS_TEXT(":"),
+    LOG4CPLUS_TEXT("name.cxx:0"),
+    LOG4CPLUS_TEXT("outer inner|ner|outer inner|outer inner|"),
+    LOG4CPLUS_TEXT("||     |     |"),
+    LOG4CPLUS_TEXT("one two three four|our|one two three four|one two three four|"),
+    LOG4CPLUS_TEXT("%|%%"),
+    LOG4CPLUS_TEXT("%|%%"),
+    LOG4CPLUS_TEXT("%|%%"),
+    LOG4CPLUS_TEXT("test.a.long_logger_name.c.logger|test.a.long_logger_name.c.logger|test.a.long_logger_name.c.logger|"),
+    LOG4CPLUS_TEXT("root                |                root|root|"),
+    LOG4CPLUS_TEXT("a.b                 |                 a.b|a.b|"),
+    LOG4CPLUS_TEXT("ARN|WARN|WARN   |"),
+    LOG4CPLUS_TEXT("ACE|TRACE|TRACE  |"),
+    LOG4CPLUS_TEXT("TAL|FATAL|FATAL  |"),
+    LOG4CPLUS_TEXT("1234512345|12345       |"),
+    LOG4CPLUS_TEXT("mainmain|main        |"),
+    LOG4CPLUS_TEXT("tt|t           |"),
+    LOG4CPLUS_TEXT("literal only"),
+    LOG4CPLUS_TEXT("literal only"),
+    LOG4CPLUS_TEXT("literal only"),
+    LOG4CPLUS_TEXT("This is a message"),
+    LOG4CPLUS_TEXT(""),
+    LOG4CPLUS_TEXT("Message with % and {}"),
+    LOG4CPLUS_TEXT("%"),
+    LOG4CPLUS_TEXT("%"),
+    LOG4CPLUS_TEXT("%"),
+    LOG4CPLUS_TEXT("%z unknown"),
+    LOG4CPLUS_TEXT("%z unknown"),
+    LOG4CPLUS_TEXT("%z unknown"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("2009-02-13 23:31:30"),
+    LOG4CPLUS_TEXT("test.a.long_logger_name.c.logger"),
+    LOG4CPLUS_TEXT("root"),
+    LOG4CPLUS_TEXT("a.b"),
+    LOG4CPLUS_TEXT("%5"),
+    LOG4CPLUS_TEXT("%5"),
+    LOG4CPLUS_TEXT("%5"),
+    LOG4CPLUS_TEXT("%-"),
+    LOG4CPLUS_TEXT("%-"),
+    LOG4CPLUS_TEXT("%-"),
+    LOG4CPLUS_TEXT("%5.2"),
+    LOG4CPLUS_TEXT("%5.2"),
+    LOG4CPLUS_TEXT("%5.2"),
+    LOG4CPLUS_TEXT("%M %r %X"),
+    LOG4CPLUS_TEXT("%M %r %X"),
+    LOG4CPLUS_TEXT("%M %r %X"),
+    LOG4CPLUS_TEXT("trailing %"),
+    LOG4CPLUS_TEXT("trailing %"),
+    LOG4CPLUS_TEXT("trailing %"),
+    LOG4CPLUS_TEXT("xx|42      |      42|"),
+    LOG4CPLUS_TEXT("          |        |        |"),
+    LOG4CPLUS_TEXT("xx|0       |       0|"),
+    LOG4CPLUS_TEXT("file.cxx|ile.cxx:42|"),
+    LOG4CPLUS_TEXT("      |                   :|"),
+    LOG4CPLUS_TEXT("name.cxx|          name.cxx:0|"),
+    LOG4CPLUS_TEXT("\n\nThis is a message"),
+    LOG4CPLUS_TEXT("\n\n"),
+    LOG4CPLUS_TEXT("\n\nMessage with % and {}"),
+};
+
+
+// @returns Number of events formatted differently than expected.
+static int
+compareWithPrevious()
+{
+    int failures = 0;
+    std::size_t const eventCount = sizeof(events) / sizeof(events[0]);
+    for(std::size_t p = 0; p != sizeof(patterns) / sizeof(patterns[0]); ++p) {
+        PatternLayout layout(patterns[p]);
+        for(std::size_t e = 0; e != eventCount; ++e) {
+            spi::InternalLoggingEvent event(events[e].logger, events[e].ll,
+                events[e].ndc, events[e].message, events[e].thread,
+                Time(1234567890, 123456), events[e].file, events[e].line);
+
+            log4cplus::tostringstream oss;
+            layout.formatAndAppend(oss, event);
+            if(oss.str() != expected[p * eventCount + e]) {
+                log4cplus::tcout << LOG4CPLUS_TEXT("FAILED: pattern \"")
+                                 << patterns[p] << LOG4CPLUS_TEXT("\" gives \"")
+                                 << oss.str() << LOG4CPLUS_TEXT("\"") << endl;
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+// %i has to be the process of the event also after fork().
+static int
+checkProcessId()
+{
+    PatternLayout layout(LOG4CPLUS_TEXT("%i"));
+    spi::InternalLoggingEvent event(LOG4CPLUS_TEXT("test"), INFO_LOG_LEVEL,
+        LOG4CPLUS_TEXT("pid"), 0, 0);
+
+    pid_t const pid = fork();
+    if(pid == 0) {
+        log4cplus::tstring formatted;
+        layout.formatAndAppend(formatted, event);
+        _exit(formatted == convertIntegerToString(getpid()) ? 0 : 1);
+    }
+
+    int status = 0;
+    if(pid > 0 && waitpid(pid, &status, 0) == pid
+       && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        return 0;
+
+    cout << "FAILED: %i in a forked process" << endl;
+    return 1;
+}
+#endif
+
+
+// Overrides only the stream interface, like layouts written before
+// the string one; appenders have to use it all the same.
+class PrefixLayout : public PatternLayout {
+public:
+    PrefixLayout() : PatternLayout(LOG4CPLUS_TEXT("%m%n")) {}
+
+    using PatternLayout::formatAndAppend;
+
+    virtual void formatAndAppend(log4cplus::tostream& output,
+                                 const log4cplus::spi::InternalLoggingEvent& event)
+    {
+        output << LOG4CPLUS_TEXT("prefix ");
+        PatternLayout::formatAndAppend(output, event);
+    }
+};
+
+
 int
 main()
 {
     cout << "Entering main()..." << endl;
     LogLog::getLogLog()->setInternalDebugging(true);
+    int failures = 0;
     try {
         SharedObjectPtr<Appender> append_1(new ConsoleAppender());
         append_1->setName(LOG4CPLUS_TEXT("First"));
@@ -27,6 +260,13 @@ main()
         append_1->setLayout( std::auto_ptr<Layout>(new PatternLayout(pattern)) );
         Logger::getRoot().addAppender(append_1);
 
+        // Format modifiers, constant conversions and adjacent literals.
+        SharedObjectPtr<Appender> append_2(new ConsoleAppender());
+        append_2->setName(LOG4CPLUS_TEXT("Second"));
+        append_2->setLayout( std::auto_ptr<Layout>(new PatternLayout(
+            LOG4CPLUS_TEXT("%D{%H:%M:%S.%q} %8.3i|%-6p|%.12c{3}|%5x|%-10.4m|%%%n"))) );
+        Logger::getRoot().addAppender(append_2);
+
         Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.a.long_logger_name.c.logger"));
         LOG4CPLUS_DEBUG(logger, "This is the FIRST log message...");
 
@@ -44,6 +284,23 @@ main()
 
         sleep(1, 0);
         LOG4CPLUS_FATAL(logger, "This is the FOURTH log message...");
+
+        failures += compareWithPrevious();
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+        failures += checkProcessId();
+#endif
+
+        PrefixLayout prefixLayout;
+        Layout& layout = prefixLayout;
+        log4cplus::tstring formatted;
+        layout.formatAndAppend(formatted, spi::InternalLoggingEvent(
+            logger.getName(), INFO_LOG_LEVEL, LOG4CPLUS_TEXT("custom"),
+            __FILE__, __LINE__));
+        if(formatted != LOG4CPLUS_TEXT("prefix custom\n")) {
+            cout << "FAILED: layout overriding the stream interface bypassed"
+                 << endl;
+            ++failures;
+        }
     }
     catch(...) {
         cout << "Exception..." << endl;
@@ -51,6 +308,6 @@ main()
     }
 
     cout << "Exiting main()..." << endl;
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
 
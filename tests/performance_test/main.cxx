@@ -1,8 +1,24 @@
 
 #include <log4cplus/logger.h>
 #include <log4cplus/configurator.h>
+#include <log4cplus/fileappender.h>
+#include <log4cplus/layout.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/nullappender.h>
+#include <log4cplus/spi/eventpool.h>
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/helpers/threads.h>
+#endif
+#if defined (__linux__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#endif
 
 using namespace std;
 using namespace log4cplus;
@@ -10,11 +26,235 @@ using namespace log4cplus::helpers;
 
 log4cplus::tostream& operator <<(log4cplus::tostream& s, const Time& t)
 {
-    return s << t.sec() << "sec " << t.usec() << "usec";
+    return s << t.sec() << "sec " << t.usec() << "usec "
+             << t.nsec() % 1000 << "nsec";
 }
 
 #define LOOP_COUNT 100000
 
+
+void
+printEventPoolStats(Logger& root, const char* what)
+{
+    spi::EventPool::Stats stats = spi::EventPool::getStats();
+    LOG4CPLUS_WARN(root, what << " allocated " << stats.allocated
+        << " events, freed " << stats.freed << " events, grew "
+        << stats.bufferGrowths << " message buffers");
+    spi::EventPool::resetStats();
+}
+
+
+#if defined (__linux__)
+
+#define FILE_LOOP_COUNT 200000
+
+// Returns how many pages of the file are in the page cache, in percent.
+int
+pageCacheResidency(char const * name)
+{
+    int fd = open(name, O_RDONLY);
+    if(fd == -1)
+        return -1;
+
+    int ret = -1;
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        long const page = sysconf(_SC_PAGESIZE);
+        std::size_t const pages = (st.st_size + page - 1) / page;
+        void * addr = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(addr != MAP_FAILED) {
+            std::vector<unsigned char> vec(pages);
+            if(mincore(addr, st.st_size, &vec[0]) == 0) {
+                std::size_t resident = 0;
+                for(std::size_t i=0; i<pages; ++i) {
+                    resident += vec[i] & 1;
+                }
+                ret = static_cast<int>(resident * 100 / pages);
+            }
+            munmap(addr, st.st_size);
+        }
+    }
+    close(fd);
+    return ret;
+}
+
+
+// Returns properties of a FileAppender writing through the backend
+// without flushing after every event.
+helpers::Properties
+fileProperties(char const * backend)
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Backend"),
+        LOG4CPLUS_C_STR_TO_TSTRING(backend));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"),
+        LOG4CPLUS_TEXT("false"));
+    return props;
+}
+
+
+// Returns the user and system CPU time of the whole process.
+Time
+cpuTime()
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return Time();
+    return Time(usage.ru_utime.tv_sec, usage.ru_utime.tv_usec)
+        + Time(usage.ru_stime.tv_sec, usage.ru_stime.tv_usec);
+}
+
+
+// Writes into a FileAppender with the given properties and reports
+// throughput including closing of the file, per event write latency,
+// CPU time of all threads, the size of the file and how much of it
+// stays in the page cache.
+void
+fileRun(Logger& root, char const * what, helpers::Properties props)
+{
+    char const * const name = "performance_test_file.log";
+    unlink(name);
+    props.setProperty(LOG4CPLUS_TEXT("File"),
+        LOG4CPLUS_C_STR_TO_TSTRING(name));
+
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("file"));
+    logger.setAdditivity(false);
+    SharedAppenderPtr file(new FileAppender(props));
+    file->setLayout(std::auto_ptr<Layout>(
+        new PatternLayout(LOG4CPLUS_TEXT("%d{%H:%M:%S,%q} %-5p %c - %m%n"))));
+    logger.addAppender(file);
+
+    tstring msg(LOG4CPLUS_TEXT("This is a WARNING with some padding to make "
+        "the line about as long as a real one..."));
+    Time worst;
+    Time const cpuStart = cpuTime();
+    Time start = Time::gettimeofday();
+    for(int i=0; i<FILE_LOOP_COUNT; ++i) {
+        Time const before = Time::gettimeofday();
+        LOG4CPLUS_WARN(logger, msg);
+        Time const took = Time::gettimeofday() - before;
+        if(took > worst) {
+            worst = took;
+        }
+    }
+    Time diff = Time::gettimeofday() - start;
+    file->close();
+    Time total = Time::gettimeofday() - start;
+    Time const cpu = cpuTime() - cpuStart;
+    logger.removeAllAppenders();
+
+    struct stat st;
+    long const bytes = stat(name, &st) == 0 ? static_cast<long>(st.st_size) : -1;
+
+    double const secs = total.sec() + total.usec() / 1000000.0;
+    LOG4CPLUS_WARN(root, what << " writing " << FILE_LOOP_COUNT
+        << " events average: " << (diff/FILE_LOOP_COUNT)
+        << ", worst: " << worst);
+    LOG4CPLUS_WARN(root, what << " throughput with close: "
+        << static_cast<long>(FILE_LOOP_COUNT / secs) << " events/s");
+    LOG4CPLUS_WARN(root, what << " bytes written: " << bytes
+        << ", CPU time: " << cpu);
+    LOG4CPLUS_WARN(root, what << " page cache residency after close: "
+        << pageCacheResidency(name) << "%" << endl);
+    unlink(name);
+}
+
+
+void
+fileCacheTest(Logger& root)
+{
+    helpers::Properties props = fileProperties("fd");
+    fileRun(root, "Plain file", props);
+    props.setProperty(LOG4CPLUS_TEXT("Preallocate"), LOG4CPLUS_TEXT("64MB"));
+    fileRun(root, "Preallocate", props);
+    props.setProperty(LOG4CPLUS_TEXT("DropCacheBehind"),
+        LOG4CPLUS_TEXT("true"));
+    fileRun(root, "Preallocate+DropCacheBehind", props);
+}
+
+
+void
+fileBackendTest(Logger& root)
+{
+    fileRun(root, "Backend=stream", fileProperties("stream"));
+    fileRun(root, "Backend=fd", fileProperties("fd"));
+    fileRun(root, "Backend=uring", fileProperties("uring"));
+
+    helpers::Properties props = fileProperties("fd");
+    props.setProperty(LOG4CPLUS_TEXT("CompressOutput"), LOG4CPLUS_TEXT("gzip"));
+    fileRun(root, "Backend=fd CompressOutput=gzip", props);
+}
+
+#endif // __linux__
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#define CONTENTION_LOOP_COUNT 20000
+#define CONTENTION_MAX_THREADS 64
+
+// Each thread logs through its own "contention.N" logger with its own
+// NullAppender. All of them share the "contention" parent logger and its
+// NullAppender, so the only shared state on the path is the parent's
+// appender list and its appender.
+class ContentionThread : public log4cplus::thread::AbstractThread {
+public:
+    ContentionThread(Logger l) : logger(l) { }
+
+    virtual void run()
+    {
+        tstring msg(LOG4CPLUS_TEXT("This is a WARNING..."));
+        for(int i=0; i<CONTENTION_LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN(logger, msg);
+        }
+    }
+
+private:
+    Logger logger;
+};
+
+
+void
+contentionTest(Logger& root)
+{
+    Logger parent = Logger::getInstance(LOG4CPLUS_TEXT("contention"));
+    parent.setAdditivity(false);
+    // Like an appender of the root logger shared by the whole program.
+    parent.addAppender(SharedAppenderPtr(new NullAppender()));
+
+    for(int count=1; count<=CONTENTION_MAX_THREADS; count*=2) {
+        log4cplus::helpers::SharedObjectPtr<ContentionThread>
+            threads[CONTENTION_MAX_THREADS];
+        int i = 0;
+        for(i=0; i<count; ++i) {
+            tostringstream name;
+            name << LOG4CPLUS_TEXT("contention.") << i;
+            Logger logger = Logger::getInstance(name.str());
+            if(logger.getAllAppenders().empty()) {
+                logger.addAppender(SharedAppenderPtr(new NullAppender()));
+            }
+            threads[i] = new ContentionThread(logger);
+        }
+
+        Time start = Time::gettimeofday();
+        for(i=0; i<count; ++i) {
+            threads[i]->start();
+        }
+        for(i=0; i<count; ++i) {
+            threads[i]->join();
+        }
+        Time end = Time::gettimeofday();
+        Time diff = end - start;
+        LOG4CPLUS_WARN(root, count << " threads logging "
+            << CONTENTION_LOOP_COUNT << " events each took: " << diff);
+        LOG4CPLUS_WARN(root, count << " threads logging average: "
+            << (diff/(CONTENTION_LOOP_COUNT * count)) << endl);
+    }
+}
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+
 int
 main()
 {
@@ -23,6 +263,9 @@ main()
     Logger root = Logger::getRoot();
     try {
         Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("testlogger"));
+        // Events filled by setLoggingEvent() refer to the logger name,
+        // it has to outlive them. Constructed events copy it.
+        tstring const loggerName = logger.getName();
 
         LOG4CPLUS_WARN(root, "Starting test loop....");
         Time start = Time::gettimeofday();
@@ -48,8 +291,8 @@ main()
 
         start = Time::gettimeofday();
         for(i=0; i<LOOP_COUNT; ++i) {
-	    log4cplus::spi::InternalLoggingEvent e(logger.getName(), log4cplus::WARN_LOG_LEVEL,
-			                         msg, 0, 0);
+	    log4cplus::spi::InternalLoggingEvent e(loggerName, log4cplus::WARN_LOG_LEVEL,
+			                         msg, __FILE__, __LINE__);
         }
         end = Time::gettimeofday();
         diff = end - start;
@@ -57,10 +300,26 @@ main()
         LOG4CPLUS_WARN(root, "Creating log " << LOOP_COUNT << " objects took: " << diff);
         LOG4CPLUS_WARN(root, "Creating log object average: " << (diff/LOOP_COUNT) << endl);
 
+        // Like the pooled events of Logger::forcedLog().
+        start = Time::gettimeofday();
+        {
+            log4cplus::spi::InternalLoggingEvent e(loggerName, log4cplus::WARN_LOG_LEVEL,
+                                                   msg, __FILE__, __LINE__);
+            for(i=0; i<LOOP_COUNT; ++i) {
+                e.setLoggingEvent(loggerName, log4cplus::WARN_LOG_LEVEL,
+                                  msg, __FILE__, __LINE__);
+            }
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+
+        LOG4CPLUS_WARN(root, "Filling log " << LOOP_COUNT << " objects took: " << diff);
+        LOG4CPLUS_WARN(root, "Filling log object average: " << (diff/LOOP_COUNT) << endl);
+
         start = Time::gettimeofday();
         for(i=0; i<LOOP_COUNT; ++i) {
-	    log4cplus::spi::InternalLoggingEvent e(logger.getName(), log4cplus::WARN_LOG_LEVEL,
-			                           msg, 0, 0);
+	    log4cplus::spi::InternalLoggingEvent e(loggerName, log4cplus::WARN_LOG_LEVEL,
+			                           msg, __FILE__, __LINE__);
 	    e.getNDC();
 	    e.getThread();
         }
@@ -71,8 +330,8 @@ main()
         
         start = Time::gettimeofday();
         for(i=0; i<LOOP_COUNT; ++i) {
-            log4cplus::spi::InternalLoggingEvent e(logger.getName(), log4cplus::WARN_LOG_LEVEL,
-			                           msg, 0, 0);
+            log4cplus::spi::InternalLoggingEvent e(loggerName, log4cplus::WARN_LOG_LEVEL,
+			                           msg, __FILE__, __LINE__);
 	    e.getNDC();
         }
         end = Time::gettimeofday();
@@ -82,14 +341,122 @@ main()
         
         start = Time::gettimeofday();
         for(i=0; i<LOOP_COUNT; ++i) {
-            log4cplus::spi::InternalLoggingEvent e(logger.getName(), log4cplus::WARN_LOG_LEVEL,
-			                           msg, 0, 0);
+            log4cplus::spi::InternalLoggingEvent e(loggerName, log4cplus::WARN_LOG_LEVEL,
+			                           msg, __FILE__, __LINE__);
 	    e.getThread();
         }
         end = Time::gettimeofday();
         diff = end - start;
         LOG4CPLUS_WARN(root, "getThread() " << LOOP_COUNT << " calls took: " << diff);
         LOG4CPLUS_WARN(root, "getThread() average: " << (diff/LOOP_COUNT) << endl);
+
+        start = Time::gettimeofday();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            Logger copy(logger);
+            Logger parent = copy.getParent();
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+        LOG4CPLUS_WARN(root, "Copying Logger " << 2 * LOOP_COUNT << " times took: " << diff);
+        LOG4CPLUS_WARN(root, "Copying Logger average: " << (diff/(2 * LOOP_COUNT)) << endl);
+
+        const char* const clockNames[] = { "REALTIME", "COARSE", "MONOTONIC", "TSC" };
+        const helpers::ClockSource clocks[] = { helpers::REALTIME_CLOCK,
+            helpers::COARSE_CLOCK, helpers::MONOTONIC_CLOCK, helpers::TSC_CLOCK };
+        for(std::size_t c=0; c<sizeof(clocks)/sizeof(clocks[0]); ++c) {
+            if(helpers::setClockSource(clocks[c]) != clocks[c]) {
+                LOG4CPLUS_WARN(root, clockNames[c] << " clock is not available");
+                continue;
+            }
+            start = Time::gettimeofday();
+            for(i=0; i<LOOP_COUNT; ++i) {
+                Time::gettimeofday();
+            }
+            end = Time::gettimeofday();
+            diff = end - start;
+            LOG4CPLUS_WARN(root, "Reading " << clockNames[c] << " clock "
+                << LOOP_COUNT << " times took: " << diff);
+        }
+        helpers::setClockSource(helpers::REALTIME_CLOCK);
+        LOG4CPLUS_WARN(root, "" << endl);
+
+        Logger null_logger = Logger::getInstance(LOG4CPLUS_TEXT("null"));
+        null_logger.setAdditivity(false);
+        null_logger.addAppender(SharedAppenderPtr(new NullAppender()));
+
+        start = Time::gettimeofday();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN(null_logger, "value " << i << " pi " << 3.14159
+                << " name " << msg);
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+        LOG4CPLUS_WARN(root, "Streaming " << LOOP_COUNT << " messages took: " << diff);
+        LOG4CPLUS_WARN(root, "Streaming message average: " << (diff/LOOP_COUNT) << endl);
+
+#if defined (LOG4CPLUS_HAVE_C99_VARIADIC_MACROS)
+        start = Time::gettimeofday();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN_FMT(null_logger, LOG4CPLUS_TEXT("value {} pi {} name {}"),
+                i, 3.14159, msg);
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+        LOG4CPLUS_WARN(root, "Formatting " << LOOP_COUNT << " messages took: " << diff);
+        LOG4CPLUS_WARN(root, "Formatting message average: " << (diff/LOOP_COUNT) << endl);
+
+        // NullAppender never asks for the message, so this measures
+        // only the capture of the arguments.
+        start = Time::gettimeofday();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN_DEFERRED(null_logger, LOG4CPLUS_TEXT("value {} pi {} name {}"),
+                i, 3.14159, msg);
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+        LOG4CPLUS_WARN(root, "Capturing " << LOOP_COUNT << " messages took: " << diff);
+        LOG4CPLUS_WARN(root, "Capturing message average: " << (diff/LOOP_COUNT) << endl);
+#endif
+
+        // Warm up the pool of this thread, then check that logging
+        // does not allocate events anymore.
+        LOG4CPLUS_WARN(null_logger, "value " << 0);
+        spi::EventPool::resetStats();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN(null_logger, "value " << i);
+        }
+        printEventPoolStats(root, "Logging");
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        Logger async_logger = Logger::getInstance(LOG4CPLUS_TEXT("async"));
+        async_logger.setAdditivity(false);
+        SharedAppenderPtr async(new AsyncAppender(
+            SharedAppenderPtr(new NullAppender()), 1000));
+        async_logger.addAppender(async);
+
+        spi::EventPool::resetStats();
+        start = Time::gettimeofday();
+        for(i=0; i<LOOP_COUNT; ++i) {
+            LOG4CPLUS_WARN(async_logger, "value " << i << " pi " << 3.14159
+                << " name " << msg);
+        }
+        end = Time::gettimeofday();
+        diff = end - start;
+        LOG4CPLUS_WARN(root, "Queueing " << LOOP_COUNT << " messages took: " << diff);
+        LOG4CPLUS_WARN(root, "Queueing message average: " << (diff/LOOP_COUNT) << endl);
+        async->close();
+        async_logger.removeAllAppenders();
+        printEventPoolStats(root, "Queueing");
+#endif
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        contentionTest(root);
+#endif
+
+#if defined (__linux__)
+        fileCacheTest(root);
+        fileBackendTest(root);
+#endif
     }
     catch(...) {
         cout << "Exception..." << endl;
@@ -10,6 +10,63 @@ log4cplus::tchar const fmtstr[] =
     LOG4CPLUS_TEXT("%s, %Q%%q%q %%Q %%q=%%%q%%;%%q, %%Q=%Q");
 
 
+log4cplus::tchar const * const formatter_fmts[] = {
+    fmtstr,
+    LOG4CPLUS_TEXT("%Y-%m-%d %H:%M:%S,%q"),
+    LOG4CPLUS_TEXT("%d %b %Y %H:%M:%S.%Q"),
+    LOG4CPLUS_TEXT("%q%Q%q"),
+    LOG4CPLUS_TEXT("%H:%M:%S"),
+    LOG4CPLUS_TEXT("%s.%q %p %Z"),
+    LOG4CPLUS_TEXT("%%%q%%Q%"),
+    LOG4CPLUS_TEXT("%Y-%m-%dT%H:%M:%S%z"),
+    LOG4CPLUS_TEXT("%F %T.%q"),
+    LOG4CPLUS_TEXT("%e %j %y%n%t%Y%m%d%H%M%S"),
+    LOG4CPLUS_TEXT("")
+};
+
+
+// Compares TimeFormatter output with Time::getFormattedTime() for
+// times within the same second as well as across seconds.
+static void
+testTimeFormatter (bool use_gmtime)
+{
+    std::size_t const fmts_count
+        = sizeof (formatter_fmts) / sizeof (formatter_fmts[0]);
+    int mismatches = 0;
+
+    for (std::size_t i = 0; i != fmts_count; ++i)
+    {
+        TimeFormatter formatter (formatter_fmts[i], use_gmtime);
+        Time time (1234567890, 999000);
+        for (int j = 0; j != 500; ++j)
+        {
+            log4cplus::tstring const expected
+                = time.getFormattedTime (formatter_fmts[i], use_gmtime);
+            log4cplus::tstring const actual
+                = formatter.getFormattedTime (time);
+            if (actual != expected)
+            {
+                log4cplus::tcout << LOG4CPLUS_TEXT ("TimeFormatter mismatch: ")
+                    << actual << LOG4CPLUS_TEXT (" != ") << expected
+                    << std::endl;
+                ++mismatches;
+            }
+            // Steps within a second first, then steps of a bit over
+            // a day through several years, to cross DST changes.
+            if (j < 100)
+                time += Time (0, 37 * 1000 + j);
+            else
+                time += Time (4 * 86400 + 3599, 1000 + j);
+        }
+    }
+
+    log4cplus::tcout << LOG4CPLUS_TEXT ("TimeFormatter ")
+        << (use_gmtime ? LOG4CPLUS_TEXT ("GMT") : LOG4CPLUS_TEXT ("local"))
+        << LOG4CPLUS_TEXT (" time: ") << mismatches
+        << LOG4CPLUS_TEXT (" mismatches") << std::endl;
+}
+
+
 int
 main()
 {
@@ -50,6 +107,9 @@ main()
         time = Time (0, 0);
         str = time.getFormattedTime (fmtstr);
         log4cplus::tcout << str << std::endl;
+
+        testTimeFormatter (false);
+        testTimeFormatter (true);
     }
     catch(std::exception const & e)
     {